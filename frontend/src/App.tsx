@@ -1,5 +1,5 @@
 import React, { useState, useEffect } from 'react';
-import FileExplorer from './components/FileExplorer';
+import FileExplorer, { OpenFileInfo } from './components/FileExplorer';
 import Editor from './components/Editor';
 import Toolbar from './components/Toolbar';
 import BuildPanel from './components/BuildPanel';
@@ -20,6 +20,9 @@ interface Tab {
   content: string;
   language: string;
   modified: boolean;
+  revision: number;
+  lineCount: number;
+  partial: boolean;
 }
 
 function App() {
@@ -58,9 +61,11 @@ function App() {
       setBuildLogs((prev: string[]) => [...prev, `\nProcess exited with code ${data.exitCode || 0}\n`]);
     });
 
-    bridge.on('fileSaved', (data: { success: boolean; message: string }) => {
+    bridge.on('fileSaved', (data: { success: boolean; message: string; path: string }) => {
       if (data.success) {
         setBuildLogs((prev: string[]) => [...prev, `[INFO] ${data.message}\n`]);
+      } else {
+        alert(`${data.message}: ${data.path}`);
       }
     });
 
@@ -85,7 +90,7 @@ function App() {
     };
   }, [activeTab, tabs]);
 
-  const handleFileSelect = (path: string, content: string) => {
+  const handleFileSelect = (path: string, content: string, info: OpenFileInfo) => {
     const existingTab = tabs.find((tab: Tab) => tab.path === path);
     
     if (existingTab) {
@@ -96,7 +101,8 @@ function App() {
         path,
         content,
         language: getLanguageFromPath(path),
-        modified: false
+        modified: false,
+        ...info
       };
       setTabs([...tabs, newTab]);
       setActiveTab(newTab.id);
@@ -134,6 +140,11 @@ function App() {
   };
 
   const handleCloseTab = (tabId: string) => {
+    const closedTab = tabs.find((tab: Tab) => tab.id === tabId);
+    if (closedTab) {
+      bridge.closeFile(closedTab.path);
+    }
+
     const newTabs = tabs.filter((tab: Tab) => tab.id !== tabId);
     setTabs(newTabs);
     
@@ -145,6 +156,11 @@ function App() {
   const handleSave = () => {
     const currentTab = tabs.find((tab: Tab) => tab.id === activeTab);
     if (!currentTab) return;
+    if (currentTab.partial) {
+      // Paged files are never held whole here, so there is nothing to send
+      alert(`${currentTab.path} is too large to edit and is open read-only`);
+      return;
+    }
 
     // Save file through bridge
     bridge.saveFile(currentTab.path, currentTab.content);
@@ -165,7 +181,7 @@ function App() {
     }
 
     // Save file first if modified
-    if (currentTab.modified) {
+    if (currentTab.modified && !currentTab.partial) {
       bridge.saveFile(currentTab.path, currentTab.content);
       setTabs(tabs.map((tab: Tab) => 
         tab.id === activeTab 
@@ -255,6 +271,9 @@ function App() {
                 onChange={handleEditorChange}
                 language={currentTab.language}
                 path={currentTab.path}
+                partial={currentTab.partial}
+                lineCount={currentTab.lineCount}
+                revision={currentTab.revision}
               />
             ) : (
               <div className="no-file-open">
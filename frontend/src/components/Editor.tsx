@@ -1,18 +1,185 @@
-import React from 'react';
+import React, { useState, useEffect, useRef, useCallback } from 'react';
 import Editor from '@monaco-editor/react';
+import bridge from '../services/bridge';
 
 interface MonacoEditorProps {
   value: string;
   onChange: (value: string | undefined) => void;
   language: string;
   path: string;
+  partial?: boolean;
+  lineCount?: number;
+  revision?: number;
 }
 
-const MonacoEditor: React.FC<MonacoEditorProps> = ({ value, onChange, language, path }) => {
+// Large-file viewport paging
+const LINE_HEIGHT = 19;
+const PAGE_LINES = 200;
+const PREFETCH_PAGES = 1;
+const MAX_CACHED_PAGES = 32;
+
+interface LargeFileViewProps {
+  path: string;
+  lineCount: number;
+  revision: number;
+}
+
+// Read-only view of a file too large to hand to Monaco. Only the visible
+// window plus a page of prefetch on each side is requested from the backend,
+// in fixed-size pages that are cached and evicted least-recently-used.
+// Pages carry the fold regions that start in them; clicking a fold marker
+// jumps to the line holding the matching closing bracket.
+const LargeFileView: React.FC<LargeFileViewProps> = ({ path, lineCount, revision }) => {
+  const containerRef = useRef<HTMLDivElement>(null);
+  const pagesRef = useRef<Map<number, string[]>>(new Map());
+  const foldsRef = useRef<Map<number, number>>(new Map());
+  const pendingRef = useRef<Set<number>>(new Set());
+  const revisionRef = useRef(revision);
+  const [totalLines, setTotalLines] = useState(lineCount);
+  const [scrollTop, setScrollTop] = useState(0);
+  const [viewHeight, setViewHeight] = useState(0);
+  const [, setLoadedCount] = useState(0);
+
+  const firstVisible = Math.floor(scrollTop / LINE_HEIGHT);
+  const visibleCount = Math.ceil(viewHeight / LINE_HEIGHT) + 1;
+
+  const requestPage = useCallback((page: number) => {
+    if (page < 0 || page * PAGE_LINES >= totalLines) return;
+    if (pagesRef.current.has(page) || pendingRef.current.has(page)) return;
+    pendingRef.current.add(page);
+    bridge.readRange(path, page * PAGE_LINES, PAGE_LINES, revisionRef.current);
+  }, [path, totalLines]);
+
+  useEffect(() => {
+    const handleRange = (data: {
+      success: boolean;
+      path: string;
+      revision: number;
+      lineCount: number;
+      firstLine: number;
+      lines: string[];
+      folds?: [number, number][];
+    }) => {
+      if (!data.success || data.path !== path) return;
+
+      // The file changed on the backend: everything cached is stale
+      if (data.revision !== revisionRef.current) {
+        revisionRef.current = data.revision;
+        pagesRef.current.clear();
+        pendingRef.current.clear();
+        foldsRef.current.clear();
+        setTotalLines(data.lineCount);
+      }
+
+      for (const [start, end] of data.folds ?? []) {
+        foldsRef.current.set(start, end);
+      }
+
+      const page = Math.floor(data.firstLine / PAGE_LINES);
+      pendingRef.current.delete(page);
+      pagesRef.current.delete(page);
+      pagesRef.current.set(page, data.lines);
+      while (pagesRef.current.size > MAX_CACHED_PAGES) {
+        const oldest = pagesRef.current.keys().next().value as number;
+        pagesRef.current.delete(oldest);
+      }
+      setLoadedCount((count: number) => count + 1);
+    };
+
+    const unsubscribe = bridge.on('fileRange', handleRange);
+    return unsubscribe;
+  }, [path]);
+
+  useEffect(() => {
+    revisionRef.current = revision;
+    pagesRef.current.clear();
+    pendingRef.current.clear();
+    foldsRef.current.clear();
+    setTotalLines(lineCount);
+  }, [path, revision, lineCount]);
+
+  useEffect(() => {
+    const container = containerRef.current;
+    if (!container) return;
+    const observer = new ResizeObserver(() => setViewHeight(container.clientHeight));
+    observer.observe(container);
+    setViewHeight(container.clientHeight);
+    return () => observer.disconnect();
+  }, []);
+
+  // Page in the visible window plus prefetch whenever the viewport moves
+  useEffect(() => {
+    const firstPage = Math.floor(firstVisible / PAGE_LINES) - PREFETCH_PAGES;
+    const lastPage = Math.floor((firstVisible + visibleCount) / PAGE_LINES) + PREFETCH_PAGES;
+    for (let page = firstPage; page <= lastPage; page++) {
+      requestPage(page);
+    }
+  }, [firstVisible, visibleCount, requestPage]);
+
+  const scrollToLine = (line: number) => {
+    if (containerRef.current) {
+      containerRef.current.scrollTop = line * LINE_HEIGHT;
+    }
+  };
+
+  const lastVisible = Math.min(firstVisible + visibleCount, totalLines);
+  const rows: React.ReactNode[] = [];
+  for (let line = firstVisible; line < lastVisible; line++) {
+    const page = pagesRef.current.get(Math.floor(line / PAGE_LINES));
+    const text = page ? page[line % PAGE_LINES] : undefined;
+    const foldEnd = foldsRef.current.get(line);
+    rows.push(
+      <div key={line} className="large-file-line" style={{ top: line * LINE_HEIGHT, height: LINE_HEIGHT }}>
+        <span className="large-file-gutter">{line + 1}</span>
+        <span
+          className={`large-file-fold ${foldEnd !== undefined ? 'foldable' : ''}`}
+          title={foldEnd !== undefined ? `Lines ${line + 1}-${foldEnd + 1}` : undefined}
+          onClick={() => foldEnd !== undefined && scrollToLine(foldEnd)}
+        >
+          {foldEnd !== undefined ? '\u25BE' : ''}
+        </span>
+        <span className="large-file-text">{text ?? ''}</span>
+      </div>
+    );
+  }
+
+  return (
+    <div
+      ref={containerRef}
+      className="large-file-view"
+      onScroll={(e: React.UIEvent<HTMLDivElement>) => setScrollTop(e.currentTarget.scrollTop)}
+    >
+      <div className="large-file-spacer" style={{ height: totalLines * LINE_HEIGHT }}>
+        {rows}
+      </div>
+    </div>
+  );
+};
+
+const MonacoEditor: React.FC<MonacoEditorProps> = ({
+  value,
+  onChange,
+  language,
+  path,
+  partial = false,
+  lineCount = 0,
+  revision = 0
+}) => {
   const handleEditorChange = (value: string | undefined) => {
     onChange(value);
   };
 
+  if (partial) {
+    return (
+      <div className="editor-container">
+        <div className="editor-header">
+          <span className="editor-path">{path} (read-only, {lineCount.toLocaleString()} lines)</span>
+        </div>
+        <LargeFileView path={path} lineCount={lineCount} revision={revision} />
+      </div>
+    );
+  }
+
   return (
     <div className="editor-container">
       <div className="editor-header">
@@ -1,4 +1,4 @@
-import React, { useState, useEffect } from 'react';
+import React, { useState, useEffect, useLayoutEffect, useRef } from 'react';
 import { FileText, Folder, ChevronRight, ChevronDown } from 'lucide-react';
 import bridge from '../services/bridge';
 
@@ -6,86 +6,224 @@ interface FileNode {
   name: string;
   path: string;
   type: 'file' | 'folder';
-  children?: FileNode[];
+}
+
+// One entry of a 'fileTreeChanged' push; paths use the listing's format
+interface FileChange {
+  change: 'created' | 'deleted' | 'modified' | 'rescan';
+  path: string;
+  parent: string;
+  name: string;
+  type: 'file' | 'folder';
+}
+
+// What is known of one directory's sorted listing: its size, and the
+// pages fetched so far. Rows are only fetched once they scroll into view.
+interface Listing {
+  total: number;
+  generation: number;
+  rows: (FileNode | undefined)[];
+  indexOf: Map<string, number>;
+  pending: Set<number>;   // pages requested and not yet answered
+}
+
+// A row on screen: an entry (or a placeholder while its page loads) of
+// the listing of dir, at depth
+interface VisibleRow {
+  node?: FileNode;
+  dir: string;
+  index: number;
+  depth: number;
+}
+
+export interface OpenFileInfo {
+  revision: number;
+  lineCount: number;
+  partial: boolean;
 }
 
 interface FileExplorerProps {
-  onFileSelect: (path: string, content: string) => void;
+  onFileSelect: (path: string, content: string, info: OpenFileInfo) => void;
 }
 
+const PAGE_SIZE = 200;
+const ROW_HEIGHT = 28;   // matches .file-node
+const OVERSCAN = 20;     // rows rendered above and below the viewport
+
 const FileExplorer: React.FC<FileExplorerProps> = ({ onFileSelect }) => {
-  const [files, setFiles] = useState<FileNode[]>([]);
   const [expanded, setExpanded] = useState<Set<string>>(new Set());
   const [rootPath] = useState<string>('.');
+  const [scrollTop, setScrollTop] = useState(0);
+  const [viewportHeight, setViewportHeight] = useState(0);
+  // Listings are mutated in place; bumping the version re-renders
+  const [, setVersion] = useState(0);
+  const listings = useRef(new Map<string, Listing>());
+  const parentOf = useRef(new Map<string, string>());
+  const contentRef = useRef<HTMLDivElement>(null);
+
+  const refresh = () => setVersion(version => version + 1);
+
+  const requestPage = (path: string, page: number) => {
+    let listing = listings.current.get(path);
+    if (!listing) {
+      // Shows nothing until the first page says how large it is
+      listing = { total: 0, generation: -1, rows: [], indexOf: new Map(), pending: new Set() };
+      listings.current.set(path, listing);
+    }
+    if (listing.pending.has(page)) return;
+    listing.pending.add(page);
+    bridge.listDirectory(path, { size: false, modified: false, sort: 'type', offset: page * PAGE_SIZE, limit: PAGE_SIZE });
+  };
+
+  // Forget what is loaded of a directory; visible rows are fetched again
+  const invalidate = (path: string) => {
+    const listing = listings.current.get(path);
+    if (!listing) return;
+    listing.rows = [];
+    listing.indexOf.clear();
+    listing.pending.clear();
+  };
 
   useEffect(() => {
     // Listen for directory listings from backend
-    bridge.on('directoryListing', (data: { success: boolean; path: string; files: any[] }) => {
-      if (data.success) {
-        updateDirectoryContents(data.path, data.files);
+    bridge.on('directoryListing', (data: {
+      success: boolean;
+      path: string;
+      offset: number;
+      total: number;
+      generation: number;
+      files: FileNode[];
+    }) => {
+      if (!data.success) return;
+      const listing = listings.current.get(data.path);
+      if (!listing) return;   // deleted meanwhile
+      if (listing.generation !== data.generation) {
+        // The directory changed since the pages held were fetched
+        const pending = new Set(listing.pending);
+        invalidate(data.path);
+        listing.pending = pending;
+        listing.generation = data.generation;
       }
+      listing.total = data.total;
+      listing.pending.delete(Math.floor(data.offset / PAGE_SIZE));
+      data.files.forEach((file, i) => {
+        const node: FileNode = { name: file.name, path: file.path, type: file.type };
+        listing.rows[data.offset + i] = node;
+        listing.indexOf.set(node.path, data.offset + i);
+        parentOf.current.set(node.path, data.path);
+      });
+      refresh();
+    });
+
+    // Changes inside listed directories are pushed as deltas; the backend
+    // drops its cached listing, so the rows on screen are fetched again
+    bridge.on('fileTreeChanged', (data: { changes: FileChange[] }) => {
+      if (data.changes.some(change => change.change === 'rescan')) {
+        listings.current.forEach((_, path) => invalidate(path));
+      } else {
+        data.changes.forEach(change => {
+          if (change.change === 'created' || change.change === 'deleted') invalidate(change.parent);
+          if (change.change === 'deleted' && change.type === 'folder') listings.current.delete(change.path);
+        });
+      }
+      refresh();
     });
 
     // Listen for file content from backend
-    bridge.on('fileContent', (data: { success: boolean; content: string; path: string }) => {
+    // Large files arrive without content and are paged in by the editor
+    bridge.on('fileContent', (data: {
+      success: boolean;
+      content?: string;
+      path: string;
+      revision: number;
+      lineCount: number;
+      partial: boolean;
+    }) => {
       if (data.success) {
-        onFileSelect(data.path, data.content);
+        onFileSelect(data.path, data.content ?? '', {
+          revision: data.revision,
+          lineCount: data.lineCount,
+          partial: data.partial
+        });
       } else {
         alert(`Failed to open file: ${data.path}`);
       }
     });
 
     // Load initial directory
-    loadDirectory(rootPath);
+    requestPage(rootPath, 0);
+  }, []);
+
+  useLayoutEffect(() => {
+    const content = contentRef.current;
+    if (!content) return;
+    const measure = () => setViewportHeight(content.clientHeight);
+    measure();
+    window.addEventListener('resize', measure);
+    return () => window.removeEventListener('resize', measure);
   }, []);
 
-  const loadDirectory = (path: string) => {
-    bridge.listDirectory(path);
+  // Expanded folders of a listing whose row is loaded, in listing order
+  const expandedChildren = (path: string, listing: Listing): [number, string][] => {
+    const children: [number, string][] = [];
+    expanded.forEach(child => {
+      const index = listing.indexOf.get(child);
+      if (parentOf.current.get(child) === path && index !== undefined) children.push([index, child]);
+    });
+    return children.sort((a, b) => a[0] - b[0]);
   };
 
-  const updateDirectoryContents = (path: string, fileList: any[]) => {
-    const nodes: FileNode[] = fileList.map((file: any) => ({
-      name: file.name,
-      path: file.path,
-      type: file.type,
-      children: file.type === 'folder' ? [] : undefined
-    }));
-
-    if (path === rootPath) {
-      setFiles(nodes);
-      // Auto-expand root
-      const newExpanded = new Set(expanded);
-      nodes.forEach(node => {
-        if (node.type === 'folder') {
-          newExpanded.add(node.path);
-        }
-      });
-      setExpanded(newExpanded);
-    } else {
-      // Update children of expanded folder
-      setFiles(prevFiles => updateNodeChildren(prevFiles, path, nodes));
+  // Lays out the listing of path from row offset on: collects the rows
+  // that fall in [start, end) and the missing pages they need, and returns
+  // the offset after its last row. Runs of rows off screen are skipped
+  // whole, so the cost is the expanded folders plus the rows shown.
+  const layout = (path: string, depth: number, offset: number, start: number, end: number,
+                  out: VisibleRow[], missing: [string, number][]): number => {
+    const listing = listings.current.get(path);
+    if (!listing) {
+      missing.push([path, 0]);
+      return offset;
     }
-  };
 
-  const updateNodeChildren = (nodes: FileNode[], targetPath: string, children: FileNode[]): FileNode[] => {
-    return nodes.map(node => {
-      if (node.path === targetPath) {
-        return { ...node, children };
-      } else if (node.children) {
-        return { ...node, children: updateNodeChildren(node.children, targetPath, children) };
+    const emit = (from: number, to: number) => {
+      const first = Math.max(from, from + start - offset);
+      const last = Math.min(to, from + end - offset);
+      for (let index = first; index < last; index++) {
+        const node = listing.rows[index];
+        out.push({ node, dir: path, index, depth });
+        if (!node) missing.push([path, Math.floor(index / PAGE_SIZE)]);
       }
-      return node;
-    });
+      offset += to - from;
+    };
+
+    let next = 0;
+    for (const [index, child] of expandedChildren(path, listing)) {
+      emit(next, index + 1);
+      offset = layout(child, depth + 1, offset, start, end, out, missing);
+      next = index + 1;
+    }
+    emit(next, listing.total);
+    return offset;
   };
 
+  const start = Math.max(0, Math.floor(scrollTop / ROW_HEIGHT) - OVERSCAN);
+  const end = Math.ceil((scrollTop + viewportHeight) / ROW_HEIGHT) + OVERSCAN;
+  const rows: VisibleRow[] = [];
+  const missing: [string, number][] = [];
+  const totalRows = layout(rootPath, 0, 0, start, end, rows, missing);
+
+  // Fetch the pages of the rows on screen that are not loaded yet
+  useEffect(() => {
+    missing.forEach(([path, page]) => requestPage(path, page));
+  });
+
   const toggleExpand = (path: string) => {
     const newExpanded = new Set(expanded);
     if (newExpanded.has(path)) {
       newExpanded.delete(path);
     } else {
       newExpanded.add(path);
-      // Load directory contents if not already loaded
-      loadDirectory(path);
+      if (!listings.current.has(path)) requestPage(path, 0);
     }
     setExpanded(newExpanded);
   };
@@ -99,32 +237,32 @@ const FileExplorer: React.FC<FileExplorerProps> = ({ onFileSelect }) => {
     }
   };
 
-  const renderNode = (node: FileNode, depth: number = 0): React.ReactNode => {
-    const isExpanded = expanded.has(node.path);
-    const hasChildren = node.children && node.children.length > 0;
+  const renderRow = (row: VisibleRow, position: number): React.ReactNode => {
+    const style: React.CSSProperties = {
+      position: 'absolute',
+      top: position * ROW_HEIGHT,
+      left: 0,
+      right: 0,
+      height: ROW_HEIGHT,
+      paddingLeft: `${row.depth * 16 + 8}px`
+    };
+    const node = row.node;
+    if (!node) {
+      return <div key={`${row.dir}#${row.index}`} className="file-node placeholder" style={style} />;
+    }
 
+    const isExpanded = expanded.has(node.path);
     return (
-      <div key={node.path}>
-        <div
-          className="file-node"
-          style={{ paddingLeft: `${depth * 16 + 8}px` }}
-          onClick={() => handleFileClick(node)}
-        >
-          {node.type === 'folder' && (
-            <span className="icon">
-              {isExpanded ? <ChevronDown size={16} /> : <ChevronRight size={16} />}
-            </span>
-          )}
+      <div key={node.path} className="file-node" style={style} onClick={() => handleFileClick(node)}>
+        {node.type === 'folder' && (
           <span className="icon">
-            {node.type === 'folder' ? <Folder size={16} /> : <FileText size={16} />}
+            {isExpanded ? <ChevronDown size={16} /> : <ChevronRight size={16} />}
           </span>
-          <span className="name">{node.name}</span>
-        </div>
-        {node.type === 'folder' && isExpanded && hasChildren && (
-          <div className="children">
-            {node.children!.map(child => renderNode(child, depth + 1))}
-          </div>
         )}
+        <span className="icon">
+          {node.type === 'folder' ? <Folder size={16} /> : <FileText size={16} />}
+        </span>
+        <span className="name">{node.name}</span>
       </div>
     );
   };
@@ -134,8 +272,14 @@ const FileExplorer: React.FC<FileExplorerProps> = ({ onFileSelect }) => {
       <div className="file-explorer-header">
         <h3>EXPLORER</h3>
       </div>
-      <div className="file-explorer-content">
-        {files.map(node => renderNode(node))}
+      <div
+        className="file-explorer-content"
+        ref={contentRef}
+        onScroll={event => setScrollTop(event.currentTarget.scrollTop)}
+      >
+        <div className="file-explorer-rows" style={{ height: totalRows * ROW_HEIGHT }}>
+          {rows.map((row, i) => renderRow(row, start + i))}
+        </div>
       </div>
     </div>
   );
@@ -182,12 +182,49 @@ class Bridge {
     this.send('openFile', { path });
   }
 
+  public readRange(path: string, firstLine: number, lineCount: number, revision: number) {
+    this.send('readRange', { path, firstLine, lineCount, revision });
+  }
+
+  public closeFile(path: string) {
+    this.send('closeFile', { path });
+  }
+
   public saveFile(path: string, content: string) {
     this.send('saveFile', { path, content });
   }
 
-  public listDirectory(path: string) {
-    this.send('listDirectory', { path });
+  // size and modified cost a stat per entry; leave them off when unused.
+  // With a limit, one page of the sorted listing comes back; continue with
+  // the reply's nextCursor, or jump anywhere with offset.
+  public listDirectory(path: string, options: {
+    size?: boolean;
+    modified?: boolean;
+    sort?: 'type' | 'name' | 'size' | 'modified';
+    descending?: boolean;
+    offset?: number;
+    limit?: number;
+    cursor?: string;
+  } = {}) {
+    this.send('listDirectory', { path, ...options });
+  }
+
+  // Matches arrive as 'contentSearchResults' batches; a new search cancels
+  // the running one. 'contentSearchStarted' has loading set, and nothing is
+  // searched, until 'projectReady' arrives.
+  public searchContent(pattern: string, options: { regex?: boolean; caseSensitive?: boolean; maxResults?: number } = {}) {
+    this.send('searchContent', { pattern, ...options });
+  }
+
+  public cancelSearch() {
+    this.send('cancelSearch');
+  }
+
+  // Best fuzzy matches among the project's files, as 'quickOpenResults';
+  // pass refresh when the quick-open box opens to pick up new files. The
+  // reply has loading set (and no results) until 'projectReady' arrives.
+  public quickOpen(query: string, options: { maxResults?: number; refresh?: boolean } = {}) {
+    this.send('quickOpen', { query, ...options });
   }
 
   public createDirectory(path: string) {
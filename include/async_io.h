@@ -0,0 +1,160 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include "file_operations.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+class WorkStealingPool;
+
+/**
+ * AsyncIO - Completion-based file I/O that never blocks the caller
+ *
+ * Every request returns a future, or takes a callback run once it
+ * completes. On Linux the requests go through an io_uring: each becomes one
+ * or more submission entries and a single reaper thread turns completions
+ * into results. Requests that need several steps (a whole-file read is
+ * openat, statx, read and close) queue the next step from the reaper, and a
+ * batch of stats goes to the kernel in a single io_uring_enter.
+ *
+ * Writes keep FileOperations::writeFile's semantics (temporary file,
+ * rename, permissions kept), which the ring cannot express, and run on a
+ * small thread pool. Writes to one path land in the order they were made;
+ * one still queued behind a newer write to its path is skipped and
+ * completes with the newer one. Everything runs on the pool where io_uring
+ * is missing: other systems, kernels before 5.6, or sandboxes that forbid
+ * it.
+ *
+ * Callbacks run on the reaper or a pool thread, one at a time per request;
+ * they must not block, but may submit more requests.
+ */
+class AsyncIO {
+public:
+    enum class Backend { IO_URING, THREAD_POOL };
+
+    // error is an errno value, 0 on success
+    struct Stat {
+        int error = 0;
+        bool isDirectory = false;
+        uint64_t size = 0;
+        int64_t modified = 0;   // seconds since the epoch
+    };
+
+    struct Read {
+        int error = 0;
+        std::string data;
+    };
+
+    struct Open {
+        int error = 0;
+        int fd = -1;   // owned by the caller, who closes it (close() below)
+    };
+
+    template <typename T>
+    using Callback = std::function<void(T&&)>;
+
+    // threads: pool size for writes and the fallback backend
+    explicit AsyncIO(size_t threads = 4, Backend preferred = Backend::IO_URING);
+    // Waits for every request in flight
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    // The process-wide instance, created on first use
+    static AsyncIO& shared();
+
+    Backend backend() const { return ring_ ? Backend::IO_URING : Backend::THREAD_POOL; }
+
+    // The whole file
+    std::future<Read> read(const std::string& path);
+    void read(const std::string& path, Callback<Read> done);
+    // Up to length bytes at offset of an open file (fewer at its end)
+    std::future<Read> read(int fd, uint64_t offset, size_t length);
+    void read(int fd, uint64_t offset, size_t length, Callback<Read> done);
+
+    std::future<bool> write(const std::string& path, std::string content,
+                            const FileOperations::WriteOptions& options = FileOperations::WriteOptions());
+    void write(const std::string& path, std::string content, const FileOperations::WriteOptions& options,
+               Callback<bool> done);
+
+    // Follows symlinks, like stat()
+    std::future<Stat> stat(const std::string& path);
+    void stat(const std::string& path, Callback<Stat> done);
+    // Many paths in one submission; done gets the results in path order
+    std::future<std::vector<Stat>> stat(const std::vector<std::string>& paths);
+    void stat(const std::vector<std::string>& paths, Callback<std::vector<Stat>> done);
+
+    // flags and mode as for open(2); O_CLOEXEC is added
+    std::future<Open> open(const std::string& path, int flags, int mode = 0644);
+    void open(const std::string& path, int flags, int mode, Callback<Open> done);
+    // Completes with 0 or an errno value
+    std::future<int> close(int fd);
+    void close(int fd, Callback<int> done);
+
+    // Run a task on the pool, for work too slow for a completion callback
+    void runOnPool(std::function<void()> task);
+
+private:
+    struct Ring;
+    struct Request;
+    struct ReadFile;
+    struct ReadAt;
+    struct StatPath;
+    struct OpenPath;
+    struct CloseFile;
+
+    struct PendingWrite {
+        std::shared_ptr<const std::string> content;
+        FileOperations::WriteOptions options;
+        Callback<bool> done;
+    };
+
+    std::unique_ptr<Ring> ring_;
+    std::unique_ptr<WorkStealingPool> pool_;
+
+    // Ring requests and steps waiting for room in the completion queue
+    std::mutex submitMutex_;
+    std::deque<Request*> backlog_;
+    std::vector<std::pair<Request*, int>> failed_;   // refused by the kernel, with the errno
+    size_t inFlight_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread reaper_;
+
+    // Writes not yet started, by path; a path is present while one of its
+    // writes runs
+    std::mutex writeMutex_;
+    std::unordered_map<std::string, std::vector<PendingWrite>> writes_;
+
+    bool startRing();
+    void submit(Request* request);
+    void submit(const std::vector<Request*>& requests);
+    void submitLocked(Request* request);
+    void enterLocked();
+    void completeFailed();
+    void reap();
+    void drainWrites(const std::string& path);
+
+    template <typename T>
+    static Callback<T> fulfil(std::future<T>& future) {
+        auto promise = std::make_shared<std::promise<T>>();
+        future = promise->get_future();
+        return [promise](T&& value) { promise->set_value(std::move(value)); };
+    }
+};
+
+} // namespace HybridIDE
+
+#endif // ASYNC_IO_H
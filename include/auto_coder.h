@@ -8,6 +8,9 @@
 
 namespace HybridIDE {
 
+class FileTree;
+class TextBuffer;
+
 enum class Language {
     CPP,
     PYTHON,
@@ -92,6 +95,8 @@ public:
     bool fixLogicLoops(const std::string& filePath);
     bool fixMissingIncludes(const std::string& filePath);
     bool recursiveFixUntilZeroErrors(const std::string& projectPath);
+    // Same over a loaded project tree; its extension index lists the sources
+    bool recursiveFixUntilZeroErrors(const FileTree& tree);
     
     // D - Auto Coder Completer
     std::string completeUnfinishedCode(const std::string& partialCode, Language language);
@@ -231,6 +236,8 @@ private:
     std::string generateBoilerplate(Language language);
     bool compileAndTest(const std::string& code, Language language);
     std::vector<std::string> extractDependencies(const std::string& code, Language language);
+    bool fixSourcesUntilZeroErrors(const std::vector<std::string>& sources);
+    std::vector<CodeError> detectErrors(const TextBuffer& buffer, Language language);
 };
 
 } // namespace HybridIDE
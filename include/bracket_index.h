@@ -0,0 +1,115 @@
+#ifndef BRACKET_INDEX_H
+#define BRACKET_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "text_buffer.h"
+#include "syntax_highlighter.h"
+
+namespace HybridIDE {
+
+/**
+ * BracketIndex - Incremental bracket matching and code-folding index
+ *
+ * Keeps a nesting summary for every line (brackets inside strings and
+ * comments are ignored, using the highlighter's cached lexer states) and
+ * aggregates them over 64-line blocks in a segment tree. Matching a bracket
+ * or finding where a fold ends descends the tree and then re-lexes at most
+ * two blocks, instead of scanning the file. Like the highlighter, lines are
+ * scanned lazily and an edit only re-scans lines until the lexer state
+ * converges again.
+ */
+class BracketIndex {
+public:
+    struct Position {
+        size_t line;
+        size_t column;   // byte column
+    };
+
+    struct FoldRegion {
+        size_t startLine;
+        size_t endLine;   // line of the closing bracket
+    };
+
+    BracketIndex();
+
+    // Invalidate everything (file loaded or replaced wholesale)
+    void reset(size_t lineCount);
+
+    // Lines [startLine, oldEndLine] were replaced by [startLine, newEndLine]
+    void applyEdit(size_t startLine, size_t oldEndLine, size_t newEndLine);
+
+    // Bracket matching the one at `at`. Returns false if there is no bracket
+    // there, it is unbalanced, or the pair has different kinds, e.g. "(]".
+    bool findMatch(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                   const Position& at, Position& match);
+
+    // Multi-line regions that start on lines [firstLine, lastLine)
+    std::vector<FoldRegion> getFoldRegions(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                                           size_t firstLine, size_t lastLine);
+
+    // First closing bracket without an opener / last opener that is never closed
+    bool findUnmatchedClose(const TextBuffer& buffer, SyntaxHighlighter& highlighter, Position& at);
+    bool findUnmatchedOpen(const TextBuffer& buffer, SyntaxHighlighter& highlighter, Position& at);
+
+    // Number of lines scanned by the most recent update
+    size_t getLastRescanCount() const { return lastRescanCount_; }
+
+private:
+    struct Bracket {
+        uint32_t column;
+        char ch;
+    };
+
+    // Nesting effect of a run of brackets (openers +1, closers -1). The
+    // largest suffix sum is net - minPrefix, so it needs no field of its own.
+    struct Summary {
+        int32_t net = 0;
+        int32_t minPrefix = 0;   // lowest running sum, never above 0
+    };
+
+    struct LineInfo {
+        Summary summary;
+        uint8_t entryState = 0;   // lexer state at the start of the line
+    };
+
+    std::vector<LineInfo> lines_;
+    size_t firstDirty_;   // first line whose summary may be stale
+    size_t dirtyUntil_;   // lines up to here must be re-scanned unconditionally
+    size_t lastRescanCount_;
+
+    std::vector<Summary> tree_;   // block summaries; leaves at [leafCount_, 2 * leafCount_)
+    size_t leafCount_;
+    size_t staleBlock_;           // first block whose leaf and ancestors are out of date
+
+    // Scratch space reused by every scan
+    std::vector<SyntaxHighlighter::Token> tokens_;
+    std::vector<Bracket> brackets_;
+
+    void ensure(const TextBuffer& buffer, SyntaxHighlighter& highlighter, size_t line);
+    void lexBrackets(std::string_view text, uint8_t state, const SyntaxHighlighter& highlighter);
+    void loadLine(const TextBuffer& buffer, const SyntaxHighlighter& highlighter, size_t line);
+    size_t cleanBlockCount() const;
+    void updateTree(size_t cleanBlocks);
+
+    static Summary combine(const Summary& left, const Summary& right);
+
+    // Scan from bracket `index` of `line` for the bracket that brings the
+    // nesting depth below (forward) or above (backward) its starting value.
+    // Returns that bracket's character, or 0 if there is none.
+    char searchForward(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                       size_t line, size_t index, Position& out);
+    char searchBackward(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                        size_t line, size_t index, Position& out);
+    size_t descendForward(size_t node, size_t begin, size_t end, size_t from, size_t limit,
+                          int64_t& depth) const;
+    size_t descendBackward(size_t node, size_t begin, size_t end, size_t to,
+                           int64_t& depth) const;
+};
+
+} // namespace HybridIDE
+
+#endif // BRACKET_INDEX_H
@@ -7,6 +7,7 @@
 
 struct CompileOptions {
     std::string sourceFile;
+    std::vector<std::string> additionalSources;   // compiled and linked with sourceFile
     std::string outputFile;
     std::vector<std::string> includePaths;
     std::vector<std::string> libraries;
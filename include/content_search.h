@@ -0,0 +1,113 @@
+#ifndef CONTENT_SEARCH_H
+#define CONTENT_SEARCH_H
+
+#include "text_search.h"
+#include "mapped_file.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * PatternLiterals - The literal text every match of a pattern contains
+ *
+ * A pattern in RegexSearcher syntax (or a plain literal) reduced to a tree:
+ * an AND node holds runs of literal characters that all appear in a match,
+ * plus children that must all match; an OR node needs any one child. ALL
+ * means nothing is known. Runs never cross a line break, since matches
+ * never do. Used to narrow a search before running the pattern itself.
+ */
+struct PatternLiterals {
+    enum class Op { ALL, AND, OR };
+    Op op = Op::ALL;
+    std::vector<std::string> runs;
+    std::vector<PatternLiterals> children;
+
+    // The pattern must be valid if regex is set
+    static PatternLiterals analyze(const std::string& pattern, bool regex);
+
+    // A set of literals such that every match contains at least one of
+    // them, preferring the set whose shortest member is longest; empty if
+    // there is none
+    std::vector<std::string> required() const;
+};
+
+/**
+ * FileContent - A whole file's bytes, read or mapped by size
+ *
+ * Small files are read with one call into a buffer that is reused by the
+ * next load(); large ones are mapped and advised for a sequential scan.
+ */
+class FileContent {
+public:
+    static constexpr uint64_t kMapThreshold = 1024 * 1024;
+
+    bool load(const std::string& path);
+    std::string_view view() const { return view_; }
+
+private:
+    std::string buffer_;
+    std::shared_ptr<const MappedFile> mapped_;
+    std::string_view view_;
+};
+
+/**
+ * ContentSearcher - A literal or regex query run over whole files
+ *
+ * The per-file half of project search, shared by the trigram index and the
+ * grep engine. Literals are found with the SIMD LiteralSearcher; a regex is
+ * only run on the lines holding one of its required literals (see
+ * PatternLiterals), which the literal scan finds without looking at the
+ * rest. Not thread-safe, as the regex DFA is built lazily: use one per
+ * thread.
+ */
+class ContentSearcher {
+public:
+    struct Query {
+        bool caseSensitive = true;
+        bool regex = false;
+        size_t maxResults = 10000;
+    };
+
+    struct Match {
+        std::string path;
+        size_t line;      // 1-based
+        size_t column;    // byte offset in the line
+        size_t length;
+        std::string text;   // the line, cut at kMaxLineText bytes
+    };
+
+    static constexpr size_t kMaxLineText = 512;
+    static constexpr size_t kBinaryProbe = 8192;
+
+    ContentSearcher(const std::string& pattern, const Query& query);
+
+    bool isValid() const { return valid_; }
+    const std::string& getError() const { return error_; }
+
+    // Append the matches in one file's contents, stopping once matches
+    // holds limit entries
+    void find(std::string_view data, const std::string& path, size_t limit, std::vector<Match>& matches);
+
+    // Contents with a NUL in their first kBinaryProbe bytes
+    static bool isBinary(std::string_view data);
+
+private:
+    Query query_;
+    bool valid_;
+    std::string error_;
+    LiteralSearcher literal_;
+    std::unique_ptr<RegexSearcher> regex_;
+    std::vector<LiteralSearcher> filters_;   // required literals of regex_
+
+    void findLiteral(std::string_view data, const std::string& path, size_t limit, std::vector<Match>& matches);
+    void findRegex(std::string_view data, const std::string& path, size_t limit, std::vector<Match>& matches);
+};
+
+} // namespace HybridIDE
+
+#endif // CONTENT_SEARCH_H
@@ -2,8 +2,16 @@
 #define FILE_OPERATIONS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
 #include <functional>
+#include <cstddef>
+
+namespace HybridIDE {
+class MappedFile;
+class JsonWriter;
+}
 
 struct FileInfo {
     std::string name;
@@ -13,16 +21,91 @@ struct FileInfo {
     std::string modified;
 };
 
+// A file's bytes, shared without copying. Small files are read into one
+// buffer with a single pre-sized read, large ones are mapped for a
+// sequential pass. Copies of a view share the bytes, which stay valid while
+// any copy lives.
+class FileView {
+public:
+    static constexpr size_t kMapThreshold = 1024 * 1024;
+
+    const char* data() const { return view_.data(); }
+    size_t size() const { return view_.size(); }
+    bool empty() const { return view_.empty(); }
+    std::string_view view() const { return view_; }
+
+    // The mapping, if the file was mapped
+    const std::shared_ptr<const HybridIDE::MappedFile>& mapping() const { return mapped_; }
+
+    // The bytes as a string, leaving the view empty. A read buffer no other
+    // view shares is moved out; anything else is copied once.
+    std::string release();
+
+private:
+    friend class FileOperations;
+
+    std::shared_ptr<std::string> buffer_;
+    std::shared_ptr<const HybridIDE::MappedFile> mapped_;
+    std::string_view view_;
+};
+
 class FileOperations {
 public:
+    // What listDirectory() fills in besides name, path and type. Names and
+    // types come from the directory itself; size and modified each need
+    // the entry stat'ed, so leave them off when they are not shown.
+    struct ListOptions {
+        bool size = true;
+        bool modified = true;
+        size_t statThreads = 1;   // >1 (0 = one per hardware thread) stats huge directories in parallel
+    };
+
+    // How writeFile() puts a file in place. A write goes to a temporary file
+    // next to the target that is synced and then renamed over it, so
+    // readers and crashes see the old content or the new, never a torn
+    // file. An existing target keeps its permissions and, where we may give
+    // it away, its owner; symlinks are written through. Extended attributes
+    // and ACLs are not carried over. A target with other hard links, one
+    // whose owner we cannot keep, or one in a directory we cannot create
+    // the temporary file in is truncated and written in place instead,
+    // without those guarantees.
+    struct WriteOptions {
+        bool durable = false;             // also sync the directory, so the new content survives a crash
+        bool createDirectories = true;    // create missing parent directories
+        bool executable = false;          // new files get the execute bits (POSIX)
+        bool allowInPlace = true;         // take the in-place fallback; off while the file is mapped
+    };
+
+    // One file of a writeFiles() batch; content must outlive the call
+    struct WriteRequest {
+        std::string path;
+        std::string_view content;
+        WriteOptions options;
+    };
+
     // Read file content
     static bool readFile(const std::string& path, std::string& content);
+    // Read without copying: files of at least mapThreshold bytes are mapped
+    static bool readFile(const std::string& path, FileView& view, size_t mapThreshold = FileView::kMapThreshold);
     
     // Write file content
     static bool writeFile(const std::string& path, const std::string& content);
+    static bool writeFile(const std::string& path, std::string_view content, const WriteOptions& options);
+    // Content given as pieces (a TextBuffer's chunks), written in order
+    // without joining them first
+    static bool writeFile(const std::string& path, const std::vector<std::string_view>& pieces,
+                          const WriteOptions& options);
+
+    // Write many files at once on a pool of threads (0 = one per hardware
+    // thread). Directories of durable writes are synced once each, after
+    // all renames. Returns how many files were written; the indexes of the
+    // others go to failed, ascending.
+    static size_t writeFiles(const std::vector<WriteRequest>& requests, size_t threads = 0,
+                             std::vector<size_t>* failed = nullptr);
     
     // List directory contents
     static std::vector<FileInfo> listDirectory(const std::string& path);
+    static std::vector<FileInfo> listDirectory(const std::string& path, const ListOptions& options);
     
     // Create directory
     static bool createDirectory(const std::string& path);
@@ -42,6 +125,8 @@ public:
     // Convert to JSON string
     static std::string fileInfoToJSON(const FileInfo& info);
     static std::string fileListToJSON(const std::vector<FileInfo>& files);
+    // Append the entry's object to a document being written
+    static void writeFileInfo(HybridIDE::JsonWriter& json, const FileInfo& info);
 };
 
 #endif // FILE_OPERATIONS_H
@@ -0,0 +1,247 @@
+#ifndef FILE_TREE_H
+#define FILE_TREE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * FileTree - Flat, structure-of-arrays project tree
+ *
+ * Nodes are indices into parallel arrays of parent / first-child /
+ * next-sibling links, so a 400k-file project is a handful of contiguous
+ * vectors rather than 400k heap-allocated nodes. Names are interned once in
+ * a single string arena (node_modules repeats "index.js" and "package.json"
+ * thousands of times), and full paths are rebuilt on demand. Node, Children
+ * and Subtree are non-owning views that stay valid until the tree changes.
+ *
+ * File watcher batches are applied in place with insertChild() and
+ * remove(); the ids of removed nodes are recycled by later inserts.
+ *
+ * Two secondary indexes answer "every .cpp file" and "everything under
+ * src/" without a walk: the live nodes in depth-first order, where each
+ * node's subtree is a contiguous range, and per extension the positions of
+ * its files in that order. Every interned name knows its extension, so
+ * nothing is parsed per node. A change marks the indexes stale and the
+ * next query rebuilds them in one pass; after that queries cost
+ * O(log n + result).
+ */
+class FileTree {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kInvalid = UINT32_MAX;
+    static constexpr NodeId kRoot = 0;
+
+    class Node;
+    class Children;
+    class Subtree;
+    class IdRange;
+
+    FileTree();
+
+    // Drop every node and start over with a root named rootPath
+    void reset(const std::string& rootPath);
+    void reserve(size_t nodeCount);
+
+    // Append a node as the last child of parent
+    NodeId addChild(NodeId parent, std::string_view name, bool isDirectory);
+
+    // Insert a node in FileWalker order (directories first, then by name).
+    // Returns the existing child if parent already has one of that name.
+    NodeId insertChild(NodeId parent, std::string_view name, bool isDirectory);
+
+    // Unlink a node and its subtree (not the root)
+    void remove(NodeId id);
+
+    // Child of parent with that name, or kInvalid
+    NodeId findChild(NodeId parent, std::string_view name) const;
+
+    // size() counts id slots, including removed nodes awaiting reuse
+    size_t size() const { return parent_.size(); }
+    size_t nodeCount() const { return parent_.size() - freeNodes_.size(); }
+    bool empty() const { return parent_.empty(); }
+    size_t distinctNames() const { return nameOffset_.size(); }
+
+    // Raw links
+    NodeId parent(NodeId id) const { return parent_[id]; }
+    NodeId firstChild(NodeId id) const { return firstChild_[id]; }
+    NodeId nextSibling(NodeId id) const { return nextSibling_[id]; }
+    bool isDirectory(NodeId id) const { return isDirectory_[id] != 0; }
+    std::string_view name(NodeId id) const;
+
+    // Absolute path (root path + relative path) and root-relative path, '/'-separated
+    std::string path(NodeId id) const;
+    std::string relativePath(NodeId id) const;
+
+    // Node at a root-relative path, or kInvalid
+    NodeId find(std::string_view relativePath) const;
+
+    Node root() const;
+    Node node(NodeId id) const;
+
+    // Secondary index queries, in depth-first order like Subtree. They may
+    // rebuild the indexes, so they are not safe to call concurrently.
+    // Descendants of a node, excluding it; valid until the tree changes
+    IdRange descendants(NodeId id) const;
+    // Files below a directory whose extension (the name from its last dot,
+    // ".gz" for "a.tar.gz"; empty without a dot) is exactly extension
+    std::vector<NodeId> filesWithExtension(std::string_view extension, NodeId under = kRoot) const;
+    // Directories below a directory
+    std::vector<NodeId> directories(NodeId under = kRoot) const;
+
+    // Lightweight handle to one node
+    class Node {
+    public:
+        Node(const FileTree* tree, NodeId id) : tree_(tree), id_(id) {}
+
+        NodeId id() const { return id_; }
+        bool valid() const { return id_ != kInvalid; }
+        std::string_view name() const { return tree_->name(id_); }
+        std::string path() const { return tree_->path(id_); }
+        std::string relativePath() const { return tree_->relativePath(id_); }
+        bool isDirectory() const { return tree_->isDirectory(id_); }
+        Node parent() const { return Node(tree_, tree_->parent(id_)); }
+        Children children() const;
+        Subtree subtree() const;   // descendants, depth-first, excluding this node
+
+    private:
+        const FileTree* tree_;
+        NodeId id_;
+    };
+
+    // Direct children, in insertion order
+    class Children {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Node;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Node;
+
+            iterator(const FileTree* tree, NodeId id) : tree_(tree), id_(id) {}
+            Node operator*() const { return Node(tree_, id_); }
+            iterator& operator++() { id_ = tree_->nextSibling(id_); return *this; }
+            bool operator==(const iterator& other) const { return id_ == other.id_; }
+            bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+        private:
+            const FileTree* tree_;
+            NodeId id_;
+        };
+
+        Children(const FileTree* tree, NodeId parent) : tree_(tree), parent_(parent) {}
+        iterator begin() const { return iterator(tree_, tree_->firstChild(parent_)); }
+        iterator end() const { return iterator(tree_, kInvalid); }
+
+    private:
+        const FileTree* tree_;
+        NodeId parent_;
+    };
+
+    // Depth-first walk of a subtree by following links; needs no stack
+    class Subtree {
+    public:
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Node;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Node;
+
+            iterator(const FileTree* tree, NodeId top, NodeId id) : tree_(tree), top_(top), id_(id) {}
+            Node operator*() const { return Node(tree_, id_); }
+            iterator& operator++();
+            bool operator==(const iterator& other) const { return id_ == other.id_; }
+            bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+        private:
+            const FileTree* tree_;
+            NodeId top_;
+            NodeId id_;
+        };
+
+        Subtree(const FileTree* tree, NodeId top) : tree_(tree), top_(top) {}
+        iterator begin() const { return iterator(tree_, top_, tree_->firstChild(top_)); }
+        iterator end() const { return iterator(tree_, top_, kInvalid); }
+
+    private:
+        const FileTree* tree_;
+        NodeId top_;
+    };
+
+    // Contiguous run of node ids
+    class IdRange {
+    public:
+        IdRange(const NodeId* first, const NodeId* last) : first_(first), last_(last) {}
+        const NodeId* begin() const { return first_; }
+        const NodeId* end() const { return last_; }
+        size_t size() const { return static_cast<size_t>(last_ - first_); }
+        bool empty() const { return first_ == last_; }
+
+    private:
+        const NodeId* first_;
+        const NodeId* last_;
+    };
+
+private:
+    // Per node
+    std::vector<NodeId> parent_;
+    std::vector<NodeId> firstChild_;
+    std::vector<NodeId> lastChild_;
+    std::vector<NodeId> nextSibling_;
+    std::vector<uint32_t> nameId_;
+    std::vector<uint8_t> isDirectory_;
+    std::vector<NodeId> freeNodes_;   // removed ids, reused by the next insert
+
+    // Interned names: one arena, (offset, length) per distinct name, and an
+    // open-addressing table of name ids + 1 (0 = empty slot)
+    std::string names_;
+    std::vector<uint32_t> nameOffset_;
+    std::vector<uint32_t> nameLength_;
+    std::vector<uint32_t> nameTable_;
+
+    // Extension id of every interned name, and the ids by extension
+    std::vector<uint32_t> nameExtension_;
+    std::map<std::string, uint32_t, std::less<>> extensionIds_;
+
+    // Secondary indexes, rebuilt by the first query after a change. order_
+    // holds the live nodes below the root depth-first; a node's descendants
+    // are order_[orderIndex_ + 1, subtreeEnd_). The file and directory
+    // lists hold ascending positions in order_.
+    mutable bool indexed_ = false;
+    mutable std::vector<NodeId> order_;
+    mutable std::vector<uint32_t> orderIndex_;
+    mutable std::vector<uint32_t> subtreeEnd_;
+    mutable std::vector<std::vector<uint32_t>> extensionFiles_;
+    mutable std::vector<uint32_t> directoryOrder_;
+
+    NodeId allocate(NodeId parent, std::string_view name, bool isDirectory);
+    uint32_t intern(std::string_view name);
+    uint32_t findName(std::string_view name) const;
+    void growNameTable();
+    void buildIndexes() const;
+    // Positions of list within the subtree of under, as [first, last)
+    std::pair<const uint32_t*, const uint32_t*> within(const std::vector<uint32_t>& list, NodeId under) const;
+};
+
+inline FileTree::Children FileTree::Node::children() const {
+    return Children(tree_, id_);
+}
+
+inline FileTree::Subtree FileTree::Node::subtree() const {
+    return Subtree(tree_, id_);
+}
+
+} // namespace HybridIDE
+
+#endif // FILE_TREE_H
@@ -0,0 +1,152 @@
+#ifndef FILE_WALKER_H
+#define FILE_WALKER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * IgnoreRules - One .gitignore / .ignore file
+ *
+ * Supports the gitignore pattern syntax: comments, "!" negation, trailing
+ * "/" for directories only, patterns anchored by an inner "/", and the
+ * "*", "?", "[...]" and "**" wildcards. Patterns without wildcards or with
+ * only a leading "*" are compared directly instead of through the globber.
+ */
+class IgnoreRules {
+public:
+    enum class Match { NONE, IGNORE, INCLUDE };
+
+    IgnoreRules() = default;
+    explicit IgnoreRules(std::string_view content);
+
+    void add(std::string_view content);
+    bool empty() const { return rules_.empty(); }
+
+    // path is relative to the directory holding the ignore file, '/'-separated;
+    // name is its last component. The last matching rule decides.
+    Match match(std::string_view path, std::string_view name, bool isDirectory) const;
+
+    // gitignore-style glob: '*' and '?' stop at '/', "**/" spans directories
+    static bool globMatch(std::string_view pattern, std::string_view path);
+
+private:
+    enum class Kind { LITERAL, SUFFIX, GLOB };
+
+    struct Rule {
+        std::string pattern;
+        Kind kind;
+        bool negate;
+        bool directoryOnly;
+        bool anchored;   // matched against the relative path, not the name
+    };
+
+    std::vector<Rule> rules_;
+};
+
+/**
+ * FileWalker - Parallel directory walker
+ *
+ * Every directory is a task on a WorkStealingPool. Entry types come from
+ * readdir's d_type (or the FindFirstFileEx attributes on Windows), so no
+ * entry is stat()ed unless the file system leaves its type unknown. Ignore
+ * files are applied as the walk descends, and ignored directories are never
+ * opened. The .git directory and the IDE's own .hybridide directory are
+ * always skipped.
+ */
+class FileWalker {
+public:
+    static constexpr uint32_t kNoDirectory = UINT32_MAX;
+
+    struct Entry {
+        std::string name;
+        bool isDirectory;
+        uint32_t directoryId;   // id this subdirectory is visited under, or kNoDirectory
+    };
+
+    struct Options {
+        size_t threads = 0;              // 0 = one per hardware thread
+        bool respectIgnoreFiles = true;  // .gitignore, .ignore and .git/info/exclude
+        bool includeHidden = true;       // dot files and directories
+
+        // Supplies a directory's raw (unsorted, unfiltered) listing in place
+        // of reading it, e.g. from a cache. Return false, leaving entries
+        // untouched, to have the directory read. Called concurrently.
+        std::function<bool(const std::string& relativePath, const std::string& absolutePath,
+                           std::vector<Entry>& entries)> lister;
+
+        // Once set, no further directory is opened and the walk winds down
+        const std::atomic<bool>* cancel = nullptr;
+    };
+
+    struct Directory {
+        uint32_t id = 0;                   // 0 for the root; ids are dense
+        uint32_t parentId = kNoDirectory;  // kNoDirectory for the root
+        std::string path;    // relative to the root, '/'-separated ("" for the root)
+        std::vector<Entry> entries;   // directories first, then by name
+    };
+
+    // Called once per directory, concurrently from the walker's threads.
+    // The visitor may move data out of the directory.
+    using Visitor = std::function<void(Directory& directory)>;
+
+    // Walk the tree under root. Returns the number of directories visited,
+    // or 0 if root could not be opened.
+    static size_t walk(const std::string& root, const Options& options, const Visitor& visitor);
+
+    // Walk and return every directory, indexed by id
+    static std::vector<Directory> collect(const std::string& root, const Options& options);
+
+    // One unsorted, unfiltered listing with d_type-derived entry types.
+    // Returns false if the directory cannot be opened.
+    static bool listDirectory(const std::string& path, std::vector<Entry>& entries);
+};
+
+struct IgnoreLevel;
+
+/**
+ * IgnoreMatcher - Answers "would FileWalker skip this path?" for single paths
+ *
+ * For code that learns about paths one at a time (file watchers, saves)
+ * rather than by walking. The ignore files of each directory are read on
+ * first use and cached together with whether the directory itself is
+ * skipped. Thread-safe.
+ */
+class IgnoreMatcher {
+public:
+    IgnoreMatcher(const std::string& root, const FileWalker::Options& options);
+    ~IgnoreMatcher();
+
+    // relativePath is '/'-separated and relative to the root
+    bool isIgnored(const std::string& relativePath, bool isDirectory);
+
+    // Forget cached rules of a directory and everything below it, e.g.
+    // after its .gitignore changed ("" for the root)
+    void invalidate(const std::string& directory);
+
+private:
+    struct DirectoryState {
+        std::shared_ptr<const IgnoreLevel> level;
+        bool ignored;
+    };
+
+    std::string root_;
+    FileWalker::Options options_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, DirectoryState> directories_;
+
+    const DirectoryState& stateOf(const std::string& directory);
+};
+
+} // namespace HybridIDE
+
+#endif // FILE_WALKER_H
@@ -0,0 +1,147 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include "file_walker.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace HybridIDE {
+
+/**
+ * FileWatcher - Batched change notifications for a set of directories
+ *
+ * Watches the directories it is told about (inotify watches, or one
+ * fanotify mark on the whole file system; ReadDirectoryChangesW on
+ * Windows) and turns the raw event stream into coalesced batches on a
+ * background thread. A batch is delivered once no event has arrived for
+ * quietMs, or at the latest maxLatencyMs after its first event, so a
+ * 20k-file checkout arrives as a few large batches instead of 60k
+ * callbacks. Within a batch every path appears once: a file created and
+ * deleted again disappears entirely, repeated writes collapse into one
+ * MODIFIED, and changes below a deleted directory are folded into its
+ * DELETED. Changes are sorted by path, so a directory's CREATED always
+ * precedes those of its contents.
+ *
+ * When the kernel drops events (inotify queue overflow), or an ignore file
+ * changes while filterIgnored is set, the batch is a single RESCAN;
+ * consumers must then re-list what they show.
+ */
+class FileWatcher {
+public:
+    enum class ChangeType { CREATED, DELETED, MODIFIED, RESCAN };
+    enum class Backend { INOTIFY, FANOTIFY };
+
+    struct Change {
+        ChangeType type;
+        std::string path;   // relative to the root, '/'-separated ("" for RESCAN)
+        bool isDirectory;
+        bool ignored = false;   // reported only with reportIgnored
+    };
+
+    struct Options {
+        Backend backend = Backend::INOTIFY;   // FANOTIFY needs CAP_SYS_ADMIN; falls back to inotify
+        int quietMs = 50;          // deliver once events stop for this long...
+        int maxLatencyMs = 250;    // ...or this long after a batch's first event
+        bool watchNewDirectories = true;   // watch (and report the contents of) directories created later
+        bool filterIgnored = true;         // drop paths FileWalker would skip...
+        bool reportIgnored = false;        // ...or report them marked ignored, without watching into them
+        FileWalker::Options walk;          // ignore-file and hidden-file handling for filterIgnored
+    };
+
+    // Called on the watcher thread; the handler may move the changes out
+    using BatchHandler = std::function<void(std::vector<Change>& changes)>;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Start watching root itself. Returns false if no backend is available.
+    bool start(const std::string& root, const Options& options, BatchHandler onBatch);
+    void stop();
+    bool isRunning() const { return running_; }
+    Backend backend() const { return backend_; }
+
+    // Watch one more directory (non-recursive; relative to the root). Safe
+    // from any thread. Returns false if the directory cannot be watched.
+    bool addDirectory(const std::string& relativePath);
+
+    // Stop watching a directory and every watched directory below it
+    void removeDirectory(const std::string& relativePath);
+
+    size_t watchedDirectories() const;
+
+private:
+    // MOVED_IN is a CREATED that may have silently replaced an entry (rename
+    // over an existing file), so a later delete must still be reported
+    enum class Pending { CREATED, MOVED_IN, DELETED, MODIFIED, REPLACED };
+
+    struct PendingChange {
+        Pending type;
+        bool isDirectory;
+        bool ignored;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    std::string root_;
+    Options options_;
+    BatchHandler onBatch_;
+    Backend backend_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+    std::unique_ptr<IgnoreMatcher> ignore_;
+
+    // Watched directories by relative path, and the reverse map from
+    // inotify watch descriptors (unused by the other backends)
+    mutable std::mutex mutex_;
+    std::map<std::string, int> watched_;
+    std::unordered_map<int, std::string> watchPaths_;
+
+    // Owned by the watcher thread
+    std::map<std::string, PendingChange> pending_;
+    std::set<std::string> ignoreChanged_;   // directories whose ignore files changed
+    bool overflowed_;
+    Clock::time_point firstEvent_;
+    Clock::time_point lastEvent_;
+
+#ifdef _WIN32
+    void* directoryHandle_;
+    void* stopEvent_;
+#else
+    int notifyFd_;
+    int wakeFd_;
+    int mountFd_;   // fanotify: resolves directory handles back to paths
+    std::string realRoot_;
+    std::unordered_map<std::string, std::string> handlePaths_;
+#endif
+
+    void run();
+    void readEvents(const char* buffer, size_t size);
+    bool isWatched(const std::string& directory) const;
+    void onEvent(Pending type, const std::string& directory, const std::string& name, bool isDirectory);
+    void record(Pending type, const std::string& path, bool isDirectory, bool ignored);
+    void markOverflowed();
+    void scanNewDirectory(const std::string& path);
+    void flush();
+    int flushTimeoutMs() const;
+
+    bool watch(const std::string& relativePath);
+    void unwatchBelow(const std::string& relativePath);
+    void closeHandles();
+};
+
+} // namespace HybridIDE
+
+#endif // FILE_WATCHER_H
@@ -0,0 +1,77 @@
+#ifndef FUZZY_FINDER_H
+#define FUZZY_FINDER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+class WorkStealingPool;
+
+/**
+ * FuzzyFinder - Quick-open matcher over a fixed list of paths
+ *
+ * A path matches if the query's characters appear in it in order. Every
+ * path carries a 64-bit mask of the characters it contains, so most paths
+ * are rejected by one AND before a byte is compared. Survivors are scored
+ * with a Smith-Waterman style alignment: matched characters score, gaps
+ * cost, and matches at the start of a path segment, a word or a camelCase
+ * hump earn a bonus. Only the window between the first possible start and
+ * the last possible end is aligned.
+ *
+ * The list is scored in parallel chunks, each keeping its best results in
+ * a bounded heap. A query that extends the previous one (the next
+ * keystroke) only looks at the paths the previous one matched. Matching is
+ * case-insensitive unless the query has an upper-case letter. Not
+ * thread-safe.
+ */
+class FuzzyFinder {
+public:
+    struct Result {
+        uint32_t index;    // into the path list
+        int score;
+        std::string path;
+        std::vector<uint32_t> positions;   // byte offsets of the matched characters
+    };
+
+    explicit FuzzyFinder(size_t threads = 0);   // 0 = one per hardware thread
+    ~FuzzyFinder();
+
+    FuzzyFinder(const FuzzyFinder&) = delete;
+    FuzzyFinder& operator=(const FuzzyFinder&) = delete;
+
+    void setPaths(const std::vector<std::string>& paths);
+    size_t size() const { return masks_.size(); }
+    std::string_view path(uint32_t index) const {
+        return std::string_view(text_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    // The best `limit` matches, best first; ties go to the shorter path.
+    // Whitespace in the query is ignored. An empty query lists the first
+    // paths unscored.
+    std::vector<Result> find(std::string_view query, size_t limit);
+
+private:
+    std::string text_;               // every path, back to back
+    std::vector<uint32_t> offsets_;  // path i is [offsets_[i], offsets_[i + 1])
+    std::string folded_;             // text_ in lower case
+    std::vector<uint64_t> masks_;
+    size_t threads_;
+    std::unique_ptr<WorkStealingPool> pool_;
+
+    // The last query and the paths it matched, ascending
+    std::string lastQuery_;
+    bool lastCaseSensitive_ = false;
+    bool hasLast_ = false;
+    std::vector<uint32_t> lastMatches_;
+
+    WorkStealingPool& pool();
+};
+
+} // namespace HybridIDE
+
+#endif // FUZZY_FINDER_H
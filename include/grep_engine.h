@@ -0,0 +1,89 @@
+#ifndef GREP_ENGINE_H
+#define GREP_ENGINE_H
+
+#include "content_search.h"
+#include "file_walker.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * GrepEngine - Brute-force parallel content search with streamed results
+ *
+ * For searching a project without a warm index. One thread walks the tree
+ * (FileWalker, honouring ignore files) and hands each directory's files, in
+ * small chunks, to a pool of searcher threads as soon as it is listed, so
+ * matching starts with the first directory instead of after the walk. Files
+ * are read or mapped depending on their size, files with a NUL near the
+ * start are skipped as binary, and regexes only run on lines holding one of
+ * their required literals (ContentSearcher).
+ *
+ * Matches are delivered in batches while the search runs: the first ones
+ * at once, then whenever a batch fills up or its oldest match has waited
+ * kFlushIntervalMs. Starting a search cancels the running one, and nothing
+ * of a cancelled search is delivered once start() or cancel() returns.
+ */
+class GrepEngine {
+public:
+    using Query = ContentSearcher::Query;
+    using Match = ContentSearcher::Match;
+
+    struct Options {
+        size_t threads = 0;        // searcher threads; 0 = one per hardware thread
+        size_t batchSize = 256;    // matches per delivered batch
+        FileWalker::Options walk;  // walk.threads is ignored: one thread lists
+    };
+
+    struct Progress {
+        uint64_t searchId = 0;
+        size_t filesSearched = 0;
+        size_t matches = 0;          // delivered so far, this batch included
+        bool done = false;           // the search's last batch, possibly empty
+        bool limitReached = false;   // stopped at Query::maxResults
+    };
+
+    // Called from the search threads, one call at a time. It may move the
+    // matches out of batch, but must not call back into the engine.
+    using BatchCallback = std::function<void(const Progress& progress, std::vector<Match>& batch)>;
+
+    static constexpr int kFlushIntervalMs = 30;
+
+    GrepEngine();
+    ~GrepEngine();
+
+    GrepEngine(const GrepEngine&) = delete;
+    GrepEngine& operator=(const GrepEngine&) = delete;
+
+    // Cancel the running search and start searching the files under root.
+    // Returns the new search's id, or 0 if the pattern is empty or invalid
+    // (with error set).
+    uint64_t start(const std::string& root, const std::string& pattern, const Query& query,
+                   const Options& options, BatchCallback onBatch, std::string* error = nullptr);
+
+    // Stop the running search without waiting for its threads
+    void cancel();
+
+    // Block until the running search has delivered its last batch
+    void wait();
+
+private:
+    struct Search;
+
+    std::mutex mutex_;
+    std::unique_ptr<Search> current_;
+    std::vector<std::unique_ptr<Search>> retired_;   // cancelled, possibly still winding down
+    uint64_t nextId_;
+
+    void cancelLocked();
+    void reap(bool block);
+};
+
+} // namespace HybridIDE
+
+#endif // GREP_ENGINE_H
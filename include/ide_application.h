@@ -5,7 +5,11 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <future>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
 #include "ai_api_client.h"
 #include "compiler.h"
 #include "debugger.h"
@@ -13,6 +17,17 @@
 #include "kubernetes_manager.h"
 #include "cloud_sync.h"
 #include "collaboration.h"
+#include "text_buffer.h"
+#include "text_search.h"
+#include "syntax_highlighter.h"
+#include "bracket_index.h"
+#include "file_tree.h"
+#include "file_watcher.h"
+#include "project_index.h"
+#include "trigram_index.h"
+#include "grep_engine.h"
+#include "fuzzy_finder.h"
+#include "undo_history.h"
 
 namespace HybridIDE {
 
@@ -73,6 +88,15 @@ public:
         bool enableSyntaxHighlight = true;
         int tabSize = 4;
         bool useTabs = false;
+        size_t mmapThreshold = 16 * 1024 * 1024;  // files this large are mapped, not read
+    };
+
+    // Lines [startLine, oldEndLine] were replaced by [startLine, newEndLine]
+    struct ChangeEvent {
+        size_t startLine;
+        size_t oldEndLine;
+        size_t newEndLine;
+        unsigned long long revision;
     };
 
     EditorTab(const std::string& filePath = "");
@@ -82,14 +106,35 @@ public:
     bool open(const std::string& filePath);
     bool save();
     bool saveAs(const std::string& filePath);
+    // Save a snapshot on a worker thread; editing can continue meanwhile
+    std::shared_future<bool> saveAsync();
     bool close();
 
     // Content operations
-    std::string getContent() const;
+    TextBuffer::View getContent() const;
+    const TextBuffer& getBuffer() const;
+    // O(1) immutable copy for background readers (formatter, AI context, ...)
+    TextBuffer snapshot() const;
     void setContent(const std::string& content);
     void insertText(int line, int col, const std::string& text);
     void deleteText(int startLine, int startCol, int endLine, int endCol);
 
+    // Apply many edits (byte offsets into the current text) as one transaction:
+    // a single pass over the buffer, one undo step and one change notification.
+    // Returns false without changing anything if any two edits overlap.
+    bool applyEdits(std::vector<TextBuffer::Edit> edits);
+
+    // Change notification
+    void setChangeCallback(std::function<void(const ChangeEvent&)> callback);
+    unsigned long long getRevision() const;
+
+    // Undo/redo
+    bool undo();
+    bool redo();
+    bool canUndo() const;
+    bool canRedo() const;
+    void setUndoMemoryLimit(size_t bytes);
+
     // Selection
     std::string getSelectedText() const;
     void selectAll();
@@ -97,6 +142,8 @@ public:
 
     // Search and replace
     std::vector<int> find(const std::string& text, bool caseSensitive = true);
+    size_t findStreaming(const std::string& pattern, const TextSearch::Options& options,
+                         const TextSearch::BatchCallback& onBatch) const;
     int replaceAll(const std::string& find, const std::string& replace);
 
     // Editor state
@@ -106,6 +153,13 @@ public:
     int getCurrentLine() const;
     int getCurrentColumn() const;
 
+    // Syntax highlighting (tokens are produced lazily per line)
+    std::vector<SyntaxHighlighter::Token> getLineTokens(int line);
+
+    // Bracket matching and folding (brackets in strings and comments are ignored)
+    bool findMatchingBracket(int line, int col, int& matchLine, int& matchCol);
+    std::vector<BracketIndex::FoldRegion> getFoldRegions(int firstLine, int lastLine);
+
     // Code actions
     void format();
     void commentSelection();
@@ -115,23 +169,34 @@ public:
 
 private:
     std::string filePath;
-    std::string content;
+    TextBuffer buffer;
     EditorConfig config;
     bool modified;
     int currentLine;
     int currentColumn;
+    size_t selectionStart;
+    size_t selectionEnd;
+    SyntaxHighlighter highlighter;
+    BracketIndex brackets;
+    UndoHistory history;
+    std::function<void(const ChangeEvent&)> changeCallback;
+    unsigned long long revision;
+    std::shared_future<bool> pendingSave;
+    unsigned long long pendingSaveRevision;   // the revision pendingSave writes
+
+    // True once pendingSave has succeeded and nothing was edited since
+    bool pendingSaveCovers() const;
+    void replaceRange(size_t start, size_t end, std::string_view text);
+    void applyBatch(const std::vector<TextBuffer::Edit>& edits);
+    void applyHistoryChanges(const std::vector<UndoHistory::Change>& changes);
+    void notifyChange(size_t startLine, size_t oldEndLine, size_t newEndLine);
+    void moveCursor(size_t offset);
+    void resetHighlighting();
 };
 
 // Project Explorer
 class ProjectExplorer {
 public:
-    struct FileNode {
-        std::string name;
-        std::string path;
-        bool isDirectory;
-        std::vector<FileNode> children;
-    };
-
     ProjectExplorer();
     ~ProjectExplorer();
 
@@ -140,11 +205,35 @@ public:
     bool closeProject();
     std::string getCurrentProject() const;
 
-    // File tree operations
-    FileNode getFileTree() const;
-    std::vector<std::string> getFiles(const std::string& extension = "") const;
+    // File tree operations (the tree is valid until the project changes or
+    // applyFileChanges() patches it)
+    const FileTree& getFileTree() const;
+    // File metadata cache, saved under <project>/.hybridide; not to be
+    // used while prepareContentIndex() is indexing
+    ProjectIndex& getIndex();
+    // Files with a name ending in extension (all files if empty) below a
+    // project-relative directory; served from the tree's indexes
+    std::vector<std::string> getFiles(const std::string& extension = "", const std::string& directory = "") const;
     std::vector<std::string> getDirectories() const;
 
+    // Called on the watcher thread with every batch, ignored paths
+    // included (marked), before it is queued
+    using ChangeHandler = std::function<void(const std::vector<FileWatcher::Change>& changes)>;
+
+    // Watch the project for changes. Batches, less ignored paths, queue up
+    // until applyFileChanges().
+    bool startWatching(ChangeHandler onChanges = nullptr);
+    void stopWatching();
+    // Also watch a directory the project skips (an ignored one shown in the
+    // explorer); its changes reach onChanges marked ignored. Safe from any
+    // thread. Returns false if the project is not watched or the directory
+    // cannot be.
+    bool watchDirectory(const std::string& relativePath);
+
+    // Patch the tree with the queued changes on the calling thread. Returns
+    // the number of changes applied.
+    size_t applyFileChanges();
+
     // File operations
     bool createFile(const std::string& path);
     bool createDirectory(const std::string& path);
@@ -153,11 +242,48 @@ public:
 
     // Search
     std::vector<std::string> searchFiles(const std::string& pattern) const;
+    // Full-text search through the project's trigram index, which is
+    // brought up to date with the tree first
+    bool searchContent(const std::string& pattern, const TrigramIndex::Query& query,
+                       std::vector<TrigramIndex::Match>& matches, std::string* error = nullptr);
+    // Whether searchContent() can answer without indexing first. If not,
+    // the index is brought up to date on a background thread, and this
+    // turns true once that is done.
+    bool prepareContentIndex();
+    // Brute-force content search for when the index is not warm yet: the
+    // project is walked and searched in parallel, and matches stream to
+    // onBatch from the search threads. A new search cancels the running
+    // one. Returns the search id, or 0 for an empty or invalid pattern.
+    uint64_t streamContent(const std::string& pattern, const GrepEngine::Query& query,
+                           GrepEngine::BatchCallback onBatch, std::string* error = nullptr);
+    void cancelContentSearch();
+    // Quick open: the project's files best matching a fuzzy query, by
+    // project-relative path
+    std::vector<FuzzyFinder::Result> quickOpen(const std::string& query, size_t limit = 50);
 
 private:
     std::string projectPath;
-    FileNode rootNode;
+    FileTree tree;
+    ProjectIndex index;
+    TrigramIndex contentIndex;
+    bool contentIndexStale = true;   // files may differ from the content index
+    std::mutex indexMutex;           // index, while the indexer runs
+    std::thread indexer;             // prepareContentIndex()'s
+    std::atomic<bool> indexed{false};
+    std::atomic<bool> cancelIndexing{false};
+    GrepEngine grep;
+    FuzzyFinder finder;
+    bool finderStale = true;         // files may differ from the finder's list
+    std::mutex changesMutex;
+    std::vector<FileWatcher::Change> pendingChanges;
+    ChangeHandler onChanges;
+    std::unique_ptr<FileWatcher> watcher;   // last, so it stops before the rest is destroyed
+
     void buildFileTree();
+    void watchTree();
+    std::vector<TrigramIndex::Document> contentDocuments() const;
+    void syncContentIndex(std::vector<TrigramIndex::Document>& documents);
+    void stopIndexing();
 };
 
 // Integrated Terminal
@@ -203,6 +329,8 @@ public:
     std::string generateCode(const std::string& description, const std::string& language);
     std::string refactorCode(const std::string& code, const std::string& instructions);
     std::string explainCode(const std::string& code);
+    // Snapshot overloads: the text is only flattened on the calling (worker) thread
+    std::string explainCode(const TextBuffer& snapshot);
     std::string fixCode(const std::string& code, const std::string& error);
 
     // Code review
@@ -213,6 +341,7 @@ public:
         int score;
     };
     CodeReview reviewCode(const std::string& code);
+    CodeReview reviewCode(const TextBuffer& snapshot);
 
     // Configuration
     void setAPIKey(const std::string& key);
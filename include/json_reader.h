@@ -0,0 +1,153 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+class JsonDocument;
+
+/**
+ * JsonValue - One value of a JsonDocument, read on demand
+ *
+ * A value is a position in the document's structural index and copies
+ * nothing. Member lookup walks the object's members and jumps over nested
+ * containers whole; strings are unescaped only when asked for, and views
+ * into the text are handed out when they need no unescaping.
+ *
+ * Looking up what is not there (a missing member, an element past the end,
+ * a member of an array) gives a missing value, and the accessors of a value
+ * of another type return their fallback. A value is valid as long as its
+ * document and the document's text.
+ */
+class JsonValue {
+public:
+    enum class Type { MISSING, NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    class Iterator;
+
+    JsonValue() = default;
+
+    Type type() const;
+    bool exists() const { return document_ != nullptr; }
+    explicit operator bool() const { return exists(); }
+    bool isNull() const { return type() == Type::NULL_VALUE; }
+    bool isString() const { return type() == Type::STRING; }
+    bool isObject() const { return type() == Type::OBJECT; }
+    bool isArray() const { return type() == Type::ARRAY; }
+
+    // Member of an object
+    JsonValue operator[](std::string_view name) const;
+    // Element of an array
+    JsonValue at(size_t index) const;
+    // Elements of an array, or members of an object
+    size_t size() const;
+    // Walks the elements of an array, or the member values of an object
+    Iterator begin() const;
+    Iterator end() const;
+    // The name of the member this value is, or empty
+    std::string name() const;
+
+    // The value as it appears in the text
+    std::string_view raw() const;
+
+    // A string, unescaped; fallback for anything else
+    std::string string(std::string_view fallback = {}) const;
+    // A string without copying when it has no escapes; otherwise it is
+    // unescaped into scratch
+    std::string_view stringView(std::string& scratch) const;
+    bool boolean(bool fallback) const;
+    // Numbers; integers that do not fit (or have a fraction) give fallback
+    int64_t integer(int64_t fallback) const;
+    uint64_t unsignedInteger(uint64_t fallback) const;
+    double number(double fallback) const;
+
+private:
+    friend class JsonDocument;
+
+    const JsonDocument* document_ = nullptr;
+    uint32_t token_ = 0;   // index of the value's first token
+
+    JsonValue(const JsonDocument* document, uint32_t token) : document_(document), token_(token) {}
+
+    char first() const;
+    // The token after the value, containers included
+    uint32_t following() const;
+    // The text between a string's quotes, still escaped
+    std::string_view escaped() const;
+};
+
+class JsonValue::Iterator {
+public:
+    JsonValue operator*() const { return JsonValue(document_, token_); }
+    Iterator& operator++();
+    bool operator==(const Iterator& other) const { return token_ == other.token_; }
+    bool operator!=(const Iterator& other) const { return token_ != other.token_; }
+
+private:
+    friend class JsonValue;
+
+    const JsonDocument* document_ = nullptr;
+    uint32_t token_ = 0;   // the value's first token; 0 past the end
+
+    Iterator(const JsonDocument* document, uint32_t token) : document_(document), token_(token) {}
+};
+
+/**
+ * JsonDocument - Structural index over JSON text, for on-demand reading
+ *
+ * Construction makes the one pass over the text. It runs 64 bytes at a
+ * time with SIMD compares, as simdjson's first stage does: quotes not
+ * escaped by a run of backslashes open and close strings, and outside
+ * strings the brackets, colons, commas and the first byte of each scalar
+ * are recorded as tokens. Container tokens then learn where they close, so
+ * skipping a value is one lookup however large it is. Nothing else is read
+ * until a JsonValue asks, and a multi-megabyte string member costs only
+ * the scan.
+ *
+ * The text is not copied and must outlive the document. Malformed text
+ * (unbalanced brackets, an unterminated string) gives a document whose
+ * root is missing; the grammar between tokens is checked only as far as
+ * reading needs.
+ *
+ *   JsonDocument message(text);
+ *   JsonValue data = message.root()["data"];
+ *   std::string path = data["path"].string();
+ *   size_t firstLine = data["firstLine"].unsignedInteger(0);
+ */
+class JsonDocument {
+public:
+    explicit JsonDocument(std::string_view text);
+
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    bool valid() const { return valid_; }
+    JsonValue root() const { return valid_ ? JsonValue(this, 0) : JsonValue(); }
+    std::string_view text() const { return text_; }
+
+    // Undo the escapes of a string's contents, appending to out
+    static void unescape(std::string_view escaped, std::string& out);
+
+private:
+    friend class JsonValue;
+    friend class JsonValue::Iterator;
+
+    std::string_view text_;
+    std::vector<uint32_t> tokens_;   // offsets of the tokens, in text order
+    std::vector<uint32_t> closes_;   // for an opening bracket, the token of its close
+    bool valid_ = false;
+
+    void index();
+    bool matchBrackets();
+
+    char at(uint32_t token) const { return text_[tokens_[token]]; }
+};
+
+} // namespace HybridIDE
+
+#endif // JSON_READER_H
@@ -0,0 +1,100 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * JsonWriter - Append-only JSON serializer over one growable buffer
+ *
+ * Values are written straight into the buffer as they come; commas are
+ * placed automatically. Strings are escaped 16 or 32 bytes at a time: runs
+ * that need no escaping are found with SIMD compares and copied whole, so
+ * file contents and long paths cost little more than a memcpy. Numbers are
+ * formatted with std::to_chars, without locales or temporaries.
+ *
+ * The writer does not check the document's shape: keys belong inside
+ * objects, and every begin needs its end.
+ *
+ *   JsonWriter json;
+ *   json.beginObject().member("success", true).member("path", path).endObject();
+ *   sendToFrontend("fileSaved", json.str());
+ */
+class JsonWriter {
+public:
+    JsonWriter() = default;
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    // The name of the next object member
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& null();
+
+    // bool, integers and floating point; non-finite numbers become null
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    JsonWriter& value(T number) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return boolean(number);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return floating(static_cast<double>(number));
+        } else if constexpr (std::is_signed_v<T>) {
+            return integer(static_cast<int64_t>(number));
+        } else {
+            return unsignedInteger(static_cast<uint64_t>(number));
+        }
+    }
+
+    template <typename T>
+    JsonWriter& member(std::string_view name, const T& memberValue) {
+        return key(name).value(memberValue);
+    }
+
+    // A string value written in pieces, e.g. the chunks of a TextBuffer
+    JsonWriter& beginString();
+    JsonWriter& stringPart(std::string_view text);
+    JsonWriter& endString();
+
+    // An already serialized value, copied as is
+    JsonWriter& raw(std::string_view json);
+
+    void reserve(size_t bytes) { out_.reserve(bytes); }
+    void clear();
+    size_t size() const { return out_.size(); }
+    const std::string& str() const { return out_; }
+    // The document, leaving the writer empty
+    std::string take();
+
+    // Append text, escaped but without quotes, to out
+    static void appendEscaped(std::string& out, std::string_view text);
+    // Append text to out as a JSON string literal
+    static void appendString(std::string& out, std::string_view text);
+
+private:
+    std::string out_;
+    bool comma_ = false;   // a value precedes: the next one needs a comma
+
+    void separate() {
+        if (comma_) out_ += ',';
+    }
+
+    JsonWriter& boolean(bool flag);
+    JsonWriter& integer(int64_t number);
+    JsonWriter& unsignedInteger(uint64_t number);
+    JsonWriter& floating(double number);
+};
+
+} // namespace HybridIDE
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,55 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstddef>
+
+namespace HybridIDE {
+
+/**
+ * MappedFile - Read-only, copy-on-write memory mapping of a whole file
+ *
+ * Pages are faulted in lazily as they are touched, so mapping a multi-GB
+ * file costs the same as mapping a small one. Instances are shared through
+ * shared_ptr; the mapping is released when the last reference goes away.
+ */
+class MappedFile {
+public:
+    enum class Access {
+        NORMAL,
+        SEQUENTIAL,   // one forward pass (aggressive read-ahead)
+        RANDOM        // scattered access (no read-ahead)
+    };
+
+    // Map the file at path; returns nullptr on failure
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+    // Access pattern hint for the kernel's read-ahead
+    void advise(Access access) const;
+
+    // Drop resident pages after a full scan; they fault back in on next access
+    void release() const;
+
+private:
+    MappedFile() = default;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace HybridIDE
+
+#endif // MAPPED_FILE_H
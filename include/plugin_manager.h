@@ -57,6 +57,7 @@ private:
     bool validatePluginManifest(const PluginManifest& manifest);
     bool checkDependencies(const Plugin& plugin);
     PluginManifest parseManifest(const std::string& manifestPath);
+    PluginManifest parseManifestText(const std::string& text);
     bool executePluginEntry(Plugin& plugin);
 };
 
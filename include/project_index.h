@@ -0,0 +1,123 @@
+#ifndef PROJECT_INDEX_H
+#define PROJECT_INDEX_H
+
+#include "file_walker.h"
+#include "file_watcher.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * ProjectIndex - Persistent cache of a project's listings and file metadata
+ *
+ * Keeps the raw listing of every walked directory together with its mtime,
+ * and the mtime, size and content hash of every visible file, in
+ * <project>/.hybridide/index. The file is a flat, little-endian image (a
+ * header, a directory table sorted by path, an entry table and a string
+ * pool) that is mapped and searched in place, never parsed.
+ *
+ * open() walks the project like FileWalker::collect, but a directory whose
+ * mtime still matches the index is not read: its cached listing is handed
+ * to the walker, and its files keep their cached metadata without a stat.
+ * Only changed directories are listed, and only their new or changed files
+ * are hashed. Ignore files are re-read and re-applied on every walk, so
+ * editing a .gitignore never leaves a stale tree.
+ *
+ * A file rewritten in place leaves its directory's mtime alone, so cached
+ * metadata is confirmed with a stat when it is asked for (fileInfo()).
+ * Timestamps that are too recent to be trusted (the directory or file may
+ * change again within the same tick) are written out as unknown.
+ */
+class ProjectIndex {
+public:
+    struct FileInfo {
+        int64_t modified = 0;    // nanoseconds since the Unix epoch
+        uint64_t size = 0;
+        uint64_t hash = 0;       // hashContent() of the file's bytes
+    };
+
+    struct Options {
+        FileWalker::Options walk;
+        bool hashContents = true;   // hash files as they are indexed, not on first fileInfo()
+    };
+
+    struct Stats {
+        bool loaded = false;       // an index file was found and usable
+        size_t directories = 0;    // walked
+        size_t reused = 0;         // listings taken from the index
+        size_t listed = 0;         // listings read from disk
+        size_t hashed = 0;         // files read and hashed
+    };
+
+    static constexpr const char* kDirectory = ".hybridide";
+    static constexpr const char* kFileName = "index";
+
+    ProjectIndex();
+    ~ProjectIndex();
+
+    ProjectIndex(const ProjectIndex&) = delete;
+    ProjectIndex& operator=(const ProjectIndex&) = delete;
+
+    // Walk root, revalidating against its saved index; returns what
+    // FileWalker::collect would. Any previously open project is closed.
+    std::vector<FileWalker::Directory> open(const std::string& root, const Options& options);
+
+    // Write the index if anything changed since it was loaded or saved
+    bool save();
+
+    // Save and forget the project
+    void close();
+
+    const Stats& stats() const { return stats_; }
+
+    // Metadata of a visible file (relative path), confirmed with a stat and
+    // re-hashed if the file changed since it was recorded. Not thread-safe.
+    bool fileInfo(const std::string& relativePath, FileInfo& info);
+
+    // Metadata as last recorded, without a stat; false if unknown
+    bool recordedInfo(const std::string& relativePath, FileInfo& info) const;
+
+    // Follow a FileWatcher batch; affected directories are listed again on
+    // the next open(), as the watcher does not report ignored entries
+    void applyChanges(const std::vector<FileWatcher::Change>& changes);
+
+    // 64-bit content hash used for FileInfo::hash
+    static uint64_t hashContent(std::string_view data);
+
+    // <root>/.hybridide, created (and kept out of version control) if
+    // needed; "" if it cannot be created
+    static std::string indexDirectory(const std::string& root);
+
+private:
+    struct Entry {
+        std::string name;
+        bool isDirectory = false;
+        bool hasInfo = false;
+        FileInfo info;
+    };
+
+    struct Listing {
+        int64_t modified = 0;   // directory mtime, kUnknown if it must be listed again
+        bool reused = false;    // taken from the index during open()
+        std::vector<Entry> entries;   // by name
+    };
+
+    std::string root_;
+    Options options_;
+    Stats stats_;
+    bool dirty_;
+    std::map<std::string, Listing> listings_;   // by relative directory path
+
+    std::string indexPath() const;
+    const Entry* findEntry(const std::string& relativePath) const;
+    bool refresh(const std::string& relativePath, Entry& entry);
+};
+
+} // namespace HybridIDE
+
+#endif // PROJECT_INDEX_H
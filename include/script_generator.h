@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include "file_operations.h"
 
 /**
  * ScriptGenerator - Multi-platform script generation with automatic code signing
@@ -121,6 +122,7 @@ private:
     std::string getCurrentTimestamp() const;
     std::string sanitizeFilename(const std::string& name) const;
     bool createDirectoryRecursive(const std::string& path);
+    static FileOperations::WriteOptions scriptWriteOptions(const GeneratedScript& script);
 
     // Script components
     std::string generateHeader(const ScriptRequest& request, Platform platform);
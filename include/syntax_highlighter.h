@@ -0,0 +1,87 @@
+#ifndef SYNTAX_HIGHLIGHTER_H
+#define SYNTAX_HIGHLIGHTER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "text_buffer.h"
+
+namespace HybridIDE {
+
+/**
+ * SyntaxHighlighter - Incremental, table-driven tokenizer
+ *
+ * Caches the lexer state at the end of every line. After an edit only the
+ * damaged lines are re-lexed, and re-lexing stops at the first line past the
+ * edit whose end state matches the cached one. States are computed lazily,
+ * so opening a large file only lexes up to the lines actually displayed.
+ */
+class SyntaxHighlighter {
+public:
+    enum class TokenType : uint8_t {
+        TEXT,
+        KEYWORD,
+        IDENTIFIER,
+        NUMBER,
+        STRING,
+        COMMENT,
+        PREPROCESSOR,
+        OPERATOR,
+        PUNCTUATION,
+        VARIABLE
+    };
+
+    struct Token {
+        uint32_t start;   // byte column within the line
+        uint32_t length;
+        TokenType type;
+    };
+
+    struct LanguageSpec;
+
+    explicit SyntaxHighlighter(const std::string& language = "plaintext");
+
+    void setLanguage(const std::string& language);
+    std::string getLanguage() const;
+    bool isEnabled() const { return spec_ != nullptr; }
+
+    // Invalidate everything (file loaded or replaced wholesale)
+    void reset(size_t lineCount);
+
+    // Lines [startLine, oldEndLine] were replaced by [startLine, newEndLine]
+    void applyEdit(size_t startLine, size_t oldEndLine, size_t newEndLine);
+
+    // Tokens for one line, lexing any stale lines before it first
+    std::vector<Token> tokenizeLine(const TextBuffer& buffer, size_t line);
+
+    // Lexer state at the end of a line (0 = not inside a multi-line construct)
+    uint8_t getLineEndState(const TextBuffer& buffer, size_t line);
+
+    // Tokenize one line of text that starts in the given lexer state.
+    // Uses no cached state; returns the state at the end of the line.
+    uint8_t tokenize(std::string_view text, uint8_t state, std::vector<Token>& tokens) const;
+
+    // Number of lines lexed by the most recent cache update
+    size_t getLastRelexCount() const { return lastRelexCount_; }
+
+    static const char* tokenTypeName(TokenType type);
+
+    // Highlighter language for a file name, by extension ("plaintext" if unknown)
+    static std::string languageForPath(const std::string& path);
+
+private:
+    const LanguageSpec* spec_;
+    std::vector<uint8_t> endStates_;
+    size_t firstDirty_;   // first line whose cached state may be stale
+    size_t dirtyUntil_;   // lines up to here must be re-lexed unconditionally
+    size_t lastRelexCount_;
+
+    void ensureStates(const TextBuffer& buffer, size_t line);
+    uint8_t lexLine(std::string_view text, uint8_t state, std::vector<Token>* tokens) const;
+};
+
+} // namespace HybridIDE
+
+#endif // SYNTAX_HIGHLIGHTER_H
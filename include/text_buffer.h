@@ -0,0 +1,190 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "mapped_file.h"
+
+namespace HybridIDE {
+
+/**
+ * TextBuffer - Piece table document storage for the editor
+ *
+ * The document is a sequence of pieces, each referencing a span of either the
+ * original (loaded) text or the append-only add buffer. Pieces are kept in a
+ * treap ordered by document position and augmented with subtree byte counts,
+ * so insert and erase at any offset are O(log n) and never move document text.
+ */
+class TextBuffer {
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+public:
+    // Forward iterator over the document as contiguous string_view chunks
+    class ChunkIterator {
+    public:
+        ChunkIterator() = default;
+
+        std::string_view operator*() const { return current_; }
+        ChunkIterator& operator++();
+        bool operator==(const ChunkIterator& other) const { return done() == other.done(); }
+        bool operator!=(const ChunkIterator& other) const { return !(*this == other); }
+
+    private:
+        friend class TextBuffer;
+
+        bool done() const { return current_.data() == nullptr; }
+        void advance();
+
+        const TextBuffer* buffer_ = nullptr;
+        std::vector<const Node*> stack_;
+        std::string_view current_;
+        size_t skip_ = 0;       // bytes to drop from the first chunk
+        size_t remaining_ = 0;  // bytes left in the requested range
+    };
+
+    // Lazy, non-owning view of a byte range; only str() copies text
+    class View {
+    public:
+        View(const TextBuffer& buffer, size_t offset, size_t length)
+            : buffer_(&buffer), offset_(offset), length_(length) {}
+
+        size_t size() const { return length_; }
+        bool empty() const { return length_ == 0; }
+        ChunkIterator begin() const { return buffer_->chunks(offset_, length_); }
+        ChunkIterator end() const { return ChunkIterator(); }
+        std::string str() const { return buffer_->substr(offset_, length_); }
+
+    private:
+        const TextBuffer* buffer_;
+        size_t offset_;
+        size_t length_;
+    };
+
+    // Replace length bytes at offset with text
+    struct Edit {
+        size_t offset;
+        size_t length;
+        std::string_view text;
+    };
+
+    TextBuffer();
+    explicit TextBuffer(std::string text);
+
+    // Copies are O(1) snapshots (see above)
+    TextBuffer(const TextBuffer& other);
+    TextBuffer& operator=(const TextBuffer& other);
+    TextBuffer(TextBuffer&&) = default;
+    TextBuffer& operator=(TextBuffer&&) = default;
+    TextBuffer snapshot() const { return *this; }
+
+    // Replace the whole document; the text becomes the original buffer
+    void setText(std::string text);
+
+    // Replace the whole document with a mapped file as the original buffer.
+    // The file is never copied; only the line feed scan reads it up front.
+    void setText(std::shared_ptr<const MappedFile> file);
+    bool isFileBacked() const { return mappedFile_ != nullptr; }
+
+    // Editing by byte offset
+    void insert(size_t offset, std::string_view text);
+    void erase(size_t offset, size_t count);
+
+    // Apply a batch of edits, sorted by offset and non-overlapping, all given
+    // against the current text. The piece tree is rebuilt in a single pass
+    // over the existing pieces, so k edits cost O(pieces + k) rather than
+    // k separate tree updates. Returns false (and changes nothing) if the
+    // edits are unsorted, overlap, or run past the end.
+    bool applyEdits(const std::vector<Edit>& edits);
+
+    // Reading
+    size_t length() const;
+    bool empty() const { return length() == 0; }
+    char charAt(size_t offset) const;
+    std::string substr(size_t offset, size_t count) const;
+    std::string toString() const { return substr(0, length()); }
+    View view() const { return View(*this, 0, length()); }
+    View view(size_t offset, size_t count) const;
+    ChunkIterator chunks(size_t offset, size_t count) const;
+
+    // Line/column addressing (0-based, columns in bytes, clamped to the line).
+    // Backed by per-piece line feed counts, so every lookup is O(log n).
+    size_t offsetAt(int line, int column) const;
+    void positionAt(size_t offset, int& line, int& column) const;
+    size_t lineCount() const;
+    size_t lineStart(size_t line) const;
+    size_t lineEnd(size_t line) const;
+    std::string getLine(size_t line) const;
+    size_t pieceCount() const;
+
+    // Bulk newline scanning (SSE2/AVX2 when available)
+    static size_t countLineFeeds(const char* data, size_t length);
+    static void findLineFeeds(const char* data, size_t length, size_t base,
+                              std::vector<size_t>& positions);
+
+private:
+    // Text referenced by pieces. Block 0 holds the original (loaded) text and
+    // the rest form the append-only add buffer. Only the buffer that owns the
+    // tail block appends to it, and ownership is given up as soon as the
+    // buffer is copied, so shared blocks are never written again.
+    struct Block {
+        std::string text;                    // add blocks: capacity reserved up front
+        std::shared_ptr<const void> owner;   // original block: keeps data alive
+        const char* data = nullptr;
+        size_t size = 0;
+        std::vector<size_t> lineFeeds;       // sorted '\n' positions in the block
+    };
+    using BlockList = std::vector<std::shared_ptr<Block>>;
+
+    struct Piece {
+        uint32_t block;
+        size_t start;
+        size_t length;
+        size_t lineFeeds;
+    };
+
+    struct Node {
+        Piece piece;
+        uint32_t priority;
+        size_t subtreeLength;
+        size_t subtreeLineFeeds;
+        size_t subtreeCount;
+        NodePtr left;
+        NodePtr right;
+    };
+
+    std::shared_ptr<BlockList> blocks_;      // shared copy-on-write between snapshots
+    std::shared_ptr<const MappedFile> mappedFile_;
+    NodePtr root_;
+    uint32_t seed_;
+    mutable bool ownsTail_;                  // may append to the last block in place
+
+    static NodePtr makeNode(const Piece& piece, uint32_t priority, NodePtr left, NodePtr right);
+    NodePtr makeLeaf(const Piece& piece);
+    void resetOriginal(std::shared_ptr<const void> owner, std::string_view text,
+                       std::vector<size_t> lineFeeds);
+    Piece appendText(std::string_view text);
+    uint32_t nextPriority();
+    const Block& blockOf(const Piece& piece) const { return *(*blocks_)[piece.block]; }
+    const char* pieceData(const Piece& piece) const { return blockOf(piece).data + piece.start; }
+    Piece makePiece(uint32_t block, size_t start, size_t length) const;
+    size_t nthLineFeed(size_t n) const;
+
+    static size_t lengthOf(const NodePtr& node);
+    static size_t lineFeedsOf(const NodePtr& node);
+    static size_t countOf(const NodePtr& node);
+    void split(const NodePtr& node, size_t offset, NodePtr& left, NodePtr& right) const;
+    static NodePtr merge(const NodePtr& left, const NodePtr& right);
+    NodePtr buildTree(const std::vector<Piece>& pieces);
+    static NodePtr extendRightmost(const NodePtr& node, size_t extra, size_t extraLineFeeds);
+    static bool endsRightBefore(const NodePtr& node, const Piece& piece);
+};
+
+} // namespace HybridIDE
+
+#endif // TEXT_BUFFER_H
@@ -0,0 +1,141 @@
+#ifndef TEXT_SEARCH_H
+#define TEXT_SEARCH_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include "text_buffer.h"
+
+namespace HybridIDE {
+
+// Literal substring finder: SIMD first/last byte filter, then a full compare
+class LiteralSearcher {
+public:
+    LiteralSearcher(std::string_view needle, bool caseSensitive = true);
+
+    // Offset of the first match at or after `from`, or npos
+    size_t find(const char* data, size_t length, size_t from = 0) const;
+    bool matchesAt(const char* data) const;
+    size_t size() const { return needle_.size(); }
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    std::string needle_;  // lower-cased when !caseSensitive_
+    bool caseSensitive_;
+};
+
+// Regular expression matcher compiled to a lazily built DFA.
+// Supports . [] [^] \d \w \s (and negations) * + ? | () ^ $; matches are
+// leftmost-longest and never cross a line break. A line is searched in
+// linear time: one backwards pass over it with the reversed pattern marks
+// where matches start, then each match is run forwards for its end.
+class RegexSearcher {
+public:
+    RegexSearcher(const std::string& pattern, bool caseSensitive = true);
+
+    bool isValid() const { return valid_; }
+    const std::string& getError() const { return error_; }
+
+    // Calls onMatch(start, end) for the matches in `line`, left to right
+    // and not overlapping; after an empty match the search moves on a byte.
+    // Return false from onMatch to stop.
+    using MatchCallback = std::function<bool(size_t start, size_t end)>;
+    void findAll(std::string_view line, const MatchCallback& onMatch);
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    struct ByteSet {
+        uint64_t bits[4] = {0, 0, 0, 0};
+        void set(unsigned char c) { bits[c >> 6] |= uint64_t(1) << (c & 63); }
+        bool test(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+        void invert() { for (auto& b : bits) b = ~b; }
+    };
+
+    enum class NfaType { BYTES, SPLIT, LINE_START, LINE_END, MATCH };
+
+    struct NfaState {
+        NfaType type;
+        ByteSet bytes;
+        int out = -1;
+        int out1 = -1;
+    };
+
+    struct DfaState {
+        std::vector<int> nfaStates;
+        bool accepting = false;
+        bool acceptingAtLineEnd = false;
+        int next[256];
+    };
+
+    struct Fragment {
+        int start;
+        std::vector<std::pair<int, int>> outs;  // (state, 0 = out / 1 = out1)
+    };
+
+    // An NFA and the DFA built from it as bytes are stepped through
+    struct Automaton {
+        std::vector<NfaState> nfa;
+        std::vector<DfaState> dfa;
+        std::map<std::vector<int>, int> dfaIndex;
+        int startState[2] = {-1, -1};  // [0] mid-line, [1] at line start
+
+        void start(int nfaStart);
+        void closure(std::vector<int>& states, bool atLineStart, bool atLineEnd) const;
+        int dfaStateFor(std::vector<int> states);
+        int step(int state, unsigned char c);
+    };
+
+    Automaton forward_;
+    Automaton reverse_;          // the pattern backwards, free to end anywhere
+    std::vector<char> starts_;   // per line position, whether a match starts there
+    bool caseSensitive_;
+    bool valid_;
+    std::string error_;
+
+    // Parser
+    const std::string* pattern_ = nullptr;
+    size_t pos_ = 0;
+    bool parseAlternation(Fragment& result);
+    bool parseConcatenation(Fragment& result);
+    bool parseRepetition(Fragment& result);
+    bool parseAtom(Fragment& result);
+    bool parseClass(ByteSet& set);
+    bool parseEscape(ByteSet& set);
+    int addState(NfaType type, int out = -1, int out1 = -1);
+    void patch(const Fragment& fragment, int target);
+
+    void buildReverse(int nfaStart);
+    // The longest match starting at `start`, or npos
+    size_t longestMatch(std::string_view line, size_t start);
+};
+
+class TextSearch {
+public:
+    struct Options {
+        bool caseSensitive = true;
+        bool regex = false;
+        size_t batchSize = 1024;  // matches delivered per callback
+    };
+
+    struct Match {
+        size_t offset;
+        size_t length;
+    };
+
+    // Return false from the callback to cancel the scan
+    using BatchCallback = std::function<bool(const std::vector<Match>& batch)>;
+
+    // Stream all non-overlapping matches in document order; returns the total
+    static size_t findAll(const TextBuffer& buffer, const std::string& pattern,
+                          const Options& options, const BatchCallback& onBatch);
+};
+
+} // namespace HybridIDE
+
+#endif // TEXT_SEARCH_H
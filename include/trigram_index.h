@@ -0,0 +1,150 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include "file_watcher.h"
+#include "content_search.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+class WorkStealingPool;
+
+/**
+ * TrigramIndex - Persistent full-text index over a project's files
+ *
+ * Every file is reduced to the set of trigrams (three-byte sequences) it
+ * contains, and each trigram maps to a posting list of the files holding
+ * it. A query is turned into the trigrams any match must contain, the
+ * posting lists are intersected, and only the surviving candidates are
+ * read and searched. Trigrams are folded to lower case, and bytes >= 0x80
+ * share one symbol, so one index serves case-sensitive and -insensitive
+ * queries; verification against the file contents makes the final call.
+ *
+ * The index lives in <project>/.hybridide/trigrams: a document table, the
+ * delta/varint-coded posting lists and a trigram table sorted by key, all
+ * used in place from a mapping. Changes go to an in-memory delta (removed
+ * documents are masked out of the mapped lists, re-indexed ones are
+ * appended), which save() merges into a new file. Thread-safe.
+ */
+class TrigramIndex {
+public:
+    struct Options {
+        size_t threads = 0;                          // 0 = one per hardware thread
+        uint64_t maxFileSize = 64 * 1024 * 1024;     // larger files are searched, not indexed
+    };
+
+    // A file to index, relative to the root. A document whose hash matches
+    // the one it was indexed with is not read again.
+    struct Document {
+        std::string path;
+        uint64_t hash = 0;   // ProjectIndex::hashContent of the file
+        bool hasHash = false;
+    };
+
+    using Query = ContentSearcher::Query;
+    using Match = ContentSearcher::Match;
+
+    struct Stats {
+        size_t documents = 0;     // live documents
+        size_t trigrams = 0;      // distinct trigrams in the saved index
+        size_t candidates = 0;    // files verified by the last search
+    };
+
+    static constexpr const char* kFileName = "trigrams";
+
+    TrigramIndex();
+    ~TrigramIndex();
+
+    TrigramIndex(const TrigramIndex&) = delete;
+    TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+    // Use the saved index of root, if there is a valid one. Returns whether
+    // one was loaded; either way the index is ready for update().
+    bool open(const std::string& root, const Options& options);
+
+    // Make the index cover exactly these files: new and changed ones are
+    // read and indexed in parallel, missing ones dropped. Returns the
+    // number of files indexed.
+    size_t update(const std::vector<Document>& documents);
+
+    // Queue the files of a FileWatcher batch; they are re-indexed before
+    // the next search
+    void applyChanges(const std::vector<FileWatcher::Change>& changes);
+
+    // Find every match of a literal or regular expression (RegexSearcher
+    // syntax) in indexed files. Returns false with error set if the
+    // pattern is invalid.
+    bool search(const std::string& pattern, const Query& query, std::vector<Match>& matches,
+                std::string* error = nullptr);
+
+    // Merge pending changes into a new index file
+    bool save();
+
+    // Save and forget the project
+    void close();
+
+    Stats stats() const;
+
+    // Implementation types, defined in trigram_index.cpp
+    struct TrigramQuery;
+    struct Extracted;
+
+private:
+    struct Base;
+    struct DeltaPosting {
+        uint32_t key;
+        uint32_t count;
+        uint32_t last;
+        std::string bytes;
+    };
+    struct DocumentState {
+        uint64_t hash;
+        uint32_t flags;
+    };
+
+    mutable std::mutex mutex_;
+    std::string root_;
+    Options options_;
+    std::unique_ptr<WorkStealingPool> pool_;
+    std::unique_ptr<Base> base_;
+
+    // Every document id ever assigned since the last save: the base's, then
+    // the delta's. Removed documents stay, flagged dead.
+    std::vector<DocumentState> documents_;
+    std::vector<std::string> deltaPaths_;
+    std::unordered_map<std::string, uint32_t> ids_;   // live documents by path; built on demand
+    bool idsBuilt_;
+
+    std::vector<uint32_t> deltaSlots_;   // trigram key -> deltaPostings_ index + 1
+    std::vector<DeltaPosting> deltaPostings_;
+
+    std::set<std::string> pending_;   // queued by applyChanges()
+    size_t liveDocuments_;
+    size_t lastCandidates_;
+    bool dirty_;
+
+    bool saveLocked();
+    void closeLocked();
+    std::string pathOf(uint32_t id) const;
+    void buildIds();
+    void remove(uint32_t id);
+    size_t indexFiles(const std::vector<std::string>& paths);
+    void append(Extracted& extracted);
+    void flushPending();
+    std::vector<uint32_t> postings(uint32_t key) const;
+    size_t postingCount(uint32_t key) const;
+    std::vector<uint32_t> evaluate(const TrigramQuery& query) const;
+    WorkStealingPool& pool();
+};
+
+} // namespace HybridIDE
+
+#endif // TRIGRAM_INDEX_H
@@ -0,0 +1,109 @@
+#ifndef UNDO_HISTORY_H
+#define UNDO_HISTORY_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace HybridIDE {
+
+/**
+ * UndoHistory - Delta-based undo/redo log with a memory cap
+ *
+ * Each entry records one edit as (offset, removed bytes, inserted bytes).
+ * The bytes live back to back in a single arena string, so the log grows
+ * with the size of the edits rather than the size of the document.
+ * Consecutive typing and deleting coalesce into one entry, and the oldest
+ * entries are dropped once the configured memory limit is exceeded.
+ */
+class UndoHistory {
+public:
+    // An edit to apply to the buffer: erase eraseLength bytes at offset,
+    // then insert insertText there. insertText points into the arena and
+    // stays valid until the next call to record().
+    struct Change {
+        size_t offset;
+        size_t eraseLength;
+        std::string_view insertText;
+    };
+
+    // One part of a batch: `removed` replaced by `inserted` at offset
+    struct Edit {
+        size_t offset;
+        std::string_view removed;
+        std::string_view inserted;
+    };
+
+    explicit UndoHistory(size_t memoryLimit = 64 * 1024 * 1024);
+
+    // Record that `removed` was replaced by `inserted` at offset
+    void record(size_t offset, std::string_view removed, std::string_view inserted);
+
+    // Record a batch of edits as a single undo step. Edits are sorted and
+    // non-overlapping, with offsets in the text before the batch.
+    void recordBatch(const std::vector<Edit>& edits);
+
+    // Stop the next edit from merging into the current entry
+    void breakCoalescing();
+
+    bool canUndo() const { return current_ > 0; }
+    bool canRedo() const { return current_ < entries_.size(); }
+    // The changes to apply for one step, sorted and non-overlapping, with
+    // offsets in the current text (apply them as one batch)
+    bool undo(std::vector<Change>& changes);
+    bool redo(std::vector<Change>& changes);
+    void clear();
+
+    void setMemoryLimit(size_t bytes);
+    size_t getMemoryLimit() const { return memoryLimit_; }
+    size_t getMemoryUsage() const;
+    size_t getEntryCount() const { return entries_.size(); }
+
+    void setCoalesceWindow(std::chrono::milliseconds window) { coalesceWindow_ = window; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        size_t offset;
+        uint64_t arenaStart;     // logical arena position of removed bytes
+        size_t removedLength;    // inserted bytes follow the removed bytes
+        size_t insertedLength;
+        Clock::time_point lastEdit;
+        uint64_t firstPart;      // logical index into parts_ (batches only)
+        size_t partCount;        // 0 for a single edit
+    };
+
+    // A batch entry's bytes are [removed][inserted] per part, back to back
+    struct Part {
+        size_t offset;
+        size_t removedLength;
+        size_t insertedLength;
+    };
+
+    std::deque<Entry> entries_;
+    std::deque<Part> parts_;
+    uint64_t partsBase_;         // logical index of parts_[0]
+    size_t current_;             // entries_[0, current_) are undoable
+    std::string arena_;
+    uint64_t arenaBase_;         // logical position of arena_[0]
+    size_t memoryLimit_;
+    std::chrono::milliseconds coalesceWindow_;
+    bool coalesceBlocked_;
+
+    std::string_view removedText(const Entry& entry) const;
+    std::string_view insertedText(const Entry& entry) const;
+    void collectChanges(const Entry& entry, bool forUndo, std::vector<Change>& changes) const;
+    bool tryCoalesce(size_t offset, std::string_view removed, std::string_view inserted,
+                     Clock::time_point now);
+    void truncateRedo();
+    void enforceLimit();
+};
+
+} // namespace HybridIDE
+
+#endif // UNDO_HISTORY_H
@@ -5,12 +5,16 @@
 #include <windows.h>
 #endif
 
+#include "json_reader.h"
 #include <string>
 #include <functional>
 #include <map>
 
 class WebViewHost {
 public:
+    // Gets the message's "data" member, valid for the duration of the call
+    using MessageHandler = std::function<void(const HybridIDE::JsonValue&)>;
+
     WebViewHost();
     ~WebViewHost();
     
@@ -21,8 +25,9 @@ public:
 #endif
     void navigate(const std::wstring& url);
     void postMessage(const std::string& message);
-    void registerMessageHandler(const std::string& messageType,
-                                std::function<void(const std::string&)> handler);
+    void registerMessageHandler(const std::string& messageType, MessageHandler handler);
+    // Parse a {"type", "data"} message from the frontend and run its handler
+    void dispatchMessage(const std::string& message);
     void executeScript(const std::wstring& script);
     
     void* getWebView() { return webView; }
@@ -33,11 +38,9 @@ private:
     void* webViewController;
     void* webView;
     
-    std::map<std::string, std::function<void(const std::string&)>> messageHandlers;
+    std::map<std::string, MessageHandler, std::less<>> messageHandlers;
     
     void setupMessageHandler();
-    std::string parseMessageType(const std::string& message);
-    std::string parseMessageData(const std::string& message);
 };
 
 #endif // WEBVIEW_HOST_H
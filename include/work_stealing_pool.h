@@ -0,0 +1,75 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <cstddef>
+
+namespace HybridIDE {
+
+/**
+ * WorkStealingPool - Fork/join thread pool for recursive, uneven workloads
+ *
+ * Every worker owns a deque. Tasks submitted from inside a task go to the
+ * submitting worker's deque and are popped LIFO (depth-first, cache-warm);
+ * idle workers steal FIFO from the other end of someone else's deque, which
+ * hands them the largest pending pieces of work. Suited to directory walks
+ * and other task trees whose shape is only known while running.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses one worker per hardware thread
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queue a task. Safe to call from any thread, including from a task.
+    void submit(Task task);
+
+    // Run tasks on the calling thread too until every submitted task, and
+    // everything those spawned, has finished. Rethrows the first exception
+    // a task threw.
+    void wait();
+
+    size_t threadCount() const { return workers_.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;   // one per worker, plus one for waiting threads
+    std::atomic<size_t> queued_;    // tasks sitting in a queue
+    std::atomic<size_t> pending_;   // tasks queued or running
+    std::atomic<size_t> sleepers_;
+    std::atomic<bool> stop_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+
+    void workerLoop(size_t index);
+    bool runOne(size_t index);
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t index, Task& task);
+};
+
+} // namespace HybridIDE
+
+#endif // WORK_STEALING_POOL_H
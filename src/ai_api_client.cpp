@@ -78,18 +78,18 @@ std::string AIAPIClient::escapeJson(const std::string& str) {
     std::ostringstream escaped;
     for (char c : str) {
         switch (c) {
-            case '\"': escaped << "\\\""; break;
-            case '\\\\': escaped << "\\\\\\\\"; break;
-            case '\b': escaped << "\\\\b"; break;
-            case '\f': escaped << "\\\\f"; break;
-            case '\n': escaped << "\\\\n"; break;
-            case '\r': escaped << "\\\\r"; break;
-            case '\t': escaped << "\\\\t"; break;
+            case '"': escaped << "\\\""; break;
+            case '\\': escaped << "\\\\"; break;
+            case '\b': escaped << "\\b"; break;
+            case '\f': escaped << "\\f"; break;
+            case '\n': escaped << "\\n"; break;
+            case '\r': escaped << "\\r"; break;
+            case '\t': escaped << "\\t"; break;
             default:
                 if (c >= 32 && c <= 126) {
                     escaped << c;
                 } else {
-                    escaped << "\\\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c;
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c;
                 }
         }
     }
@@ -281,6 +281,7 @@ void AIAPIClient::streamComplete(
     std::function<void(const CompletionResponse& response)> onComplete
 ) {
     // Placeholder for streaming implementation
+    (void)onChunk;
     std::cout << "Streaming not yet implemented" << std::endl;
     CompletionResponse response = complete(request);
     onComplete(response);
@@ -335,5 +336,9 @@ std::string AIAPIClient::makeHTTPRequest(
     const std::string& body
 ) {
     // Placeholder for HTTP request implementation using libcurl
+    (void)url;
+    (void)method;
+    (void)headers;
+    (void)body;
     return "HTTP response placeholder";
 }
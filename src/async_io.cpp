@@ -0,0 +1,790 @@
+#include "async_io.h"
+#include "work_stealing_pool.h"
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr size_t kStatChunk = 64;          // paths per pool task in a fallback stat batch
+constexpr size_t kReadChunk = 64 * 1024;   // first read of a file that reports no size
+constexpr size_t kMaxReadStep = 1u << 30;  // bytes per read request
+
+// ============================================================================
+// Blocking versions, for the thread-pool backend
+// ============================================================================
+
+AsyncIO::Stat statPath(const std::string& path) {
+    AsyncIO::Stat result;
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path.c_str(), &st) != 0) {
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+#endif
+        result.error = errno;
+        return result;
+    }
+    result.isDirectory = (st.st_mode & S_IFMT) == S_IFDIR;
+    result.size = static_cast<uint64_t>(st.st_size);
+    result.modified = static_cast<int64_t>(st.st_mtime);
+    return result;
+}
+
+AsyncIO::Read readPath(const std::string& path) {
+    AsyncIO::Read result;
+    errno = 0;
+    if (!FileOperations::readFile(path, result.data)) result.error = errno ? errno : EIO;
+    return result;
+}
+
+AsyncIO::Read readAt(int fd, uint64_t offset, size_t length) {
+    AsyncIO::Read result;
+    result.data.resize(length);
+    size_t got = 0;
+    while (got < length) {
+#ifdef _WIN32
+        unsigned int step = static_cast<unsigned int>(std::min<size_t>(length - got, kMaxReadStep));
+        if (_lseeki64(fd, static_cast<__int64>(offset + got), SEEK_SET) < 0) {
+            result.error = errno;
+            break;
+        }
+        int read = _read(fd, &result.data[got], step);
+#else
+        ssize_t read = pread(fd, &result.data[got], std::min<size_t>(length - got, kMaxReadStep),
+                             static_cast<off_t>(offset + got));
+        if (read < 0 && errno == EINTR) continue;
+#endif
+        if (read < 0) {
+            result.error = errno;
+            break;
+        }
+        if (read == 0) break;
+        got += static_cast<size_t>(read);
+    }
+    result.data.resize(result.error ? 0 : got);
+    return result;
+}
+
+AsyncIO::Open openPath(const std::string& path, int flags, int mode) {
+    AsyncIO::Open result;
+#ifdef _WIN32
+    result.fd = _open(path.c_str(), flags | _O_BINARY, mode);
+#else
+    result.fd = ::open(path.c_str(), flags | O_CLOEXEC, mode);
+#endif
+    if (result.fd < 0) result.error = errno;
+    return result;
+}
+
+int closeFile(int fd) {
+#ifdef _WIN32
+    return _close(fd) == 0 ? 0 : errno;
+#else
+    // The descriptor is gone even when close reports EINTR
+    return ::close(fd) == 0 || errno == EINTR ? 0 : errno;
+#endif
+}
+
+} // namespace
+
+#if defined(__linux__)
+
+// ============================================================================
+// io_uring backend
+// ============================================================================
+
+namespace {
+
+int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ringEnter(int fd, unsigned submit, unsigned wait, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+}
+
+int ringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+void prepare(io_uring_sqe& sqe, uint8_t opcode, int fd, const void* address, uint32_t length, uint64_t offset) {
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = opcode;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(address);
+    sqe.len = length;
+    sqe.off = offset;
+}
+
+constexpr unsigned kStatMask = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+
+AsyncIO::Stat fromStatx(const struct statx& stx) {
+    AsyncIO::Stat result;
+    result.isDirectory = S_ISDIR(stx.stx_mode);
+    result.size = stx.stx_size;
+    result.modified = stx.stx_mtime.tv_sec;
+    return result;
+}
+
+} // namespace
+
+// The mapped submission and completion queues of one ring
+struct AsyncIO::Ring {
+    static constexpr unsigned kEntries = 256;
+
+    int fd = -1;
+    void* sqMemory = nullptr;
+    size_t sqSize = 0;
+    void* cqMemory = nullptr;
+    size_t cqSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    unsigned cqEntries = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned submitted = 0;   // sq tail as of the last enter
+
+    ~Ring() {
+        if (sqes) munmap(sqes, sqesSize);
+        if (cqMemory && cqMemory != sqMemory) munmap(cqMemory, cqSize);
+        if (sqMemory) munmap(sqMemory, sqSize);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool open() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = ringSetup(kEntries, &params);
+        if (fd < 0) return false;
+
+        // Every operation used here arrived in 5.6, as did the probe
+        std::vector<char> probeMemory(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeMemory.data());
+        if (ringRegister(fd, IORING_REGISTER_PROBE, probe, 256) < 0) return false;
+        for (uint8_t opcode : {IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE}) {
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) return false;
+        }
+
+        sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqSize = cqSize = std::max(sqSize, cqSize);
+
+        sqMemory = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqMemory == MAP_FAILED) {
+            sqMemory = nullptr;
+            return false;
+        }
+        cqMemory = single ? sqMemory
+                          : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cqMemory == MAP_FAILED) {
+            cqMemory = nullptr;
+            return false;
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* entries = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (entries == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(entries);
+
+        char* sq = static_cast<char*>(sqMemory);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        // Slot i of the ring always holds entry i
+        unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sqEntries; ++i) array[i] = i;
+
+        char* cq = static_cast<char*>(cqMemory);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqEntries = params.cq_entries;
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        submitted = *sqTail;
+        return true;
+    }
+
+    bool full() const {
+        return *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries;
+    }
+
+    io_uring_sqe& next() {
+        return sqes[*sqTail & sqMask];
+    }
+
+    void push() {
+        __atomic_store_n(sqTail, *sqTail + 1, __ATOMIC_RELEASE);
+    }
+};
+
+// One request on the ring, moved along step by step by the reaper
+struct AsyncIO::Request {
+    virtual ~Request() = default;
+    // Fill the entry for the current step
+    virtual void prepare(io_uring_sqe& sqe) = 0;
+    // Take the step's result; returns false after submitting the next
+    // step, true once finished
+    virtual bool complete(AsyncIO& io, int result) = 0;
+};
+
+// openat, statx for the size, reads until the end, close
+struct AsyncIO::ReadFile : AsyncIO::Request {
+    enum class Step { OPEN, STAT, READ, CLOSE };
+
+    std::string path;
+    Callback<Read> done;
+    Step step = Step::OPEN;
+    int fd = -1;
+    struct statx stx;
+    Read result;
+    size_t received = 0;
+    bool sized = false;   // the file reported its size; read only that much
+
+    ReadFile(const std::string& path, Callback<Read> done) : path(path), done(std::move(done)) {}
+
+    void prepare(io_uring_sqe& sqe) override {
+        switch (step) {
+            case Step::OPEN:
+                ::prepare(sqe, IORING_OP_OPENAT, AT_FDCWD, path.c_str(), 0, 0);
+                sqe.open_flags = O_RDONLY | O_CLOEXEC;
+                break;
+            case Step::STAT:
+                ::prepare(sqe, IORING_OP_STATX, fd, "", kStatMask, reinterpret_cast<uint64_t>(&stx));
+                sqe.statx_flags = AT_EMPTY_PATH;
+                break;
+            case Step::READ:
+                ::prepare(sqe, IORING_OP_READ, fd, &result.data[received],
+                          static_cast<uint32_t>(std::min(result.data.size() - received, kMaxReadStep)), received);
+                break;
+            case Step::CLOSE:
+                ::prepare(sqe, IORING_OP_CLOSE, fd, nullptr, 0, 0);
+                break;
+        }
+    }
+
+    bool complete(AsyncIO& io, int value) override {
+        switch (step) {
+            case Step::OPEN:
+                if (value < 0) return finish(-value);
+                fd = value;
+                step = Step::STAT;
+                break;
+            case Step::STAT:
+                if (value == 0 && S_ISDIR(stx.stx_mode)) return fail(io, EISDIR);
+                // Files that report no size (procfs, pipes) are read in growing chunks
+                sized = value == 0 && stx.stx_size > 0;
+                result.data.resize(sized ? static_cast<size_t>(stx.stx_size) : kReadChunk);
+                step = Step::READ;
+                break;
+            case Step::READ:
+                if (value < 0) return fail(io, -value);
+                received += static_cast<size_t>(value);
+                if (value == 0 || (sized && received == result.data.size())) {
+                    result.data.resize(received);
+                    step = Step::CLOSE;
+                } else if (received == result.data.size()) {
+                    result.data.resize(result.data.size() * 2);
+                }
+                break;
+            case Step::CLOSE:
+                return finish(result.error);
+        }
+        io.submit(this);
+        return false;
+    }
+
+    bool fail(AsyncIO& io, int error) {
+        result.error = error;
+        result.data.clear();
+        step = Step::CLOSE;
+        io.submit(this);
+        return false;
+    }
+
+    bool finish(int error) {
+        result.error = error;
+        if (error) result.data.clear();
+        done(std::move(result));
+        return true;
+    }
+};
+
+struct AsyncIO::ReadAt : AsyncIO::Request {
+    int fd;
+    uint64_t offset;
+    Callback<Read> done;
+    Read result;
+
+    ReadAt(int fd, uint64_t offset, size_t length, Callback<Read> done)
+        : fd(fd), offset(offset), done(std::move(done)) {
+        result.data.resize(std::min(length, kMaxReadStep));
+    }
+
+    void prepare(io_uring_sqe& sqe) override {
+        ::prepare(sqe, IORING_OP_READ, fd, &result.data[0], static_cast<uint32_t>(result.data.size()), offset);
+    }
+
+    bool complete(AsyncIO&, int value) override {
+        result.error = value < 0 ? -value : 0;
+        result.data.resize(value < 0 ? 0 : static_cast<size_t>(value));
+        done(std::move(result));
+        return true;
+    }
+};
+
+namespace {
+
+// Results of a stat batch, delivered when its last path completes
+struct StatBatch {
+    std::vector<AsyncIO::Stat> results;
+    std::atomic<size_t> remaining;
+    AsyncIO::Callback<std::vector<AsyncIO::Stat>> done;
+
+    StatBatch(size_t count, AsyncIO::Callback<std::vector<AsyncIO::Stat>> done)
+        : results(count), remaining(count), done(std::move(done)) {}
+
+    void set(size_t index, AsyncIO::Stat&& stat) {
+        results[index] = std::move(stat);
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) done(std::move(results));
+    }
+};
+
+} // namespace
+
+struct AsyncIO::StatPath : AsyncIO::Request {
+    std::string path;
+    Callback<Stat> done;
+    std::shared_ptr<StatBatch> batch;   // or, part of a batch
+    size_t index = 0;
+    struct statx stx;
+
+    StatPath(const std::string& path, Callback<Stat> done) : path(path), done(std::move(done)) {}
+    StatPath(const std::string& path, std::shared_ptr<StatBatch> batch, size_t index)
+        : path(path), batch(std::move(batch)), index(index) {}
+
+    void prepare(io_uring_sqe& sqe) override {
+        ::prepare(sqe, IORING_OP_STATX, AT_FDCWD, path.c_str(), kStatMask, reinterpret_cast<uint64_t>(&stx));
+        sqe.statx_flags = AT_STATX_SYNC_AS_STAT;
+    }
+
+    bool complete(AsyncIO&, int value) override {
+        Stat result;
+        if (value < 0) {
+            result.error = -value;
+        } else {
+            result = fromStatx(stx);
+        }
+        if (batch) {
+            batch->set(index, std::move(result));
+        } else {
+            done(std::move(result));
+        }
+        return true;
+    }
+};
+
+struct AsyncIO::OpenPath : AsyncIO::Request {
+    std::string path;
+    int flags;
+    int mode;
+    Callback<Open> done;
+
+    OpenPath(const std::string& path, int flags, int mode, Callback<Open> done)
+        : path(path), flags(flags), mode(mode), done(std::move(done)) {}
+
+    void prepare(io_uring_sqe& sqe) override {
+        ::prepare(sqe, IORING_OP_OPENAT, AT_FDCWD, path.c_str(), static_cast<uint32_t>(mode), 0);
+        sqe.open_flags = static_cast<uint32_t>(flags | O_CLOEXEC);
+    }
+
+    bool complete(AsyncIO&, int value) override {
+        Open result;
+        if (value < 0) {
+            result.error = -value;
+        } else {
+            result.fd = value;
+        }
+        done(std::move(result));
+        return true;
+    }
+};
+
+struct AsyncIO::CloseFile : AsyncIO::Request {
+    int fd;
+    Callback<int> done;
+
+    CloseFile(int fd, Callback<int> done) : fd(fd), done(std::move(done)) {}
+
+    void prepare(io_uring_sqe& sqe) override {
+        ::prepare(sqe, IORING_OP_CLOSE, fd, nullptr, 0, 0);
+    }
+
+    bool complete(AsyncIO&, int value) override {
+        int error = value < 0 ? -value : 0;
+        done(std::move(error));
+        return true;
+    }
+};
+
+bool AsyncIO::startRing() {
+    auto ring = std::make_unique<Ring>();
+    if (!ring->open()) return false;
+    ring_ = std::move(ring);
+    reaper_ = std::thread(&AsyncIO::reap, this);
+    return true;
+}
+
+void AsyncIO::submit(Request* request) {
+    {
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        submitLocked(request);
+        enterLocked();
+    }
+    completeFailed();
+}
+
+void AsyncIO::submit(const std::vector<Request*>& requests) {
+    {
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        for (Request* request : requests) submitLocked(request);
+        enterLocked();
+    }
+    completeFailed();
+}
+
+// Queues the request's next step. Steps beyond what the completion queue
+// holds wait in the backlog until completions make room.
+void AsyncIO::submitLocked(Request* request) {
+    if (inFlight_ >= ring_->cqEntries) {
+        backlog_.push_back(request);
+        return;
+    }
+    if (ring_->full()) enterLocked();
+    io_uring_sqe& sqe = ring_->next();
+    request->prepare(sqe);
+    sqe.user_data = reinterpret_cast<uint64_t>(request);
+    ring_->push();
+    ++inFlight_;
+}
+
+// Hands the queued entries to the kernel. If it refuses them for good,
+// they are taken back off the ring and their requests fail with the
+// error (completeFailed(), once the lock is released).
+void AsyncIO::enterLocked() {
+    unsigned pending = *ring_->sqTail - ring_->submitted;
+    while (pending > 0) {
+        int entered = ringEnter(ring_->fd, pending, 0, 0);
+        if (entered < 0) {
+            int error = errno;
+            if (error == EINTR || error == EAGAIN || error == EBUSY) continue;
+            // The kernel consumes nothing when it fails
+            for (unsigned tail = ring_->submitted; tail != *ring_->sqTail; ++tail) {
+                Request* request = reinterpret_cast<Request*>(ring_->sqes[tail & ring_->sqMask].user_data);
+                if (!request) continue;   // the wake-up nop
+                failed_.emplace_back(request, -error);
+                --inFlight_;
+            }
+            __atomic_store_n(ring_->sqTail, ring_->submitted, __ATOMIC_RELEASE);
+            break;
+        }
+        ring_->submitted += static_cast<unsigned>(entered);
+        pending -= static_cast<unsigned>(entered);
+    }
+}
+
+void AsyncIO::completeFailed() {
+    std::vector<std::pair<Request*, int>> failed;
+    {
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        if (failed_.empty()) return;
+        failed.swap(failed_);
+    }
+    for (const auto& [request, result] : failed) {
+        if (request->complete(*this, result)) delete request;
+    }
+}
+
+void AsyncIO::reap() {
+    std::vector<std::pair<Request*, int>> completed;
+    for (;;) {
+        if (ringEnter(ring_->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) break;
+
+        completed.clear();
+        unsigned head = *ring_->cqHead;
+        unsigned tail = __atomic_load_n(ring_->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring_->cqes[head & ring_->cqMask];
+            completed.emplace_back(reinterpret_cast<Request*>(cqe.user_data), cqe.res);
+        }
+        __atomic_store_n(ring_->cqHead, head, __ATOMIC_RELEASE);
+
+        {
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            for (const auto& [request, result] : completed) {
+                if (request) --inFlight_;   // null: the wake-up nop
+            }
+            while (!backlog_.empty() && inFlight_ < ring_->cqEntries) {
+                submitLocked(backlog_.front());
+                backlog_.pop_front();
+            }
+            enterLocked();
+        }
+        completeFailed();
+
+        for (const auto& [request, result] : completed) {
+            if (request && request->complete(*this, result)) delete request;
+        }
+
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        if (stopping_.load() && inFlight_ == 0 && backlog_.empty()) break;
+    }
+}
+
+#else
+
+struct AsyncIO::Ring {};
+struct AsyncIO::Request {};
+
+bool AsyncIO::startRing() {
+    return false;
+}
+
+void AsyncIO::reap() {
+}
+
+#endif
+
+// ============================================================================
+// AsyncIO
+// ============================================================================
+
+AsyncIO::AsyncIO(size_t threads, Backend preferred)
+    : pool_(std::make_unique<WorkStealingPool>(std::max<size_t>(threads, 1))) {
+    if (preferred == Backend::IO_URING) startRing();
+}
+
+AsyncIO::~AsyncIO() {
+    // Pool callbacks may submit to the ring and ring callbacks to the pool
+    pool_->wait();
+#if defined(__linux__)
+    if (ring_) {
+        {
+            // A nop wakes the reaper, which leaves once nothing is in flight
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            stopping_.store(true);
+            while (ring_->full()) enterLocked();
+            io_uring_sqe& sqe = ring_->next();
+            prepare(sqe, IORING_OP_NOP, -1, nullptr, 0, 0);
+            sqe.user_data = 0;
+            ring_->push();
+            enterLocked();
+        }
+        completeFailed();
+        reaper_.join();
+    }
+#endif
+    pool_->wait();
+}
+
+AsyncIO& AsyncIO::shared() {
+    static AsyncIO instance;
+    return instance;
+}
+
+void AsyncIO::runOnPool(std::function<void()> task) {
+    pool_->submit(std::move(task));
+}
+
+std::future<AsyncIO::Read> AsyncIO::read(const std::string& path) {
+    std::future<Read> future;
+    read(path, fulfil(future));
+    return future;
+}
+
+void AsyncIO::read(const std::string& path, Callback<Read> done) {
+#if defined(__linux__)
+    if (ring_) {
+        submit(new ReadFile(path, std::move(done)));
+        return;
+    }
+#endif
+    runOnPool([path, done = std::move(done)] { done(readPath(path)); });
+}
+
+std::future<AsyncIO::Read> AsyncIO::read(int fd, uint64_t offset, size_t length) {
+    std::future<Read> future;
+    read(fd, offset, length, fulfil(future));
+    return future;
+}
+
+void AsyncIO::read(int fd, uint64_t offset, size_t length, Callback<Read> done) {
+#if defined(__linux__)
+    if (ring_) {
+        submit(new ReadAt(fd, offset, length, std::move(done)));
+        return;
+    }
+#endif
+    runOnPool([fd, offset, length, done = std::move(done)] { done(readAt(fd, offset, length)); });
+}
+
+std::future<bool> AsyncIO::write(const std::string& path, std::string content,
+                                 const FileOperations::WriteOptions& options) {
+    std::future<bool> future;
+    write(path, std::move(content), options, fulfil(future));
+    return future;
+}
+
+void AsyncIO::write(const std::string& path, std::string content, const FileOperations::WriteOptions& options,
+                    Callback<bool> done) {
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto [queue, first] = writes_.try_emplace(path);
+        queue->second.push_back({std::make_shared<const std::string>(std::move(content)), options, std::move(done)});
+        if (!first) return;   // the path's running drain picks it up
+    }
+    runOnPool([this, path] { drainWrites(path); });
+}
+
+// Writes the newest content queued for path until none is left. Older
+// writes queued with it are superseded and complete with its result.
+void AsyncIO::drainWrites(const std::string& path) {
+    for (;;) {
+        std::vector<PendingWrite> batch;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            auto queue = writes_.find(path);
+            if (queue->second.empty()) {
+                writes_.erase(queue);
+                return;
+            }
+            batch.swap(queue->second);
+        }
+
+        FileOperations::WriteOptions options = batch.back().options;
+        for (const PendingWrite& write : batch) options.durable = options.durable || write.options.durable;
+        bool written = FileOperations::writeFile(path, *batch.back().content, options);
+        for (PendingWrite& write : batch) {
+            bool result = written;
+            write.done(std::move(result));
+        }
+    }
+}
+
+std::future<AsyncIO::Stat> AsyncIO::stat(const std::string& path) {
+    std::future<Stat> future;
+    stat(path, fulfil(future));
+    return future;
+}
+
+void AsyncIO::stat(const std::string& path, Callback<Stat> done) {
+#if defined(__linux__)
+    if (ring_) {
+        submit(new StatPath(path, std::move(done)));
+        return;
+    }
+#endif
+    runOnPool([path, done = std::move(done)] { done(statPath(path)); });
+}
+
+std::future<std::vector<AsyncIO::Stat>> AsyncIO::stat(const std::vector<std::string>& paths) {
+    std::future<std::vector<Stat>> future;
+    stat(paths, fulfil(future));
+    return future;
+}
+
+void AsyncIO::stat(const std::vector<std::string>& paths, Callback<std::vector<Stat>> done) {
+    if (paths.empty()) {
+        done(std::vector<Stat>());
+        return;
+    }
+
+#if defined(__linux__)
+    if (ring_) {
+        auto batch = std::make_shared<StatBatch>(paths.size(), std::move(done));
+        std::vector<Request*> requests;
+        requests.reserve(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) requests.push_back(new StatPath(paths[i], batch, i));
+        submit(requests);
+        return;
+    }
+#endif
+
+    struct Batch {
+        std::vector<std::string> paths;
+        std::vector<Stat> results;
+        std::atomic<size_t> remaining;
+        Callback<std::vector<Stat>> done;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->paths = paths;
+    batch->results.resize(paths.size());
+    batch->remaining = (paths.size() + kStatChunk - 1) / kStatChunk;
+    batch->done = std::move(done);
+    for (size_t first = 0; first < paths.size(); first += kStatChunk) {
+        runOnPool([batch, first] {
+            size_t last = std::min(first + kStatChunk, batch->paths.size());
+            for (size_t i = first; i < last; ++i) batch->results[i] = statPath(batch->paths[i]);
+            if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) batch->done(std::move(batch->results));
+        });
+    }
+}
+
+std::future<AsyncIO::Open> AsyncIO::open(const std::string& path, int flags, int mode) {
+    std::future<Open> future;
+    open(path, flags, mode, fulfil(future));
+    return future;
+}
+
+void AsyncIO::open(const std::string& path, int flags, int mode, Callback<Open> done) {
+#if defined(__linux__)
+    if (ring_) {
+        submit(new OpenPath(path, flags, mode, std::move(done)));
+        return;
+    }
+#endif
+    runOnPool([path, flags, mode, done = std::move(done)] { done(openPath(path, flags, mode)); });
+}
+
+std::future<int> AsyncIO::close(int fd) {
+    std::future<int> future;
+    close(fd, fulfil(future));
+    return future;
+}
+
+void AsyncIO::close(int fd, Callback<int> done) {
+#if defined(__linux__)
+    if (ring_) {
+        submit(new CloseFile(fd, std::move(done)));
+        return;
+    }
+#endif
+    runOnPool([fd, done = std::move(done)] { done(closeFile(fd)); });
+}
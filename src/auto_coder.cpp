@@ -1,4 +1,9 @@
 #include "auto_coder.h"
+#include "bracket_index.h"
+#include "file_tree.h"
+#include "file_walker.h"
+#include "file_operations.h"
+#include "mapped_file.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -151,34 +156,39 @@ bool AutoCoder::ensureProductionReady(CodeModule& module) {
 
 // C - Auto Coder Fixer
 std::vector<CodeError> AutoCoder::detectErrors(const std::string& code, Language language) {
+    HybridIDE::TextBuffer buffer;
+    buffer.setText(code);
+    return detectErrors(buffer, language);
+}
+
+std::vector<CodeError> AutoCoder::detectErrors(const HybridIDE::TextBuffer& buffer, Language language) {
     std::vector<CodeError> errors;
     
     // Simple error detection
     if (language == Language::CPP) {
-        // Check for missing semicolons (simplified)
-        std::regex missingcol("[^;{}\n][\n]");
-        std::string::const_iterator searchStart(code.cbegin());
-        std::smatch match;
-        
-        int line = 1;
-        for (char c : code) {
-            if (c == '\n') line++;
-        }
+        // Check for unmatched brackets, ignoring any inside strings and comments
+        HybridIDE::SyntaxHighlighter highlighter("cpp");
+        HybridIDE::BracketIndex brackets;
+        highlighter.reset(buffer.lineCount());
+        brackets.reset(buffer.lineCount());
         
-        // Check for unmatched braces
-        int braceCount = 0;
-        for (char c : code) {
-            if (c == '{') braceCount++;
-            if (c == '}') braceCount--;
+        HybridIDE::BracketIndex::Position at;
+        if (brackets.findUnmatchedClose(buffer, highlighter, at)) {
+            CodeError error;
+            error.file = "current";
+            error.line = static_cast<int>(at.line) + 1;
+            error.message = "Unmatched closing bracket at column " + std::to_string(at.column + 1);
+            error.severity = "error";
+            error.fix = "Remove the bracket or add the missing opening bracket";
+            errors.push_back(error);
         }
-        
-        if (braceCount != 0) {
+        if (brackets.findUnmatchedOpen(buffer, highlighter, at)) {
             CodeError error;
             error.file = "current";
-            error.line = line;
-            error.message = "Unmatched braces";
+            error.line = static_cast<int>(at.line) + 1;
+            error.message = "Unclosed bracket at column " + std::to_string(at.column + 1);
             error.severity = "error";
-            error.fix = "Add missing brace";
+            error.fix = "Add missing closing bracket";
             errors.push_back(error);
         }
     }
@@ -194,15 +204,24 @@ bool AutoCoder::fixError(CodeError& error) {
     return false;
 }
 
+// Large sources are mapped straight into the buffer and small ones read
+// once and moved in, so a file is never copied to be checked
+static bool loadSource(const std::string& path, HybridIDE::TextBuffer& buffer) {
+    FileView view;
+    if (!FileOperations::readFile(path, view)) return false;
+    if (view.mapping()) {
+        buffer.setText(view.mapping());
+    } else {
+        buffer.setText(view.release());
+    }
+    return true;
+}
+
 bool AutoCoder::fixAllErrors(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file) return false;
+    HybridIDE::TextBuffer buffer;
+    if (!loadSource(filePath, buffer)) return false;
     
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-    file.close();
-    
-    auto errors = detectErrors(content, Language::CPP);
+    auto errors = detectErrors(buffer, Language::CPP);
     
     for (auto& error : errors) {
         fixError(error);
@@ -212,6 +231,29 @@ bool AutoCoder::fixAllErrors(const std::string& filePath) {
 }
 
 bool AutoCoder::recursiveFixUntilZeroErrors(const std::string& projectPath) {
+    // List the sources once rather than walking the project every pass
+    std::vector<std::string> sources;
+    for (const FileWalker::Directory& directory : FileWalker::collect(projectPath, FileWalker::Options())) {
+        for (const FileWalker::Entry& entry : directory.entries) {
+            fs::path extension = fs::path(entry.name).extension();
+            if (entry.isDirectory || (extension != ".cpp" && extension != ".h")) continue;
+            sources.push_back((fs::path(projectPath) / directory.path / entry.name).string());
+        }
+    }
+    return fixSourcesUntilZeroErrors(sources);
+}
+
+bool AutoCoder::recursiveFixUntilZeroErrors(const FileTree& tree) {
+    std::vector<std::string> sources;
+    for (const char* extension : {".cpp", ".h"}) {
+        for (FileTree::NodeId id : tree.filesWithExtension(extension)) {
+            sources.push_back(tree.path(id));
+        }
+    }
+    return fixSourcesUntilZeroErrors(sources);
+}
+
+bool AutoCoder::fixSourcesUntilZeroErrors(const std::vector<std::string>& sources) {
     int maxIterations = 10;
     int iteration = 0;
     
@@ -219,20 +261,17 @@ bool AutoCoder::recursiveFixUntilZeroErrors(const std::string& projectPath) {
         buildStatus_.totalErrors = 0;
         
         // Detect all errors in project
-        for (const auto& entry : fs::recursive_directory_iterator(projectPath)) {
-            if (entry.path().extension() == ".cpp" || entry.path().extension() == ".h") {
-                std::ifstream file(entry.path());
-                std::string content((std::istreambuf_iterator<char>(file)),
-                                   std::istreambuf_iterator<char>());
-                
-                auto errors = detectErrors(content, Language::CPP);
-                buildStatus_.totalErrors += errors.size();
-                
-                // Fix errors
-                for (auto& error : errors) {
-                    if (fixError(error)) {
-                        buildStatus_.fixedErrors++;
-                    }
+        for (const std::string& source : sources) {
+            HybridIDE::TextBuffer buffer;
+            if (!loadSource(source, buffer)) continue;
+            
+            auto errors = detectErrors(buffer, Language::CPP);
+            buildStatus_.totalErrors += errors.size();
+            
+            // Fix errors
+            for (auto& error : errors) {
+                if (fixError(error)) {
+                    buildStatus_.fixedErrors++;
                 }
             }
         }
@@ -354,12 +393,12 @@ bool AutoCoder::generateFullProject(const ProjectSpec& spec) {
         progressCallback_("Generating folders...", 20);
     }
     
-    // Generate source files
+    // Generate source files, written together with the README below
     auto modules = generateProject(spec.description);
+    std::vector<FileOperations::WriteRequest> files;
+    files.reserve(modules.size() + 1);
     for (const auto& module : modules) {
-        std::ofstream out(module.path);
-        out << module.content;
-        out.close();
+        files.push_back({module.path, module.content, FileOperations::WriteOptions()});
     }
     
     if (progressCallback_) {
@@ -384,7 +423,7 @@ bool AutoCoder::generateFullProject(const ProjectSpec& spec) {
     }
     
     // Generate README
-    std::ofstream readme("README.md");
+    std::ostringstream readme;
     readme << "# " << spec.description << "\n\n";
     readme << "Auto-generated project by ZACH Auto Coder\n\n";
     readme << "## Build Instructions\n\n";
@@ -393,13 +432,16 @@ bool AutoCoder::generateFullProject(const ProjectSpec& spec) {
     readme << "cmake ..\n";
     readme << "cmake --build .\n";
     readme << "```\n";
-    readme.close();
+    std::string readmeText = readme.str();
+    files.push_back({"README.md", readmeText, FileOperations::WriteOptions()});
+    
+    bool written = FileOperations::writeFiles(files) == files.size();
     
     if (progressCallback_) {
-        progressCallback_("Project generation complete!", 100);
+        progressCallback_(written ? "Project generation complete!" : "Some project files could not be written", 100);
     }
     
-    return true;
+    return written;
 }
 
 bool AutoCoder::generateFolders(const std::string& structure) {
@@ -430,25 +472,19 @@ export const AutoGeneratedComponent = () => {
 export default AutoGeneratedComponent;
 )";
     
-    fs::create_directories("src/components");
-    std::ofstream out("src/components/AutoGenerated.tsx");
-    out << componentCode;
-    out.close();
-    
-    return true;
+    return FileOperations::writeFile("src/components/AutoGenerated.tsx", componentCode);
 }
 
 bool AutoCoder::generateBuildSystem(const std::string& projectType) {
     if (projectType == "cmake") {
-        std::ofstream cmake("CMakeLists.txt");
+        std::ostringstream cmake;
         cmake << "cmake_minimum_required(VERSION 3.15)\n";
         cmake << "project(AutoGeneratedProject VERSION 1.0.0)\n\n";
         cmake << "set(CMAKE_CXX_STANDARD 17)\n";
         cmake << "set(CMAKE_CXX_STANDARD_REQUIRED ON)\n\n";
         cmake << "file(GLOB_RECURSE SOURCES \"src/*.cpp\")\n";
         cmake << "add_executable(${PROJECT_NAME} ${SOURCES})\n";
-        cmake.close();
-        return true;
+        return FileOperations::writeFile("CMakeLists.txt", cmake.str());
     }
     
     return false;
@@ -0,0 +1,351 @@
+#include "bracket_index.h"
+#include <algorithm>
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr size_t kBlockLines = 64;
+constexpr size_t kMinGrowLines = 4096;   // lines scanned ahead when a search runs off the clean prefix
+constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+bool isOpener(char c) {
+    return c == '(' || c == '[' || c == '{';
+}
+
+bool isBracket(char c) {
+    return isOpener(c) || c == ')' || c == ']' || c == '}';
+}
+
+char pairOf(char c) {
+    switch (c) {
+        case '(': return ')';
+        case '[': return ']';
+        case '{': return '}';
+        case ')': return '(';
+        case ']': return '[';
+        case '}': return '{';
+        default: return 0;
+    }
+}
+
+} // namespace
+
+BracketIndex::BracketIndex()
+    : firstDirty_(0), dirtyUntil_(0), lastRescanCount_(0), leafCount_(0), staleBlock_(0) {
+}
+
+void BracketIndex::reset(size_t lineCount) {
+    lines_.assign(lineCount, LineInfo());
+    firstDirty_ = 0;
+    dirtyUntil_ = lineCount;
+    staleBlock_ = 0;
+}
+
+void BracketIndex::applyEdit(size_t startLine, size_t oldEndLine, size_t newEndLine) {
+    if (startLine >= lines_.size()) {
+        reset(lines_.size() + newEndLine - oldEndLine);
+        return;
+    }
+
+    bool clean = firstDirty_ >= lines_.size();
+    size_t oldCount = oldEndLine - startLine + 1;
+    size_t newCount = newEndLine - startLine + 1;
+    auto at = lines_.begin() + static_cast<std::ptrdiff_t>(startLine + 1);
+    if (newCount > oldCount) {
+        lines_.insert(at, newCount - oldCount, LineInfo());
+    } else if (oldCount > newCount) {
+        lines_.erase(at, at + static_cast<std::ptrdiff_t>(oldCount - newCount));
+    }
+    staleBlock_ = std::min(staleBlock_, startLine / kBlockLines);
+
+    if (clean) {
+        firstDirty_ = startLine;
+        dirtyUntil_ = newEndLine;
+        return;
+    }
+
+    // Keep a pending dirty range pointing at the same text after the shift.
+    // Lines from the old firstDirty_ on were never updated for that range, so
+    // the new scan may not stop before reaching them.
+    if (dirtyUntil_ > oldEndLine) {
+        dirtyUntil_ = dirtyUntil_ + newEndLine - oldEndLine;
+    }
+    size_t pending = firstDirty_ > oldEndLine ? firstDirty_ + newEndLine - oldEndLine : newEndLine;
+    dirtyUntil_ = std::max({dirtyUntil_, newEndLine, pending});
+    firstDirty_ = std::min(firstDirty_, startLine);
+}
+
+void BracketIndex::lexBrackets(std::string_view text, uint8_t state, const SyntaxHighlighter& highlighter) {
+    highlighter.tokenize(text, state, tokens_);
+    brackets_.clear();
+    for (const SyntaxHighlighter::Token& token : tokens_) {
+        if (token.type != SyntaxHighlighter::TokenType::PUNCTUATION &&
+            token.type != SyntaxHighlighter::TokenType::OPERATOR &&
+            token.type != SyntaxHighlighter::TokenType::TEXT) {
+            continue;   // strings, comments, preprocessor lines
+        }
+        for (uint32_t i = token.start; i < token.start + token.length; ++i) {
+            if (isBracket(text[i])) brackets_.push_back({i, text[i]});
+        }
+    }
+}
+
+void BracketIndex::loadLine(const TextBuffer& buffer, const SyntaxHighlighter& highlighter, size_t line) {
+    lexBrackets(buffer.getLine(line), lines_[line].entryState, highlighter);
+}
+
+void BracketIndex::ensure(const TextBuffer& buffer, SyntaxHighlighter& highlighter, size_t line) {
+    lastRescanCount_ = 0;
+    if (lines_.size() != buffer.lineCount()) {
+        reset(buffer.lineCount());
+    }
+
+    // Whole blocks only, so the tree can always use every block below firstDirty_
+    size_t target = std::min(lines_.size(), (line + kBlockLines - 1) / kBlockLines * kBlockLines);
+    while (firstDirty_ < target) {
+        size_t i = firstDirty_;
+        uint8_t entry = i == 0 ? 0 : highlighter.getLineEndState(buffer, i - 1);
+        if (i > dirtyUntil_ && entry == lines_[i].entryState) {
+            firstDirty_ = lines_.size();   // unchanged text in an unchanged state
+            break;
+        }
+
+        lexBrackets(buffer.getLine(i), entry, highlighter);
+        Summary summary;
+        for (const Bracket& bracket : brackets_) {
+            summary.net += isOpener(bracket.ch) ? 1 : -1;
+            summary.minPrefix = std::min(summary.minPrefix, summary.net);
+        }
+        lines_[i].summary = summary;
+        lines_[i].entryState = entry;
+        staleBlock_ = std::min(staleBlock_, i / kBlockLines);
+        ++lastRescanCount_;
+        firstDirty_ = i + 1;
+    }
+}
+
+size_t BracketIndex::cleanBlockCount() const {
+    if (firstDirty_ >= lines_.size()) {
+        return (lines_.size() + kBlockLines - 1) / kBlockLines;
+    }
+    return firstDirty_ / kBlockLines;
+}
+
+BracketIndex::Summary BracketIndex::combine(const Summary& left, const Summary& right) {
+    Summary result;
+    result.net = left.net + right.net;
+    result.minPrefix = std::min(left.minPrefix, left.net + right.minPrefix);
+    return result;
+}
+
+void BracketIndex::updateTree(size_t cleanBlocks) {
+    size_t blockCount = (lines_.size() + kBlockLines - 1) / kBlockLines;
+    if (tree_.empty() || leafCount_ < blockCount) {
+        leafCount_ = 1;
+        while (leafCount_ < blockCount) leafCount_ *= 2;
+        tree_.assign(2 * leafCount_, Summary());
+        staleBlock_ = 0;
+    }
+    if (staleBlock_ >= cleanBlocks) return;
+
+    for (size_t block = staleBlock_; block < cleanBlocks; ++block) {
+        Summary summary;
+        size_t end = std::min(lines_.size(), (block + 1) * kBlockLines);
+        for (size_t line = block * kBlockLines; line < end; ++line) {
+            summary = combine(summary, lines_[line].summary);
+        }
+        tree_[leafCount_ + block] = summary;
+    }
+
+    size_t lo = leafCount_ + staleBlock_;
+    size_t hi = leafCount_ + cleanBlocks - 1;
+    while (lo > 1) {
+        lo /= 2;
+        hi /= 2;
+        for (size_t node = lo; node <= hi; ++node) {
+            tree_[node] = combine(tree_[2 * node], tree_[2 * node + 1]);
+        }
+    }
+    staleBlock_ = cleanBlocks;
+}
+
+size_t BracketIndex::descendForward(size_t node, size_t begin, size_t end, size_t from, size_t limit,
+                                    int64_t& depth) const {
+    if (end <= from || begin >= limit) return kNotFound;
+    if (from <= begin && end <= limit) {
+        const Summary& summary = tree_[node];
+        if (depth + summary.minPrefix >= 0) {
+            depth += summary.net;
+            return kNotFound;
+        }
+        if (end - begin == 1) return begin;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    size_t found = descendForward(2 * node, begin, mid, from, limit, depth);
+    if (found != kNotFound) return found;
+    return descendForward(2 * node + 1, mid, end, from, limit, depth);
+}
+
+size_t BracketIndex::descendBackward(size_t node, size_t begin, size_t end, size_t to,
+                                     int64_t& depth) const {
+    if (begin >= to) return kNotFound;
+    if (end <= to) {
+        const Summary& summary = tree_[node];
+        if (depth + summary.net - summary.minPrefix < 1) {
+            depth += summary.net;
+            return kNotFound;
+        }
+        if (end - begin == 1) return begin;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    size_t found = descendBackward(2 * node + 1, mid, end, to, depth);
+    if (found != kNotFound) return found;
+    return descendBackward(2 * node, begin, mid, to, depth);
+}
+
+char BracketIndex::searchForward(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                                 size_t line, size_t index, Position& out) {
+    int64_t depth = 0;
+
+    // Finds the closer within one line, using its summary to skip it when possible
+    auto scanLine = [&](size_t l, size_t first) -> char {
+        if (first == 0) {
+            const Summary& summary = lines_[l].summary;
+            if (depth + summary.minPrefix >= 0) {
+                depth += summary.net;
+                return 0;
+            }
+        }
+        loadLine(buffer, highlighter, l);
+        for (size_t k = first; k < brackets_.size(); ++k) {
+            depth += isOpener(brackets_[k].ch) ? 1 : -1;
+            if (depth < 0) {
+                out = {l, brackets_[k].column};
+                return brackets_[k].ch;
+            }
+        }
+        return 0;
+    };
+    auto scanBlock = [&](size_t block, size_t first) -> char {
+        size_t end = std::min(lines_.size(), (block + 1) * kBlockLines);
+        for (size_t l = std::max(first, block * kBlockLines); l < end; ++l) {
+            if (char found = scanLine(l, 0)) return found;
+        }
+        return 0;
+    };
+
+    if (char found = scanLine(line, index)) return found;
+    if (char found = scanBlock(line / kBlockLines, line + 1)) return found;
+
+    size_t from = line / kBlockLines + 1;
+    for (;;) {
+        size_t limit = cleanBlockCount();
+        updateTree(limit);
+        size_t block = descendForward(1, 0, leafCount_, from, limit, depth);
+        if (block != kNotFound) return scanBlock(block, 0);
+        if (firstDirty_ >= lines_.size()) return 0;
+
+        // Ran off the scanned prefix: scan further ahead, doubling each time
+        size_t scanned = limit * kBlockLines;
+        from = limit;
+        ensure(buffer, highlighter, std::max(scanned * 2, scanned + kMinGrowLines));
+    }
+}
+
+char BracketIndex::searchBackward(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                                  size_t line, size_t index, Position& out) {
+    int64_t depth = 0;
+
+    auto scanLine = [&](size_t l, size_t last) -> char {
+        if (last == kNotFound) {
+            const Summary& summary = lines_[l].summary;
+            if (depth + summary.net - summary.minPrefix < 1) {
+                depth += summary.net;
+                return 0;
+            }
+        }
+        loadLine(buffer, highlighter, l);
+        for (size_t k = std::min(last, brackets_.size()); k-- > 0;) {
+            depth += isOpener(brackets_[k].ch) ? 1 : -1;
+            if (depth > 0) {
+                out = {l, brackets_[k].column};
+                return brackets_[k].ch;
+            }
+        }
+        return 0;
+    };
+    auto scanBlock = [&](size_t block, size_t last) -> char {
+        for (size_t l = std::min(last, (block + 1) * kBlockLines); l-- > block * kBlockLines;) {
+            if (char found = scanLine(l, kNotFound)) return found;
+        }
+        return 0;
+    };
+
+    if (char found = scanLine(line, index)) return found;
+    if (char found = scanBlock(line / kBlockLines, line)) return found;
+
+    // Everything before `line` is already scanned
+    updateTree(cleanBlockCount());
+    size_t block = descendBackward(1, 0, leafCount_, line / kBlockLines, depth);
+    return block != kNotFound ? scanBlock(block, lines_.size()) : 0;
+}
+
+bool BracketIndex::findMatch(const TextBuffer& buffer, SyntaxHighlighter& highlighter,
+                             const Position& at, Position& match) {
+    ensure(buffer, highlighter, at.line + 1);
+    if (at.line >= lines_.size()) return false;
+
+    loadLine(buffer, highlighter, at.line);
+    auto it = std::lower_bound(brackets_.begin(), brackets_.end(), at.column,
+                               [](const Bracket& bracket, size_t column) { return bracket.column < column; });
+    if (it == brackets_.end() || it->column != at.column) return false;
+
+    char ch = it->ch;
+    size_t index = static_cast<size_t>(it - brackets_.begin());
+    char found = isOpener(ch) ? searchForward(buffer, highlighter, at.line, index + 1, match)
+                              : searchBackward(buffer, highlighter, at.line, index, match);
+    return found != 0 && found == pairOf(ch);
+}
+
+std::vector<BracketIndex::FoldRegion> BracketIndex::getFoldRegions(const TextBuffer& buffer,
+                                                                   SyntaxHighlighter& highlighter,
+                                                                   size_t firstLine, size_t lastLine) {
+    std::vector<FoldRegion> regions;
+    ensure(buffer, highlighter, lastLine);
+    lastLine = std::min(lastLine, lines_.size());
+
+    std::vector<size_t> open;
+    for (size_t line = firstLine; line < lastLine; ++line) {
+        const Summary& summary = lines_[line].summary;
+        if (summary.net - summary.minPrefix <= 0) continue;   // leaves nothing open
+
+        // The outermost opener still open at the end of the line starts the fold
+        loadLine(buffer, highlighter, line);
+        open.clear();
+        for (size_t k = 0; k < brackets_.size(); ++k) {
+            if (isOpener(brackets_[k].ch)) {
+                open.push_back(k);
+            } else if (!open.empty()) {
+                open.pop_back();
+            }
+        }
+        if (open.empty()) continue;
+
+        Position end;
+        if (searchForward(buffer, highlighter, line, open.front() + 1, end) && end.line > line) {
+            regions.push_back({line, end.line});
+        }
+    }
+    return regions;
+}
+
+bool BracketIndex::findUnmatchedClose(const TextBuffer& buffer, SyntaxHighlighter& highlighter, Position& at) {
+    ensure(buffer, highlighter, 1);
+    return !lines_.empty() && searchForward(buffer, highlighter, 0, 0, at) != 0;
+}
+
+bool BracketIndex::findUnmatchedOpen(const TextBuffer& buffer, SyntaxHighlighter& highlighter, Position& at) {
+    ensure(buffer, highlighter, buffer.lineCount());
+    return !lines_.empty() && searchBackward(buffer, highlighter, lines_.size() - 1, kNotFound, at) != 0;
+}
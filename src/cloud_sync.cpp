@@ -1,5 +1,9 @@
 #include "cloud_sync.h"
+#include "file_operations.h"
+#include "project_index.h"
 #include <iostream>
+#include <cstdio>
+#include <cstring>
 
 CloudSync::CloudSync() {
     // Constructor
@@ -109,6 +113,23 @@ std::vector<CloudSync::FileChange> CloudSync::getRemoteChanges(const std::string
     return changes;
 }
 
+// Files are hashed and compared through shared views, so large files are
+// mapped and scanned once instead of being copied into memory
+std::string CloudSync::calculateFileHash(const std::string& filepath) const {
+    FileView view;
+    if (!FileOperations::readFile(filepath, view)) return "";
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(HybridIDE::ProjectIndex::hashContent(view.view())));
+    return hex;
+}
+
+bool CloudSync::compareFiles(const std::string& file1, const std::string& file2) const {
+    FileView first, second;
+    if (!FileOperations::readFile(file1, first) || !FileOperations::readFile(file2, second)) return false;
+    return first.size() == second.size() && std::memcmp(first.data(), second.data(), first.size()) == 0;
+}
+
 std::vector<CloudSync::FileChange> CloudSync::detectConflicts(const std::string& localPath) const {
     std::vector<FileChange> conflicts;
     return conflicts;
@@ -110,6 +110,9 @@ std::string Compiler::buildCommand(const CompileOptions& options) {
     
     // Add source file
     cmd << " \"" << options.sourceFile << "\"";
+    for (const auto& source : options.additionalSources) {
+        cmd << " \"" << source << "\"";
+    }
     
     // Add output file
     cmd << " -o \"" << options.outputFile << "\"";
@@ -0,0 +1,296 @@
+#include "content_search.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace HybridIDE;
+
+namespace {
+
+// Builds PatternLiterals from a valid pattern in RegexSearcher syntax:
+// runs of literal characters are collected, alternations become ORs, and
+// anything optional or variable breaks a run
+class LiteralAnalyzer {
+public:
+    explicit LiteralAnalyzer(const std::string& pattern) : pattern_(pattern) {}
+
+    PatternLiterals parse() {
+        pos_ = 0;
+        return alternation();
+    }
+
+private:
+    const std::string& pattern_;
+    size_t pos_ = 0;
+
+    bool atEnd() const { return pos_ >= pattern_.size(); }
+
+    PatternLiterals alternation() {
+        std::vector<PatternLiterals> branches;
+        branches.push_back(concatenation());
+        while (!atEnd() && pattern_[pos_] == '|') {
+            ++pos_;
+            branches.push_back(concatenation());
+        }
+        if (branches.size() == 1) return std::move(branches[0]);
+
+        PatternLiterals result;
+        for (const PatternLiterals& branch : branches) {
+            if (branch.op == PatternLiterals::Op::ALL) return result;
+        }
+        result.op = PatternLiterals::Op::OR;
+        result.children = std::move(branches);
+        return result;
+    }
+
+    PatternLiterals concatenation() {
+        PatternLiterals result;
+        result.op = PatternLiterals::Op::AND;
+        std::string run;
+        auto flush = [&] {
+            if (!run.empty()) result.runs.push_back(run);
+            run.clear();
+        };
+
+        while (!atEnd() && pattern_[pos_] != '|' && pattern_[pos_] != ')') {
+            int literal = -1;
+            PatternLiterals group;
+            bool isGroup = false;
+
+            char c = pattern_[pos_++];
+            if (c == '(') {
+                group = alternation();
+                if (!atEnd() && pattern_[pos_] == ')') ++pos_;
+                isGroup = true;
+            } else if (c == '[') {
+                skipClass();
+            } else if (c == '\\' && !atEnd()) {
+                char escaped = pattern_[pos_++];
+                if (escaped == 'n') literal = '\n';
+                else if (escaped == 'r') literal = '\r';
+                else if (escaped == 't') literal = '\t';
+                else if (std::strchr("dDwWsS", escaped) == nullptr) literal = static_cast<unsigned char>(escaped);
+            } else if (c != '.' && c != '^' && c != '$') {
+                literal = static_cast<unsigned char>(c);
+            }
+
+            bool optional = false, repeated = false;
+            while (!atEnd() && (pattern_[pos_] == '*' || pattern_[pos_] == '+' || pattern_[pos_] == '?')) {
+                optional = optional || pattern_[pos_] != '+';
+                repeated = true;
+                ++pos_;
+            }
+
+            if (optional) {
+                flush();
+            } else if (literal >= 0) {
+                run.push_back(static_cast<char>(literal));
+                // "ab+c" needs "ab" and "bc", with any number of b between
+                if (repeated) {
+                    flush();
+                    run.push_back(static_cast<char>(literal));
+                }
+            } else {
+                flush();
+                if (isGroup && group.op != PatternLiterals::Op::ALL) result.children.push_back(std::move(group));
+            }
+        }
+        flush();
+
+        if (result.runs.empty() && result.children.empty()) return PatternLiterals();
+        if (result.runs.empty() && result.children.size() == 1) return std::move(result.children[0]);
+        return result;
+    }
+
+    void skipClass() {
+        if (!atEnd() && pattern_[pos_] == '^') ++pos_;
+        bool first = true;
+        while (!atEnd() && (pattern_[pos_] != ']' || first)) {
+            first = false;
+            if (pattern_[pos_] == '\\') ++pos_;
+            ++pos_;
+        }
+        if (!atEnd()) ++pos_;
+    }
+};
+
+size_t shortestLength(const std::vector<std::string>& literals) {
+    if (literals.empty()) return 0;
+    size_t length = SIZE_MAX;
+    for (const std::string& literal : literals) length = std::min(length, literal.size());
+    return length;
+}
+
+void appendMatch(std::vector<ContentSearcher::Match>& matches, const std::string& path, size_t line,
+                 std::string_view lineText, size_t column, size_t length) {
+    ContentSearcher::Match match;
+    match.path = path;
+    match.line = line;
+    match.column = column;
+    match.length = length;
+    match.text.assign(lineText.data(), std::min(lineText.size(), ContentSearcher::kMaxLineText));
+    matches.push_back(std::move(match));
+}
+
+std::string_view lineAround(std::string_view data, size_t lineStart) {
+    size_t end = data.find('\n', lineStart);
+    if (end == std::string_view::npos) end = data.size();
+    if (end > lineStart && data[end - 1] == '\r') --end;
+    return data.substr(lineStart, end - lineStart);
+}
+
+} // namespace
+
+// ============================================================================
+// PatternLiterals
+// ============================================================================
+
+PatternLiterals PatternLiterals::analyze(const std::string& pattern, bool regex) {
+    if (regex) return LiteralAnalyzer(pattern).parse();
+    PatternLiterals result;
+    if (!pattern.empty()) {
+        result.op = Op::AND;
+        result.runs.push_back(pattern);
+    }
+    return result;
+}
+
+std::vector<std::string> PatternLiterals::required() const {
+    std::vector<std::string> best;
+    if (op == Op::OR) {
+        for (const PatternLiterals& child : children) {
+            std::vector<std::string> any = child.required();
+            if (any.empty()) return std::vector<std::string>();
+            best.insert(best.end(), any.begin(), any.end());
+        }
+    } else if (op == Op::AND) {
+        for (const std::string& run : runs) {
+            if (run.size() > shortestLength(best)) best.assign(1, run);
+        }
+        for (const PatternLiterals& child : children) {
+            std::vector<std::string> any = child.required();
+            if (shortestLength(any) > shortestLength(best)) best = std::move(any);
+        }
+    }
+    return best;
+}
+
+// ============================================================================
+// FileContent
+// ============================================================================
+
+bool FileContent::load(const std::string& path) {
+    mapped_.reset();
+    view_ = std::string_view();
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) size = std::ftell(file);
+    if (size < 0 || static_cast<uint64_t>(size) >= kMapThreshold) {
+        std::fclose(file);
+        mapped_ = MappedFile::open(path);
+        if (!mapped_) return false;
+        mapped_->advise(MappedFile::Access::SEQUENTIAL);
+        view_ = mapped_->view();
+        return true;
+    }
+    std::rewind(file);
+    buffer_.resize(static_cast<size_t>(size));
+    size_t read = size > 0 ? std::fread(&buffer_[0], 1, buffer_.size(), file) : 0;
+    std::fclose(file);
+    view_ = std::string_view(buffer_.data(), read);
+    return true;
+}
+
+// ============================================================================
+// ContentSearcher
+// ============================================================================
+
+ContentSearcher::ContentSearcher(const std::string& pattern, const Query& query)
+    : query_(query), valid_(true),
+      literal_(query.regex ? std::string_view() : std::string_view(pattern), query.caseSensitive) {
+    if (!query.regex) return;
+
+    regex_ = std::make_unique<RegexSearcher>(pattern, query.caseSensitive);
+    valid_ = regex_->isValid();
+    if (!valid_) {
+        error_ = regex_->getError();
+        return;
+    }
+    for (const std::string& literal : PatternLiterals::analyze(pattern, true).required()) {
+        filters_.emplace_back(literal, query.caseSensitive);
+    }
+}
+
+bool ContentSearcher::isBinary(std::string_view data) {
+    return std::memchr(data.data(), 0, std::min(data.size(), kBinaryProbe)) != nullptr;
+}
+
+void ContentSearcher::find(std::string_view data, const std::string& path, size_t limit,
+                           std::vector<Match>& matches) {
+    if (!valid_) return;
+    if (regex_) {
+        findRegex(data, path, limit, matches);
+    } else {
+        findLiteral(data, path, limit, matches);
+    }
+}
+
+void ContentSearcher::findLiteral(std::string_view data, const std::string& path, size_t limit,
+                                  std::vector<Match>& matches) {
+    size_t line = 1, lineStart = 0, counted = 0;
+    size_t at = 0;
+    while (matches.size() < limit && (at = literal_.find(data.data(), data.size(), at)) != LiteralSearcher::npos) {
+        // Count lines only up to each match
+        for (const char* nl; (nl = static_cast<const char*>(std::memchr(data.data() + counted, '\n', at - counted)));) {
+            ++line;
+            counted = static_cast<size_t>(nl - data.data()) + 1;
+            lineStart = counted;
+        }
+        counted = at;
+        appendMatch(matches, path, line, lineAround(data, lineStart), at - lineStart, literal_.size());
+        at += literal_.size();
+    }
+}
+
+void ContentSearcher::findRegex(std::string_view data, const std::string& path, size_t limit,
+                                std::vector<Match>& matches) {
+    // Next occurrence of each required literal at or after the current line
+    std::vector<size_t> next(filters_.size());
+    for (size_t k = 0; k < filters_.size(); ++k) next[k] = filters_[k].find(data.data(), data.size(), 0);
+
+    size_t line = 1, counted = 0;
+    for (size_t start = 0; start <= data.size() && matches.size() < limit;) {
+        if (!filters_.empty()) {
+            size_t hit = LiteralSearcher::npos;
+            for (size_t k = 0; k < filters_.size(); ++k) {
+                if (next[k] != LiteralSearcher::npos && next[k] < start) {
+                    next[k] = filters_[k].find(data.data(), data.size(), start);
+                }
+                hit = std::min(hit, next[k]);
+            }
+            if (hit == LiteralSearcher::npos) return;
+            for (const char* nl; (nl = static_cast<const char*>(std::memchr(data.data() + counted, '\n', hit - counted)));) {
+                ++line;
+                counted = static_cast<size_t>(nl - data.data()) + 1;
+                start = counted;
+            }
+            counted = hit;
+        }
+
+        size_t end = data.find('\n', start);
+        if (end == std::string_view::npos) end = data.size();
+        std::string_view text = lineAround(data, start);
+
+        if (matches.size() < limit) {
+            regex_->findAll(text, [&](size_t found, size_t matchEnd) {
+                appendMatch(matches, path, line, text, found, matchEnd - found);
+                return matches.size() < limit;
+            });
+        }
+
+        counted = std::max(counted, std::min(end + 1, data.size()));
+        start = end + 1;
+        ++line;
+    }
+}
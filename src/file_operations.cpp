@@ -1,67 +1,684 @@
 #include "../include/file_operations.h"
-#include <fstream>
-#include <sstream>
+#include "../include/work_stealing_pool.h"
+#include "../include/mapped_file.h"
+#include "../include/json_writer.h"
 #include <filesystem>
 #include <ctime>
-#include <iomanip>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
 
 namespace fs = std::filesystem;
 
-bool FileOperations::readFile(const std::string& path, std::string& content) {
-    try {
-        std::ifstream file(path, std::ios::binary);
-        if (!file.is_open()) {
-            return false;
+namespace {
+
+constexpr size_t kParallelStatEntries = 4096;   // smaller directories are stat'ed inline
+constexpr size_t kStatChunk = 1024;             // entries per parallel stat task
+
+// Formats times as local "YYYY-MM-DD HH:MM:SS". localtime() takes a global
+// lock and may consult the zone file on every call; here the UTC offset is
+// looked up once per hour it is needed for and the date is plain arithmetic.
+class LocalTimeFormatter {
+public:
+    std::string format(int64_t seconds) {
+        int64_t hour = floorDiv(seconds, 3600);
+        auto cached = offsets_.find(hour);
+        if (cached == offsets_.end()) cached = offsets_.emplace(hour, offsetAt(hour * 3600)).first;
+
+        int64_t local = seconds + cached->second;
+        int64_t days = floorDiv(local, 86400);
+        int64_t inDay = local - days * 86400;
+        int year, month, day;
+        civilFromDays(days, year, month, day);
+
+        char text[20];
+        writeDigits(text, year, 4);
+        text[4] = '-';
+        writeDigits(text + 5, month, 2);
+        text[7] = '-';
+        writeDigits(text + 8, day, 2);
+        text[10] = ' ';
+        writeDigits(text + 11, static_cast<int>(inDay / 3600), 2);
+        text[13] = ':';
+        writeDigits(text + 14, static_cast<int>(inDay / 60 % 60), 2);
+        text[16] = ':';
+        writeDigits(text + 17, static_cast<int>(inDay % 60), 2);
+        return std::string(text, sizeof(text) - 1);
+    }
+
+private:
+    std::unordered_map<int64_t, int32_t> offsets_;   // by hour since the epoch
+
+    static int64_t floorDiv(int64_t value, int64_t divisor) {
+        int64_t quotient = value / divisor;
+        return quotient - (value % divisor < 0 ? 1 : 0);
+    }
+
+    // Days since 1970-01-01 <-> proleptic Gregorian dates (Howard Hinnant's algorithms)
+    static int64_t daysFromCivil(int64_t year, int month, int day) {
+        year -= month <= 2;
+        int64_t era = floorDiv(year, 400);
+        int64_t yearOfEra = year - era * 400;
+        int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    static void civilFromDays(int64_t days, int& year, int& month, int& day) {
+        days += 719468;
+        int64_t era = floorDiv(days, 146097);
+        int64_t dayOfEra = days - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+        day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+        year = static_cast<int>(yearOfEra + era * 400 + (month <= 2));
+    }
+
+    static int32_t offsetAt(int64_t seconds) {
+        std::time_t time = static_cast<std::time_t>(seconds);
+        std::tm local{};
+#ifdef _WIN32
+        if (localtime_s(&local, &time) != 0) return 0;
+#else
+        if (!localtime_r(&time, &local)) return 0;
+#endif
+        int64_t asUtc = daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) * 86400 +
+                        local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+        return static_cast<int32_t>(asUtc - seconds);
+    }
+
+    static void writeDigits(char* out, int value, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
         }
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        content = buffer.str();
-        
+    }
+};
+
+std::string joinPath(const std::string& directory, const std::string& name) {
+    if (directory.empty()) return name;
+    if (directory.back() == '/' || directory.back() == '\\') return directory + name;
+    return directory + "/" + name;
+}
+
+// Runs fill(first, last) over [0, count): inline for small counts or one
+// thread, else in chunks on a pool
+template <typename Fill>
+void fillEntries(size_t count, size_t threads, const Fill& fill) {
+    if (threads == 1 || count < kParallelStatEntries) {
+        fill(size_t(0), count);
+        return;
+    }
+    HybridIDE::WorkStealingPool pool(threads);
+    for (size_t first = 0; first < count; first += kStatChunk) {
+        pool.submit([&fill, first, count] { fill(first, std::min(first + kStatChunk, count)); });
+    }
+    pool.wait();
+}
+
+#ifndef _WIN32
+
+// The getdents64 record; glibc only declares it under its own name in newer versions
+struct DirectoryRecord {
+    uint64_t inode;
+    int64_t offset;
+    unsigned short length;
+    unsigned char type;
+    char name[1];
+};
+
+struct RawEntry {
+    std::string name;
+    unsigned char type;   // DT_*
+};
+
+// Every entry but . and .., straight from getdents64
+bool readEntries(int fd, std::vector<RawEntry>& entries) {
+    alignas(8) char buffer[64 * 1024];
+    for (;;) {
+        long read = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (read < 0) return false;
+        if (read == 0) return true;
+        for (long at = 0; at < read;) {
+            const DirectoryRecord* record = reinterpret_cast<const DirectoryRecord*>(buffer + at);
+            at += record->length;
+            const char* name = record->name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            entries.push_back({name, record->type});
+        }
+    }
+}
+
+struct EntryStat {
+    bool isDirectory = false;
+    uint64_t size = 0;
+    int64_t modified = 0;
+};
+
+// Stats an entry, following symlinks like fs::is_directory. statx fetches
+// only the fields asked for; without it (old kernels, some sandboxes)
+// fstatat is used instead.
+bool statEntry(int dirFd, const char* name, bool wantSize, bool wantModified, EntryStat& out) {
+#ifdef STATX_BASIC_STATS
+    static std::atomic<bool> noStatx{false};
+    if (!noStatx.load(std::memory_order_relaxed)) {
+        unsigned int mask = STATX_TYPE;
+        if (wantSize) mask |= STATX_SIZE;
+        if (wantModified) mask |= STATX_MTIME;
+        struct statx stx;
+        if (statx(dirFd, name, AT_STATX_SYNC_AS_STAT, mask, &stx) == 0) {
+            out.isDirectory = S_ISDIR(stx.stx_mode);
+            out.size = stx.stx_size;
+            out.modified = stx.stx_mtime.tv_sec;
+            return true;
+        }
+        if (errno != ENOSYS && errno != EPERM) return false;
+        noStatx.store(true, std::memory_order_relaxed);
+    }
+#else
+    (void)wantSize;
+    (void)wantModified;
+#endif
+    struct stat st;
+    if (fstatat(dirFd, name, &st, 0) != 0) return false;
+    out.isDirectory = S_ISDIR(st.st_mode);
+    out.size = static_cast<uint64_t>(st.st_size);
+    out.modified = st.st_mtime;
+    return true;
+}
+
+#endif
+
+// Directories known to exist, so writes into them skip create_directories.
+// A directory removed behind its back is noticed when creating a file in it
+// fails, and forgotten.
+class DirectoryCache {
+public:
+    bool ensure(const std::string& directory) {
+        if (directory.empty()) return true;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (known_.count(directory)) return true;
+        }
+        std::error_code error;
+        fs::create_directories(directory, error);
+        if (error) return false;
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (known_.size() >= kMaxKnown) known_.clear();
+        known_.insert(directory);
         return true;
-    } catch (...) {
-        return false;
     }
+
+    void forget(const std::string& directory) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        known_.erase(directory);
+    }
+
+private:
+    static constexpr size_t kMaxKnown = 4096;
+
+    std::shared_mutex mutex_;
+    std::unordered_set<std::string> known_;
+};
+
+DirectoryCache& knownDirectories() {
+    static DirectoryCache cache;
+    return cache;
 }
 
-bool FileOperations::writeFile(const std::string& path, const std::string& content) {
-    try {
-        // Create parent directories if they don't exist
-        fs::path filePath(path);
-        if (filePath.has_parent_path()) {
-            fs::create_directories(filePath.parent_path());
+// Where path's name starts; path[0, at) is its directory with the separator
+size_t nameStart(const std::string& path) {
+#ifdef _WIN32
+    size_t slash = path.find_last_of("/\\");
+#else
+    size_t slash = path.rfind('/');
+#endif
+    return slash == std::string::npos ? 0 : slash + 1;
+}
+
+std::string directoryOf(const std::string& path) {
+    size_t at = nameStart(path);
+    if (at == 0) return std::string();
+    return at == 1 ? path.substr(0, 1) : path.substr(0, at - 1);
+}
+
+// A name next to path no other writer, in this process or another, uses
+std::string temporaryPath(const std::string& path) {
+    static std::atomic<uint64_t> counter{0};
+#ifdef _WIN32
+    unsigned long process = GetCurrentProcessId();
+#else
+    long process = static_cast<long>(getpid());
+#endif
+    size_t at = nameStart(path);
+    return path.substr(0, at) + "." + path.substr(at) + ".tmp" + std::to_string(process) + "-" +
+           std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+// What one write puts in the file: pieces, written in order
+struct Content {
+    const std::string_view* pieces;
+    size_t count;
+};
+
+#ifdef _WIN32
+
+bool writeAll(HANDLE file, const Content& content) {
+    bool ok = true;
+    for (size_t i = 0; ok && i < content.count; ++i) {
+        std::string_view piece = content.pieces[i];
+        for (size_t at = 0; ok && at < piece.size();) {
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(piece.size() - at, 1u << 30));
+            DWORD written = 0;
+            ok = WriteFile(file, piece.data() + at, chunk, &written, nullptr) != 0;
+            at += written;
         }
-        
-        std::ofstream file(path, std::ios::binary | std::ios::trunc);
-        if (!file.is_open()) {
-            return false;
+    }
+    return ok;
+}
+
+// Truncates path and writes content into it where it is. The file keeps
+// its hard links, but unlike a rename this is not atomic: a reader or a
+// crash can see it part-written.
+bool writeInPlace(const std::string& path, const Content& content, const FileOperations::WriteOptions& options) {
+    if (!options.allowInPlace) return false;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    bool ok = SetEndOfFile(file) != 0 && writeAll(file, content);
+    if (ok && options.durable) ok = FlushFileBuffers(file) != 0;
+    return CloseHandle(file) != 0 && ok;
+}
+
+// Whether path is a file that other hard links share
+bool hasOtherLinks(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    BY_HANDLE_FILE_INFORMATION info;
+    bool linked = GetFileInformationByHandle(file, &info) != 0 && info.nNumberOfLinks > 1;
+    CloseHandle(file);
+    return linked;
+}
+
+// Writes content to a temporary file beside path, flushes it and moves it
+// over path. A target with other hard links, or a directory the temporary
+// file cannot be created in, is written in place instead.
+bool writeAtomically(const std::string& path, const Content& content,
+                     const FileOperations::WriteOptions& options, std::string* unsyncedDirectory) {
+    (void)unsyncedDirectory;
+    std::string directory = directoryOf(path);
+    if (options.createDirectories && !knownDirectories().ensure(directory)) return false;
+    if (hasOtherLinks(path)) return writeInPlace(path, content, options);
+
+    std::string temporary = temporaryPath(path);
+    HANDLE file = CreateFileA(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE && options.createDirectories && GetLastError() == ERROR_PATH_NOT_FOUND) {
+        knownDirectories().forget(directory);
+        if (!knownDirectories().ensure(directory)) return false;
+        file = CreateFileA(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+    if (file == INVALID_HANDLE_VALUE) return writeInPlace(path, content, options);
+
+    bool ok = writeAll(file, content);
+    // Flushed before the rename even when not durable, or a crash could
+    // leave the renamed file without its content
+    ok = ok && FlushFileBuffers(file) != 0;
+    ok = CloseHandle(file) != 0 && ok;
+
+    DWORD flags = MOVEFILE_REPLACE_EXISTING | (options.durable ? MOVEFILE_WRITE_THROUGH : 0);
+    if (ok) ok = MoveFileExA(temporary.c_str(), path.c_str(), flags) != 0;
+    if (!ok) DeleteFileA(temporary.c_str());
+    return ok;
+}
+
+#else
+
+bool syncDirectoryOf(const std::string& directory) {
+    int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool writeAll(int fd, const Content& content) {
+    for (size_t i = 0; i < content.count; ++i) {
+        const char* at = content.pieces[i].data();
+        size_t left = content.pieces[i].size();
+        while (left > 0) {
+            ssize_t written = write(fd, at, left);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            at += written;
+            left -= static_cast<size_t>(written);
         }
-        
-        file << content;
-        file.close();
-        
+    }
+    return true;
+}
+
+// Truncates path and writes content into it where it is. The file keeps
+// its hard links and owner, but unlike a rename this is not atomic: a
+// reader or a crash can see it part-written.
+bool writeInPlace(const std::string& path, const Content& content, const FileOperations::WriteOptions& options) {
+    if (!options.allowInPlace) return false;
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, options.executable ? 0777 : 0666);
+    if (fd < 0) return false;
+    bool ok = true;
+    struct stat st;
+    if (options.executable) {
+        ok = fstat(fd, &st) == 0 && fchmod(fd, (st.st_mode & 07777) | ((st.st_mode & 0444) >> 2)) == 0;
+    }
+    ok = ok && writeAll(fd, content);
+    if (ok && options.durable) ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+}
+
+// A durable write syncs directory, making the new entry durable, unless
+// unsyncedDirectory is given: then the directory is stored there for the
+// caller to sync once for many files.
+bool syncIfDurable(std::string& directory, const FileOperations::WriteOptions& options,
+                   std::string* unsyncedDirectory) {
+    if (!options.durable) return true;
+    if (unsyncedDirectory) {
+        *unsyncedDirectory = std::move(directory);
         return true;
-    } catch (...) {
+    }
+    return syncDirectoryOf(directory);
+}
+
+// Writes content to a temporary file beside path, syncs it and renames it
+// over path. Where a rename would lose something the file is written in
+// place instead: a target with other hard links, one whose owner cannot be
+// given to the temporary file, or a directory the temporary file cannot be
+// created in (read-only for us, though the target is writable).
+bool writeAtomically(const std::string& path, const Content& content,
+                     const FileOperations::WriteOptions& options, std::string* unsyncedDirectory) {
+    // Renaming over a symlink would replace the link, so write to what it points at
+    std::string target = path;
+    struct stat st;
+    bool exists = lstat(path.c_str(), &st) == 0;
+    if (exists && S_ISLNK(st.st_mode)) {
+        if (char* resolved = realpath(path.c_str(), nullptr)) {
+            target = resolved;
+            std::free(resolved);
+            exists = stat(target.c_str(), &st) == 0;
+        } else {
+            exists = false;   // dangling: the link is replaced
+        }
+    }
+
+    std::string directory = directoryOf(target);
+    if (options.createDirectories && !knownDirectories().ensure(directory)) return false;
+    if (exists && S_ISREG(st.st_mode) && st.st_nlink > 1) return writeInPlace(target, content, options);
+
+    // New files get the usual 0666 / 0777 less the umask; existing ones keep their mode
+    mode_t mode = options.executable ? 0777 : 0666;
+    std::string temporary = temporaryPath(target);
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (fd < 0 && errno == ENOENT && options.createDirectories) {
+        knownDirectories().forget(directory);
+        if (!knownDirectories().ensure(directory)) return false;
+        fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    }
+    if (fd < 0) {
+        return writeInPlace(target, content, options) && (exists || syncIfDurable(directory, options, unsyncedDirectory));
+    }
+
+    bool ok = true;
+    if (exists) {
+        // Owner first: chown may clear the set-id bits that fchmod restores
+        if (st.st_uid != geteuid() || st.st_gid != getegid()) {
+            if (fchown(fd, st.st_uid, st.st_gid) != 0) {
+                close(fd);
+                unlink(temporary.c_str());
+                return writeInPlace(target, content, options);
+            }
+        }
+        mode_t kept = st.st_mode & 07777;
+        if (options.executable) kept |= (kept & 0444) >> 2;
+        ok = fchmod(fd, kept) == 0;
+    }
+    // Synced before the rename even when not durable, or a crash could
+    // leave the renamed file without its content
+    ok = ok && writeAll(fd, content) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (ok) ok = rename(temporary.c_str(), target.c_str()) == 0;
+    if (!ok) {
+        unlink(temporary.c_str());
         return false;
     }
+    return syncIfDurable(directory, options, unsyncedDirectory);
+}
+
+#endif
+
+} // namespace
+
+std::string FileView::release() {
+    std::string text;
+    if (buffer_ && buffer_.use_count() == 1 && view_.data() == buffer_->data() && view_.size() == buffer_->size()) {
+        text = std::move(*buffer_);
+    } else {
+        text.assign(view_.data(), view_.size());
+    }
+    *this = FileView();
+    return text;
+}
+
+bool FileOperations::readFile(const std::string& path, std::string& content) {
+    FileView view;
+    if (!readFile(path, view)) return false;
+    content = view.release();
+    return true;
+}
+
+bool FileOperations::readFile(const std::string& path, FileView& view, size_t mapThreshold) {
+    view = FileView();
+    std::error_code error;
+    uintmax_t size = fs::file_size(path, error);
+    if (error) size = 0;
+
+    if (size > 0 && size >= mapThreshold) {
+        view.mapped_ = HybridIDE::MappedFile::open(path);
+        if (view.mapped_) {
+            view.mapped_->advise(HybridIDE::MappedFile::Access::SEQUENTIAL);
+            view.view_ = view.mapped_->view();
+            return true;
+        }
+    }
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    auto buffer = std::make_shared<std::string>();
+    size_t read = 0;
+    if (size > 0) {
+        buffer->resize(static_cast<size_t>(size));
+        read = std::fread(&(*buffer)[0], 1, buffer->size(), file);
+    } else {
+        // No size to go by (pipes, /proc): read until the end
+        char chunk[64 * 1024];
+        for (size_t got; (got = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) buffer->append(chunk, got);
+        read = buffer->size();
+    }
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed) return false;
+
+    buffer->resize(read);
+    view.view_ = std::string_view(buffer->data(), buffer->size());
+    view.buffer_ = std::move(buffer);
+    return true;
+}
+
+bool FileOperations::writeFile(const std::string& path, const std::string& content) {
+    return writeFile(path, std::string_view(content), WriteOptions());
+}
+
+bool FileOperations::writeFile(const std::string& path, std::string_view content, const WriteOptions& options) {
+    if (path.empty()) return false;
+    return writeAtomically(path, Content{&content, 1}, options, nullptr);
+}
+
+bool FileOperations::writeFile(const std::string& path, const std::vector<std::string_view>& pieces,
+                               const WriteOptions& options) {
+    if (path.empty()) return false;
+    return writeAtomically(path, Content{pieces.data(), pieces.size()}, options, nullptr);
+}
+
+size_t FileOperations::writeFiles(const std::vector<WriteRequest>& requests, size_t threads,
+                                  std::vector<size_t>* failed) {
+    std::vector<char> written(requests.size(), 0);
+    std::vector<std::string> unsynced(requests.size());   // directories of durable writes
+    {
+        // Files are written in chunks; small files are cheap enough that a
+        // task per file would cost more than the write
+        HybridIDE::WorkStealingPool pool(threads);
+        constexpr size_t kChunk = 16;
+        for (size_t first = 0; first < requests.size(); first += kChunk) {
+            pool.submit([&requests, &written, &unsynced, first] {
+                size_t last = std::min(first + kChunk, requests.size());
+                for (size_t i = first; i < last; ++i) {
+                    const WriteRequest& request = requests[i];
+                    written[i] = !request.path.empty() &&
+                                 writeAtomically(request.path, Content{&request.content, 1}, request.options,
+                                                 &unsynced[i]);
+                }
+            });
+        }
+        pool.wait();
+    }
+
+#ifndef _WIN32
+    // Make the renames of durable writes durable, one fsync per directory
+    std::unordered_map<std::string, bool> synced;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (!written[i] || !requests[i].options.durable) continue;
+        auto directory = synced.find(unsynced[i]);
+        if (directory == synced.end()) directory = synced.emplace(unsynced[i], syncDirectoryOf(unsynced[i])).first;
+        if (!directory->second) written[i] = 0;
+    }
+#endif
+
+    size_t count = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        if (written[i]) {
+            ++count;
+        } else if (failed) {
+            failed->push_back(i);
+        }
+    }
+    return count;
 }
 
 std::vector<FileInfo> FileOperations::listDirectory(const std::string& path) {
+    return listDirectory(path, ListOptions());
+}
+
+// One pass over the directory gives names and, for almost every entry,
+// types; entries are then stat'ed only for what the caller asked for and
+// for symlinks or file systems that report no type.
+std::vector<FileInfo> FileOperations::listDirectory(const std::string& path, const ListOptions& options) {
     std::vector<FileInfo> result;
-    
+
+#ifdef _WIN32
+    // The directory entries carry type, size and time from the find data,
+    // so nothing is queried per entry; the clock offset is taken once
     try {
-        if (!fs::exists(path) || !fs::is_directory(path)) {
-            return result;
-        }
-        
-        for (const auto& entry : fs::directory_iterator(path)) {
-            FileInfo info = getFileInfo(entry.path().string());
-            result.push_back(info);
-        }
+        if (!fs::is_directory(path)) return result;
+        auto fileNow = fs::file_time_type::clock::now();
+        auto systemNow = std::chrono::system_clock::now();
+        std::vector<fs::directory_entry> entries;
+        for (const auto& entry : fs::directory_iterator(path)) entries.push_back(entry);
+
+        result.resize(entries.size());
+        fillEntries(entries.size(), options.statThreads, [&](size_t first, size_t last) {
+            LocalTimeFormatter formatter;
+            for (size_t i = first; i < last; ++i) {
+                const fs::directory_entry& entry = entries[i];
+                std::error_code error;
+                FileInfo& info = result[i];
+                info.name = entry.path().filename().string();
+                info.path = entry.path().string();
+                bool directory = entry.is_directory(error);
+                info.type = directory ? "folder" : "file";
+                info.size = 0;
+                if (options.size && !directory) {
+                    uintmax_t size = entry.file_size(error);
+                    if (!error) info.size = static_cast<long long>(size);
+                }
+                if (options.modified) {
+                    auto time = entry.last_write_time(error);
+                    if (!error) {
+                        auto system = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                            time - fileNow + systemNow);
+                        info.modified = formatter.format(std::chrono::system_clock::to_time_t(system));
+                    }
+                }
+            }
+        });
     } catch (...) {
-        // Return empty vector on error
+        result.clear();
     }
-    
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return result;
+    std::vector<RawEntry> entries;
+    bool listed = readEntries(fd, entries);
+    if (!listed) {
+        close(fd);
+        return result;
+    }
+
+    result.resize(entries.size());
+    fillEntries(entries.size(), options.statThreads, [&](size_t first, size_t last) {
+        LocalTimeFormatter formatter;
+        for (size_t i = first; i < last; ++i) {
+            const RawEntry& entry = entries[i];
+            FileInfo& info = result[i];
+            bool typeKnown = entry.type != DT_UNKNOWN && entry.type != DT_LNK;
+            bool directory = entry.type == DT_DIR;
+            info.size = 0;
+
+            bool wantSize = options.size && !(typeKnown && directory);
+            if (!typeKnown || wantSize || options.modified) {
+                EntryStat stat;
+                if (statEntry(fd, entry.name.c_str(), wantSize, options.modified, stat)) {
+                    directory = stat.isDirectory;
+                    if (options.size && !directory) info.size = static_cast<long long>(stat.size);
+                    if (options.modified) info.modified = formatter.format(stat.modified);
+                } else {
+                    directory = false;   // a dangling symlink
+                }
+            }
+            info.name = entry.name;
+            info.path = joinPath(path, entry.name);
+            info.type = directory ? "folder" : "file";
+        }
+    });
+    close(fd);
+#endif
+
     return result;
 }
 
@@ -75,6 +692,7 @@ bool FileOperations::createDirectory(const std::string& path) {
 
 bool FileOperations::deleteFile(const std::string& path) {
     try {
+        knownDirectories().forget(path);
         return fs::remove(path);
     } catch (...) {
         return false;
@@ -101,54 +719,63 @@ FileInfo FileOperations::getFileInfo(const std::string& path) {
     FileInfo info;
     info.name = fs::path(path).filename().string();
     info.path = path;
-    info.type = isDirectory(path) ? "folder" : "file";
+    info.type = "file";
     info.size = 0;
     info.modified = "";
-    
+
+#ifdef _WIN32
     try {
-        if (!isDirectory(path)) {
-            info.size = fs::file_size(path);
+        fs::directory_entry entry(path);
+        bool directory = entry.is_directory();
+        info.type = directory ? "folder" : "file";
+        if (!directory) {
+            info.size = entry.file_size();
         }
         
-        auto ftime = fs::last_write_time(path);
+        auto ftime = entry.last_write_time();
         auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
             ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now()
         );
-        auto cftime = std::chrono::system_clock::to_time_t(sctp);
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&cftime), "%Y-%m-%d %H:%M:%S");
-        info.modified = ss.str();
+        info.modified = LocalTimeFormatter().format(std::chrono::system_clock::to_time_t(sctp));
     } catch (...) {
         // Keep defaults on error
     }
+#else
+    // One stat instead of a query per field
+    EntryStat stat;
+    if (statEntry(AT_FDCWD, path.c_str(), true, true, stat)) {
+        info.type = stat.isDirectory ? "folder" : "file";
+        if (!stat.isDirectory) info.size = static_cast<long long>(stat.size);
+        info.modified = LocalTimeFormatter().format(stat.modified);
+    }
+#endif
     
     return info;
 }
 
+void FileOperations::writeFileInfo(HybridIDE::JsonWriter& json, const FileInfo& info) {
+    json.beginObject();
+    json.member("name", info.name);
+    json.member("path", info.path);
+    json.member("type", info.type);
+    json.member("size", info.size);
+    json.member("modified", info.modified);
+    json.endObject();
+}
+
 std::string FileOperations::fileInfoToJSON(const FileInfo& info) {
-    std::stringstream json;
-    json << "{";
-    json << "\"name\":\"" << info.name << "\",";
-    json << "\"path\":\"" << info.path << "\",";
-    json << "\"type\":\"" << info.type << "\",";
-    json << "\"size\":" << info.size << ",";
-    json << "\"modified\":\"" << info.modified << "\"";
-    json << "}";
-    return json.str();
+    HybridIDE::JsonWriter json;
+    writeFileInfo(json, info);
+    return json.take();
 }
 
 std::string FileOperations::fileListToJSON(const std::vector<FileInfo>& files) {
-    std::stringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < files.size(); i++) {
-        json << fileInfoToJSON(files[i]);
-        if (i < files.size() - 1) {
-            json << ",";
-        }
+    HybridIDE::JsonWriter json;
+    json.reserve(files.size() * 96);
+    json.beginArray();
+    for (const FileInfo& info : files) {
+        writeFileInfo(json, info);
     }
-    
-    json << "]";
-    return json.str();
+    json.endArray();
+    return json.take();
 }
@@ -0,0 +1,363 @@
+#include "file_tree.h"
+#include <algorithm>
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr uint32_t kEmptySlot = 0;
+
+uint64_t hashName(std::string_view name) {
+    uint64_t hash = 1469598103934665603ull;   // FNV-1a
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+FileTree::FileTree() {
+    reset("");
+}
+
+void FileTree::reset(const std::string& rootPath) {
+    parent_.clear();
+    firstChild_.clear();
+    lastChild_.clear();
+    nextSibling_.clear();
+    nameId_.clear();
+    isDirectory_.clear();
+    freeNodes_.clear();
+    names_.clear();
+    nameOffset_.clear();
+    nameLength_.clear();
+    nameTable_.assign(1024, kEmptySlot);
+    nameExtension_.clear();
+    extensionIds_.clear();
+    indexed_ = false;
+
+    parent_.push_back(kInvalid);
+    firstChild_.push_back(kInvalid);
+    lastChild_.push_back(kInvalid);
+    nextSibling_.push_back(kInvalid);
+    nameId_.push_back(intern(rootPath));
+    isDirectory_.push_back(1);
+}
+
+void FileTree::reserve(size_t nodeCount) {
+    parent_.reserve(nodeCount);
+    firstChild_.reserve(nodeCount);
+    lastChild_.reserve(nodeCount);
+    nextSibling_.reserve(nodeCount);
+    nameId_.reserve(nodeCount);
+    isDirectory_.reserve(nodeCount);
+}
+
+FileTree::NodeId FileTree::allocate(NodeId parent, std::string_view name, bool isDirectory) {
+    indexed_ = false;
+    if (!freeNodes_.empty()) {
+        NodeId id = freeNodes_.back();
+        freeNodes_.pop_back();
+        parent_[id] = parent;
+        nameId_[id] = intern(name);
+        isDirectory_[id] = isDirectory ? 1 : 0;
+        return id;
+    }
+
+    NodeId id = static_cast<NodeId>(parent_.size());
+    parent_.push_back(parent);
+    firstChild_.push_back(kInvalid);
+    lastChild_.push_back(kInvalid);
+    nextSibling_.push_back(kInvalid);
+    nameId_.push_back(intern(name));
+    isDirectory_.push_back(isDirectory ? 1 : 0);
+    return id;
+}
+
+FileTree::NodeId FileTree::addChild(NodeId parent, std::string_view name, bool isDirectory) {
+    NodeId id = allocate(parent, name, isDirectory);
+    if (lastChild_[parent] == kInvalid) {
+        firstChild_[parent] = id;
+    } else {
+        nextSibling_[lastChild_[parent]] = id;
+    }
+    lastChild_[parent] = id;
+    return id;
+}
+
+FileTree::NodeId FileTree::insertChild(NodeId parent, std::string_view name, bool isDirectory) {
+    // Sorted input (a new directory filling up) appends; children are kept
+    // ordered, so nothing before the last child can have the same name
+    NodeId last = lastChild_[parent];
+    if (last == kInvalid ||
+        (isDirectory_[last] != 0 ? (!isDirectory || this->name(last) < name)
+                                 : (!isDirectory && this->name(last) < name))) {
+        return addChild(parent, name, isDirectory);
+    }
+
+    NodeId existing = findChild(parent, name);
+    if (existing != kInvalid) return existing;
+
+    NodeId previous = kInvalid;
+    NodeId next = firstChild_[parent];
+    for (; next != kInvalid; previous = next, next = nextSibling_[next]) {
+        bool nextIsDirectory = isDirectory_[next] != 0;
+        if (nextIsDirectory != isDirectory) {
+            if (isDirectory) break;
+        } else if (name < this->name(next)) {
+            break;
+        }
+    }
+
+    NodeId id = allocate(parent, name, isDirectory);
+    nextSibling_[id] = next;
+    if (previous == kInvalid) {
+        firstChild_[parent] = id;
+    } else {
+        nextSibling_[previous] = id;
+    }
+    if (next == kInvalid) lastChild_[parent] = id;
+    return id;
+}
+
+void FileTree::remove(NodeId id) {
+    if (id == kRoot || id >= parent_.size() || parent_[id] == kInvalid) return;
+
+    NodeId parent = parent_[id];
+    NodeId previous = kInvalid;
+    for (NodeId at = firstChild_[parent]; at != id; at = nextSibling_[at]) {
+        previous = at;
+    }
+    if (previous == kInvalid) {
+        firstChild_[parent] = nextSibling_[id];
+    } else {
+        nextSibling_[previous] = nextSibling_[id];
+    }
+    if (lastChild_[parent] == id) lastChild_[parent] = previous;
+    indexed_ = false;
+
+    // Collect the subtree before its links are cleared
+    size_t firstFree = freeNodes_.size();
+    freeNodes_.push_back(id);
+    for (Node node : Subtree(this, id)) {
+        freeNodes_.push_back(node.id());
+    }
+    for (size_t i = firstFree; i < freeNodes_.size(); ++i) {
+        NodeId freed = freeNodes_[i];
+        parent_[freed] = kInvalid;
+        firstChild_[freed] = kInvalid;
+        lastChild_[freed] = kInvalid;
+        nextSibling_[freed] = kInvalid;
+    }
+}
+
+FileTree::NodeId FileTree::findChild(NodeId parent, std::string_view name) const {
+    uint32_t nameId = findName(name);
+    if (nameId == kInvalid) return kInvalid;
+    NodeId child = firstChild_[parent];
+    while (child != kInvalid && nameId_[child] != nameId) {
+        child = nextSibling_[child];
+    }
+    return child;
+}
+
+std::string_view FileTree::name(NodeId id) const {
+    uint32_t nameId = nameId_[id];
+    return std::string_view(names_.data() + nameOffset_[nameId], nameLength_[nameId]);
+}
+
+std::string FileTree::relativePath(NodeId id) const {
+    if (id == kRoot) return std::string();
+
+    // Measure first so the path is built with a single allocation
+    size_t length = 0;
+    for (NodeId at = id; at != kRoot; at = parent_[at]) {
+        length += nameLength_[nameId_[at]] + 1;
+    }
+    std::string path(length - 1, '/');
+    size_t end = path.size();
+    for (NodeId at = id; at != kRoot; at = parent_[at]) {
+        std::string_view part = name(at);
+        end -= part.size();
+        std::copy(part.begin(), part.end(), path.begin() + static_cast<std::ptrdiff_t>(end));
+        if (end > 0) --end;
+    }
+    return path;
+}
+
+std::string FileTree::path(NodeId id) const {
+    std::string rootPath(name(kRoot));
+    if (id == kRoot) return rootPath;
+    if (!rootPath.empty() && rootPath.back() != '/') rootPath += '/';
+    return rootPath + relativePath(id);
+}
+
+FileTree::NodeId FileTree::find(std::string_view relativePath) const {
+    NodeId at = kRoot;
+    size_t pos = 0;
+    while (pos < relativePath.size()) {
+        size_t slash = relativePath.find('/', pos);
+        if (slash == std::string_view::npos) slash = relativePath.size();
+        std::string_view part = relativePath.substr(pos, slash - pos);
+        pos = slash + 1;
+        if (part.empty() || part == ".") continue;
+
+        // Children are compared by interned id, so a name that was never
+        // interned cannot exist anywhere in the tree
+        at = findChild(at, part);
+        if (at == kInvalid) return kInvalid;
+    }
+    return at;
+}
+
+FileTree::Node FileTree::root() const {
+    return Node(this, kRoot);
+}
+
+FileTree::Node FileTree::node(NodeId id) const {
+    return Node(this, id);
+}
+
+FileTree::IdRange FileTree::descendants(NodeId id) const {
+    if (!indexed_) buildIndexes();
+    if (id >= parent_.size() || (id != kRoot && parent_[id] == kInvalid)) return IdRange(nullptr, nullptr);
+    const NodeId* base = order_.data();
+    uint32_t first = id == kRoot ? 0 : orderIndex_[id] + 1;
+    return IdRange(base + first, base + subtreeEnd_[id]);
+}
+
+std::vector<FileTree::NodeId> FileTree::filesWithExtension(std::string_view extension, NodeId under) const {
+    std::vector<NodeId> files;
+    auto found = extensionIds_.find(extension);
+    if (found == extensionIds_.end()) return files;
+    if (!indexed_) buildIndexes();
+    if (found->second >= extensionFiles_.size()) return files;
+
+    auto range = within(extensionFiles_[found->second], under);
+    files.reserve(static_cast<size_t>(range.second - range.first));
+    for (const uint32_t* at = range.first; at != range.second; ++at) files.push_back(order_[*at]);
+    return files;
+}
+
+std::vector<FileTree::NodeId> FileTree::directories(NodeId under) const {
+    if (!indexed_) buildIndexes();
+    std::vector<NodeId> result;
+    auto range = within(directoryOrder_, under);
+    result.reserve(static_cast<size_t>(range.second - range.first));
+    for (const uint32_t* at = range.first; at != range.second; ++at) result.push_back(order_[*at]);
+    return result;
+}
+
+std::pair<const uint32_t*, const uint32_t*> FileTree::within(const std::vector<uint32_t>& list, NodeId under) const {
+    if (under >= parent_.size() || (under != kRoot && parent_[under] == kInvalid)) {
+        return std::make_pair(nullptr, nullptr);
+    }
+    uint32_t first = under == kRoot ? 0 : orderIndex_[under] + 1;
+    const uint32_t* begin = std::lower_bound(list.data(), list.data() + list.size(), first);
+    const uint32_t* end = std::lower_bound(begin, list.data() + list.size(), subtreeEnd_[under]);
+    return std::make_pair(begin, end);
+}
+
+// One depth-first pass numbers the nodes and sorts files into their
+// extension's list; subtree ends are then filled in bottom-up, since a
+// node's subtree ends where its last descendant's does
+void FileTree::buildIndexes() const {
+    order_.clear();
+    order_.reserve(nodeCount());
+    orderIndex_.assign(parent_.size(), 0);
+    subtreeEnd_.assign(parent_.size(), 0);
+    for (std::vector<uint32_t>& files : extensionFiles_) files.clear();
+    extensionFiles_.resize(extensionIds_.size());
+    directoryOrder_.clear();
+
+    for (Node node : Subtree(this, kRoot)) {
+        NodeId id = node.id();
+        uint32_t position = static_cast<uint32_t>(order_.size());
+        orderIndex_[id] = position;
+        subtreeEnd_[id] = position + 1;
+        order_.push_back(id);
+        if (isDirectory_[id] != 0) {
+            directoryOrder_.push_back(position);
+        } else {
+            extensionFiles_[nameExtension_[nameId_[id]]].push_back(position);
+        }
+    }
+    subtreeEnd_[kRoot] = static_cast<uint32_t>(order_.size());
+    for (size_t i = order_.size(); i-- > 0;) {
+        NodeId parent = parent_[order_[i]];
+        if (parent != kRoot) subtreeEnd_[parent] = std::max(subtreeEnd_[parent], subtreeEnd_[order_[i]]);
+    }
+    indexed_ = true;
+}
+
+FileTree::Subtree::iterator& FileTree::Subtree::iterator::operator++() {
+    NodeId child = tree_->firstChild(id_);
+    if (child != kInvalid) {
+        id_ = child;
+        return *this;
+    }
+    while (id_ != top_) {
+        NodeId sibling = tree_->nextSibling(id_);
+        if (sibling != kInvalid) {
+            id_ = sibling;
+            return *this;
+        }
+        id_ = tree_->parent(id_);
+    }
+    id_ = kInvalid;
+    return *this;
+}
+
+uint32_t FileTree::findName(std::string_view name) const {
+    size_t mask = nameTable_.size() - 1;
+    for (size_t slot = hashName(name) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = nameTable_[slot];
+        if (entry == kEmptySlot) return kInvalid;
+        uint32_t nameId = entry - 1;
+        if (nameLength_[nameId] == name.size() &&
+            names_.compare(nameOffset_[nameId], nameLength_[nameId], name.data(), name.size()) == 0) {
+            return nameId;
+        }
+    }
+}
+
+uint32_t FileTree::intern(std::string_view name) {
+    uint32_t existing = findName(name);
+    if (existing != kInvalid) return existing;
+
+    if ((nameOffset_.size() + 1) * 2 > nameTable_.size()) {
+        growNameTable();
+    }
+    uint32_t nameId = static_cast<uint32_t>(nameOffset_.size());
+    nameOffset_.push_back(static_cast<uint32_t>(names_.size()));
+    nameLength_.push_back(static_cast<uint32_t>(name.size()));
+    names_.append(name.data(), name.size());
+
+    size_t dot = name.rfind('.');
+    std::string_view extension = dot == std::string_view::npos ? std::string_view() : name.substr(dot);
+    auto known = extensionIds_.find(extension);
+    if (known == extensionIds_.end()) {
+        known = extensionIds_.emplace(std::string(extension), static_cast<uint32_t>(extensionIds_.size())).first;
+    }
+    nameExtension_.push_back(known->second);
+
+    size_t mask = nameTable_.size() - 1;
+    size_t slot = hashName(name) & mask;
+    while (nameTable_[slot] != kEmptySlot) slot = (slot + 1) & mask;
+    nameTable_[slot] = nameId + 1;
+    return nameId;
+}
+
+void FileTree::growNameTable() {
+    std::vector<uint32_t> table(nameTable_.size() * 2, kEmptySlot);
+    size_t mask = table.size() - 1;
+    for (uint32_t nameId = 0; nameId < nameOffset_.size(); ++nameId) {
+        std::string_view name(names_.data() + nameOffset_[nameId], nameLength_[nameId]);
+        size_t slot = hashName(name) & mask;
+        while (table[slot] != kEmptySlot) slot = (slot + 1) & mask;
+        table[slot] = nameId + 1;
+    }
+    nameTable_.swap(table);
+}
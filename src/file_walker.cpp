@@ -0,0 +1,462 @@
+#include "file_walker.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+using namespace HybridIDE;
+
+// ============================================================================
+// IgnoreRules
+// ============================================================================
+
+namespace {
+
+bool hasWildcard(std::string_view text) {
+    return text.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+// Match a "[...]" class at the start of pattern against c. Sets length to
+// the size of the class; returns false with length 0 if it is unterminated.
+bool matchClass(std::string_view pattern, char c, size_t& length) {
+    size_t i = 1;
+    bool negate = i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^');
+    if (negate) ++i;
+
+    bool matched = false;
+    bool first = true;
+    while (i < pattern.size() && (pattern[i] != ']' || first)) {
+        first = false;
+        char low = pattern[i];
+        if (low == '\\' && i + 1 < pattern.size()) low = pattern[++i];
+        char high = low;
+        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            high = pattern[i + 2];
+            if (high == '\\' && i + 3 < pattern.size()) high = pattern[++i + 2];
+            i += 2;
+        }
+        if (c >= low && c <= high) matched = true;
+        ++i;
+    }
+    if (i >= pattern.size()) {
+        length = 0;
+        return false;
+    }
+    length = i + 1;
+    return matched != negate && c != '/';
+}
+
+} // namespace
+
+bool IgnoreRules::globMatch(std::string_view pattern, std::string_view path) {
+    size_t p = 0, s = 0;
+    while (p < pattern.size()) {
+        char c = pattern[p];
+        if (c == '*') {
+            if (p + 1 < pattern.size() && pattern[p + 1] == '*') {
+                size_t next = p + 2;
+                if (next == pattern.size()) return true;   // trailing "**" matches everything
+                if (pattern[next] == '/') {
+                    // "**/" matches zero or more whole directories
+                    std::string_view rest = pattern.substr(next + 1);
+                    for (size_t at = s;;) {
+                        if (globMatch(rest, path.substr(at))) return true;
+                        size_t slash = path.find('/', at);
+                        if (slash == std::string_view::npos) return false;
+                        at = slash + 1;
+                    }
+                }
+                std::string_view rest = pattern.substr(next);
+                for (size_t at = s; at <= path.size(); ++at) {
+                    if (globMatch(rest, path.substr(at))) return true;
+                }
+                return false;
+            }
+
+            std::string_view rest = pattern.substr(p + 1);
+            for (size_t at = s;; ++at) {
+                if (globMatch(rest, path.substr(at))) return true;
+                if (at >= path.size() || path[at] == '/') return false;
+            }
+        }
+
+        if (s >= path.size()) return false;
+        if (c == '?') {
+            if (path[s] == '/') return false;
+            ++p;
+            ++s;
+            continue;
+        }
+        if (c == '[') {
+            size_t length = 0;
+            bool matched = matchClass(pattern.substr(p), path[s], length);
+            if (length > 0) {
+                if (!matched) return false;
+                p += length;
+                ++s;
+                continue;
+            }
+            // Unterminated: a literal '['
+        }
+        if (c == '\\' && p + 1 < pattern.size()) {
+            c = pattern[++p];
+        }
+        if (c != path[s]) return false;
+        ++p;
+        ++s;
+    }
+    return s == path.size();
+}
+
+IgnoreRules::IgnoreRules(std::string_view content) {
+    add(content);
+}
+
+void IgnoreRules::add(std::string_view content) {
+    size_t pos = 0;
+    while (pos < content.size()) {
+        size_t end = content.find('\n', pos);
+        if (end == std::string_view::npos) end = content.size();
+        std::string_view line = content.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        // Trailing spaces are dropped unless escaped
+        while (!line.empty() && line.back() == ' ' &&
+               !(line.size() >= 2 && line[line.size() - 2] == '\\')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line[0] == '#') continue;
+
+        Rule rule;
+        rule.negate = line[0] == '!';
+        if (rule.negate) line.remove_prefix(1);
+        else if (line.size() >= 2 && line[0] == '\\' && (line[1] == '#' || line[1] == '!')) line.remove_prefix(1);
+
+        rule.directoryOnly = !line.empty() && line.back() == '/';
+        if (rule.directoryOnly) line.remove_suffix(1);
+        rule.anchored = line.find('/') != std::string_view::npos;
+        if (!line.empty() && line[0] == '/') line.remove_prefix(1);
+        if (line.empty()) continue;
+
+        if (!hasWildcard(line)) {
+            rule.kind = Kind::LITERAL;
+            rule.pattern = std::string(line);
+        } else if (line[0] == '*' && !rule.anchored && !hasWildcard(line.substr(1))) {
+            rule.kind = Kind::SUFFIX;   // "*.o", the common case
+            rule.pattern = std::string(line.substr(1));
+        } else {
+            rule.kind = Kind::GLOB;
+            rule.pattern = std::string(line);
+        }
+        rules_.push_back(std::move(rule));
+    }
+}
+
+IgnoreRules::Match IgnoreRules::match(std::string_view path, std::string_view name, bool isDirectory) const {
+    for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+        const Rule& rule = *it;
+        if (rule.directoryOnly && !isDirectory) continue;
+
+        std::string_view subject = rule.anchored ? path : name;
+        bool matched = false;
+        switch (rule.kind) {
+            case Kind::LITERAL:
+                matched = subject == rule.pattern;
+                break;
+            case Kind::SUFFIX:
+                matched = subject.size() >= rule.pattern.size() &&
+                          subject.compare(subject.size() - rule.pattern.size(), rule.pattern.size(),
+                                          rule.pattern) == 0;
+                break;
+            case Kind::GLOB:
+                matched = globMatch(rule.pattern, subject);
+                break;
+        }
+        if (matched) {
+            return rule.negate ? Match::INCLUDE : Match::IGNORE;
+        }
+    }
+    return Match::NONE;
+}
+
+// ============================================================================
+// FileWalker
+// ============================================================================
+
+// Ignore files in effect for a directory: its own rules, then its parent's
+struct HybridIDE::IgnoreLevel {
+    std::shared_ptr<const IgnoreLevel> parent;
+    IgnoreRules rules;
+    size_t baseLength;   // length of the relative path of the directory holding the rules
+};
+
+bool FileWalker::listDirectory(const std::string& path, std::vector<Entry>& entries) {
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileExA((path + "\\*").c_str(), FindExInfoBasic, &data,
+                                   FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) return false;
+    do {
+        const char* name = data.cFileName;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        // Reparse points (junctions, symlinks) are listed but not followed
+        bool isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) &&
+                           !(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT);
+        entries.push_back({name, isDirectory, kNoDirectory});
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+    return true;
+#else
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return false;
+    while (dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+        // Symlinks are listed but not followed, so a link cycle cannot trap the walk
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            isDirectory = fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+        }
+        entries.push_back({name, isDirectory, kNoDirectory});
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+namespace {
+
+std::string joinPath(const std::string& directory, const std::string& name) {
+    if (!directory.empty() && (directory.back() == '/' || directory.back() == '\\')) {
+        return directory + name;
+    }
+    return directory + "/" + name;
+}
+
+bool readSmallFile(const std::string& path, std::string& content) {
+    content.clear();
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamoff size = file.tellg();
+    if (size <= 0) return size == 0;
+    content.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(&content[0], size);
+    return static_cast<bool>(file);
+}
+
+struct WalkState {
+    const FileWalker::Options& options;
+    const FileWalker::Visitor& visitor;
+    WorkStealingPool pool;
+    std::atomic<uint32_t> nextId;
+    std::atomic<size_t> visited;
+
+    WalkState(const FileWalker::Options& opts, const FileWalker::Visitor& visit)
+        : options(opts), visitor(visit), pool(opts.threads), nextId(1), visited(0) {}
+};
+
+bool isIgnored(const IgnoreLevel* level, const std::string& path, std::string_view name, bool isDirectory) {
+    for (; level; level = level->parent.get()) {
+        std::string_view relative(path);
+        if (level->baseLength > 0) relative.remove_prefix(level->baseLength + 1);
+        IgnoreRules::Match match = level->rules.match(relative, name, isDirectory);
+        if (match != IgnoreRules::Match::NONE) {
+            return match == IgnoreRules::Match::IGNORE;
+        }
+    }
+    return false;
+}
+
+// Rules from one directory's ignore files layered over its parent's, or the
+// parent's level unchanged when the directory has none. Later sources win:
+// .git/info/exclude, then .gitignore, then .ignore.
+std::shared_ptr<const IgnoreLevel> loadIgnoreLevel(const std::string& absolutePath,
+                                                   const std::string& relativePath,
+                                                   bool hasExclude, bool hasGitignore, bool hasIgnore,
+                                                   std::shared_ptr<const IgnoreLevel> parent) {
+    IgnoreRules rules;
+    std::string content;
+    if (hasExclude && readSmallFile(joinPath(absolutePath, ".git/info/exclude"), content)) rules.add(content);
+    if (hasGitignore && readSmallFile(joinPath(absolutePath, ".gitignore"), content)) rules.add(content);
+    if (hasIgnore && readSmallFile(joinPath(absolutePath, ".ignore"), content)) rules.add(content);
+    if (rules.empty()) return parent;
+
+    auto level = std::make_shared<IgnoreLevel>();
+    level->parent = std::move(parent);
+    level->rules = std::move(rules);
+    level->baseLength = relativePath.size();
+    return level;
+}
+
+// Whether the walker drops an entry of a directory it lists
+bool skipEntry(const FileWalker::Options& options, const IgnoreLevel* level,
+               const std::string& entryPath, std::string_view name, bool isDirectory) {
+    if (isDirectory && (name == ".git" || name == ".hybridide")) return true;
+    if (!options.includeHidden && name[0] == '.') return true;
+    return level && isIgnored(level, entryPath, name, isDirectory);
+}
+
+void visitDirectory(WalkState& state, std::string absolutePath, std::string relativePath,
+                    uint32_t id, uint32_t parentId, std::shared_ptr<const IgnoreLevel> ignore) {
+    if (state.options.cancel && state.options.cancel->load(std::memory_order_relaxed)) return;
+    std::vector<FileWalker::Entry> raw;
+    bool listed = (state.options.lister && state.options.lister(relativePath, absolutePath, raw)) ||
+                  FileWalker::listDirectory(absolutePath, raw);
+    if (!listed && id == 0) return;
+    state.visited.fetch_add(1);
+
+    if (state.options.respectIgnoreFiles) {
+        bool hasExclude = false, hasGitignore = false, hasIgnore = false;
+        for (const FileWalker::Entry& entry : raw) {
+            if (entry.isDirectory) {
+                hasExclude = hasExclude || (id == 0 && entry.name == ".git");
+            } else {
+                hasGitignore = hasGitignore || entry.name == ".gitignore";
+                hasIgnore = hasIgnore || entry.name == ".ignore";
+            }
+        }
+        ignore = loadIgnoreLevel(absolutePath, relativePath, hasExclude, hasGitignore, hasIgnore,
+                                 std::move(ignore));
+    }
+
+    FileWalker::Directory directory;
+    directory.id = id;
+    directory.parentId = parentId;
+    directory.entries.reserve(raw.size());
+
+    std::string entryPath;
+    for (FileWalker::Entry& entry : raw) {
+        if (ignore) {
+            entryPath = relativePath.empty() ? entry.name : relativePath + "/" + entry.name;
+        }
+        if (skipEntry(state.options, ignore.get(), entryPath, entry.name, entry.isDirectory)) continue;
+        directory.entries.push_back(std::move(entry));
+    }
+
+    std::sort(directory.entries.begin(), directory.entries.end(),
+              [](const FileWalker::Entry& a, const FileWalker::Entry& b) {
+                  if (a.isDirectory != b.isDirectory) return a.isDirectory;
+                  return a.name < b.name;
+              });
+
+    // Hand subdirectories to the pool before running the visitor, so other
+    // workers can start on them right away
+    for (FileWalker::Entry& entry : directory.entries) {
+        if (!entry.isDirectory) continue;
+        entry.directoryId = state.nextId.fetch_add(1);
+        std::string childAbsolute = joinPath(absolutePath, entry.name);
+        std::string childRelative = relativePath.empty() ? entry.name : relativePath + "/" + entry.name;
+        state.pool.submit([&state, childAbsolute = std::move(childAbsolute),
+                           childRelative = std::move(childRelative), childId = entry.directoryId, id,
+                           ignore]() mutable {
+            visitDirectory(state, std::move(childAbsolute), std::move(childRelative), childId, id,
+                           std::move(ignore));
+        });
+    }
+
+    directory.path = std::move(relativePath);
+    state.visitor(directory);
+}
+
+} // namespace
+
+size_t FileWalker::walk(const std::string& root, const Options& options, const Visitor& visitor) {
+    std::string base = root;
+    while (base.size() > 1 && (base.back() == '/' || base.back() == '\\')) {
+        base.pop_back();
+    }
+
+    WalkState state(options, visitor);
+    state.pool.submit([&state, base] {
+        visitDirectory(state, base, std::string(), 0, kNoDirectory, nullptr);
+    });
+    state.pool.wait();
+    return state.visited.load();
+}
+
+std::vector<FileWalker::Directory> FileWalker::collect(const std::string& root, const Options& options) {
+    std::vector<Directory> directories;
+    std::mutex mutex;
+    walk(root, options, [&](Directory& directory) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directories.size() <= directory.id) {
+            directories.resize(directory.id + 1);
+        }
+        directories[directory.id] = std::move(directory);
+    });
+    return directories;
+}
+
+IgnoreMatcher::IgnoreMatcher(const std::string& root, const FileWalker::Options& options)
+    : root_(root), options_(options) {
+    while (root_.size() > 1 && (root_.back() == '/' || root_.back() == '\\')) {
+        root_.pop_back();
+    }
+}
+
+IgnoreMatcher::~IgnoreMatcher() = default;
+
+const IgnoreMatcher::DirectoryState& IgnoreMatcher::stateOf(const std::string& directory) {
+    auto it = directories_.find(directory);
+    if (it != directories_.end()) return it->second;
+
+    DirectoryState state{nullptr, false};
+    std::string absolutePath = directory.empty() ? root_ : joinPath(root_, directory);
+    if (directory.empty()) {
+        if (options_.respectIgnoreFiles) {
+            state.level = loadIgnoreLevel(absolutePath, directory, true, true, true, nullptr);
+        }
+    } else {
+        size_t slash = directory.rfind('/');
+        std::string parentPath = slash == std::string::npos ? std::string() : directory.substr(0, slash);
+        std::string_view name = std::string_view(directory).substr(slash == std::string::npos ? 0 : slash + 1);
+
+        // Copy out: inserting below may rehash and move the parent's entry
+        DirectoryState parent = stateOf(parentPath);
+        state.ignored = parent.ignored ||
+                        skipEntry(options_, parent.level.get(), directory, name, true);
+        state.level = parent.level;
+        if (!state.ignored && options_.respectIgnoreFiles) {
+            state.level = loadIgnoreLevel(absolutePath, directory, false, true, true, parent.level);
+        }
+    }
+    return directories_.emplace(directory, std::move(state)).first->second;
+}
+
+bool IgnoreMatcher::isIgnored(const std::string& relativePath, bool isDirectory) {
+    if (relativePath.empty()) return false;
+    size_t slash = relativePath.rfind('/');
+    std::string parentPath = slash == std::string::npos ? std::string() : relativePath.substr(0, slash);
+    std::string_view name = std::string_view(relativePath).substr(slash == std::string::npos ? 0 : slash + 1);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const DirectoryState& parent = stateOf(parentPath);
+    return parent.ignored || skipEntry(options_, parent.level.get(), relativePath, name, isDirectory);
+}
+
+void IgnoreMatcher::invalidate(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory.empty()) {
+        directories_.clear();
+        return;
+    }
+    for (auto it = directories_.begin(); it != directories_.end();) {
+        const std::string& path = it->first;
+        bool below = path.compare(0, directory.size(), directory) == 0 &&
+                     (path.size() == directory.size() || path[directory.size()] == '/');
+        it = below ? directories_.erase(it) : std::next(it);
+    }
+}
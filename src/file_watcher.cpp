@@ -0,0 +1,614 @@
+#include "file_watcher.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/inotify.h>
+#endif
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr size_t kEventBufferSize = 64 * 1024;
+
+std::string joinRelative(const std::string& directory, const std::string& name) {
+    return directory.empty() ? name : directory + "/" + name;
+}
+
+// path is directory itself or lies below it
+bool isWithin(const std::string& path, const std::string& directory) {
+    if (directory.empty()) return true;
+    return path.compare(0, directory.size(), directory) == 0 &&
+           (path.size() == directory.size() || path[directory.size()] == '/');
+}
+
+bool directoryExists(const std::string& path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+} // namespace
+
+FileWatcher::FileWatcher()
+    : backend_(Backend::INOTIFY), running_(false), overflowed_(false),
+#ifdef _WIN32
+      directoryHandle_(nullptr), stopEvent_(nullptr)
+#else
+      notifyFd_(-1), wakeFd_(-1), mountFd_(-1)
+#endif
+{
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const std::string& root, const Options& options, BatchHandler onBatch) {
+    stop();
+
+    root_ = root;
+    while (root_.size() > 1 && (root_.back() == '/' || root_.back() == '\\')) {
+        root_.pop_back();
+    }
+    options_ = options;
+    onBatch_ = std::move(onBatch);
+    ignore_ = options.filterIgnored ? std::make_unique<IgnoreMatcher>(root_, options.walk) : nullptr;
+    pending_.clear();
+    ignoreChanged_.clear();
+    overflowed_ = false;
+    backend_ = Backend::INOTIFY;
+
+#ifdef _WIN32
+    // One recursive watch on the root; the watched set only filters events
+    directoryHandle_ = CreateFileA(root_.c_str(), FILE_LIST_DIRECTORY,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                   OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (directoryHandle_ == INVALID_HANDLE_VALUE) {
+        directoryHandle_ = nullptr;
+        return false;
+    }
+    stopEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (!stopEvent_) {
+        closeHandles();
+        return false;
+    }
+#elif defined(__linux__)
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) return false;
+
+    if (options.backend == Backend::FANOTIFY) {
+        // A file system mark reports changes in every directory without
+        // per-directory watches; events carry the parent's file handle
+        // and the entry name
+        int fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_UNLIMITED_QUEUE |
+                               FAN_REPORT_DFID_NAME, O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+        uint64_t mask = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_MODIFY |
+                        FAN_CLOSE_WRITE | FAN_ONDIR;
+        char resolved[PATH_MAX];
+        if (fd >= 0 && fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, root_.c_str()) == 0 &&
+            realpath(root_.c_str(), resolved)) {
+            mountFd_ = open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        }
+        if (mountFd_ >= 0) {
+            notifyFd_ = fd;
+            realRoot_ = resolved;
+            backend_ = Backend::FANOTIFY;
+        } else if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (backend_ == Backend::INOTIFY) {
+        notifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notifyFd_ < 0) {
+            closeHandles();
+            return false;
+        }
+    }
+#else
+    return false;
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!watch("")) {
+            closeHandles();
+            return false;
+        }
+    }
+    running_ = true;
+    thread_ = std::thread(&FileWatcher::run, this);
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (!running_) return;
+    running_ = false;
+#ifdef _WIN32
+    SetEvent(stopEvent_);
+#elif defined(__linux__)
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd_, &one, sizeof(one));
+    (void)written;
+#endif
+    thread_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    unwatchBelow("");
+    closeHandles();
+    pending_.clear();
+}
+
+bool FileWatcher::addDirectory(const std::string& relativePath) {
+    if (!running_) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watch(relativePath);
+}
+
+void FileWatcher::removeDirectory(const std::string& relativePath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unwatchBelow(relativePath);
+}
+
+size_t FileWatcher::watchedDirectories() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watched_.size();
+}
+
+bool FileWatcher::watch(const std::string& relativePath) {
+    auto existing = watched_.find(relativePath);
+    int descriptor = -1;
+#if defined(__linux__)
+    if (backend_ == Backend::INOTIFY) {
+        // Always ask the kernel: a directory renamed over this path leaves
+        // the old watch on an inode that is no longer here
+        std::string path = relativePath.empty() ? root_ : root_ + "/" + relativePath;
+        descriptor = inotify_add_watch(notifyFd_, path.c_str(),
+                                       IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY |
+                                       IN_CLOSE_WRITE | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK);
+        if (descriptor < 0) return existing != watched_.end();
+        if (existing != watched_.end() && existing->second != descriptor) {
+            inotify_rm_watch(notifyFd_, existing->second);
+            watchPaths_.erase(existing->second);
+        }
+        watchPaths_[descriptor] = relativePath;
+    }
+#endif
+    if (existing == watched_.end()) {
+        watched_.emplace(relativePath, descriptor);
+    } else {
+        existing->second = descriptor;
+    }
+    return true;
+}
+
+void FileWatcher::unwatchBelow(const std::string& relativePath) {
+    auto it = watched_.lower_bound(relativePath);
+    while (it != watched_.end() && isWithin(it->first, relativePath)) {
+#if defined(__linux__)
+        if (it->second >= 0) {
+            inotify_rm_watch(notifyFd_, it->second);
+            watchPaths_.erase(it->second);
+        }
+#endif
+        it = watched_.erase(it);
+    }
+}
+
+void FileWatcher::closeHandles() {
+#ifdef _WIN32
+    if (directoryHandle_) CloseHandle(directoryHandle_);
+    if (stopEvent_) CloseHandle(stopEvent_);
+    directoryHandle_ = nullptr;
+    stopEvent_ = nullptr;
+#elif defined(__linux__)
+    if (notifyFd_ >= 0) close(notifyFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+    if (mountFd_ >= 0) close(mountFd_);
+    notifyFd_ = wakeFd_ = mountFd_ = -1;
+    handlePaths_.clear();
+#endif
+    watched_.clear();
+    watchPaths_.clear();
+}
+
+bool FileWatcher::isWatched(const std::string& directory) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watched_.count(directory) != 0;
+}
+
+int FileWatcher::flushTimeoutMs() const {
+    if (pending_.empty() && ignoreChanged_.empty() && !overflowed_) return -1;
+    Clock::time_point deadline = std::min(lastEvent_ + std::chrono::milliseconds(options_.quietMs),
+                                          firstEvent_ + std::chrono::milliseconds(options_.maxLatencyMs));
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+    return remaining <= 0 ? 0 : static_cast<int>((remaining + 999) / 1000);
+}
+
+void FileWatcher::run() {
+    std::vector<char> buffer(kEventBufferSize);
+
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+                         FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    bool reading = ReadDirectoryChangesW(directoryHandle_, buffer.data(), static_cast<DWORD>(buffer.size()),
+                                         TRUE, filter, nullptr, &overlapped, nullptr) != 0;
+    HANDLE handles[2] = {overlapped.hEvent, stopEvent_};
+
+    while (running_ && reading) {
+        int timeout = flushTimeoutMs();
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, timeout < 0 ? INFINITE : static_cast<DWORD>(timeout));
+        if (result == WAIT_OBJECT_0 + 1) break;
+        if (result == WAIT_OBJECT_0) {
+            DWORD bytes = 0;
+            if (GetOverlappedResult(directoryHandle_, &overlapped, &bytes, FALSE)) {
+                readEvents(buffer.data(), bytes);
+            }
+            ResetEvent(overlapped.hEvent);
+            reading = ReadDirectoryChangesW(directoryHandle_, buffer.data(), static_cast<DWORD>(buffer.size()),
+                                            TRUE, filter, nullptr, &overlapped, nullptr) != 0;
+        }
+        if (flushTimeoutMs() == 0) flush();
+    }
+
+    CancelIo(directoryHandle_);
+    DWORD ignored = 0;
+    GetOverlappedResult(directoryHandle_, &overlapped, &ignored, TRUE);
+    CloseHandle(overlapped.hEvent);
+#elif defined(__linux__)
+    pollfd fds[2] = {{notifyFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+    while (running_) {
+        int ready = poll(fds, 2, flushTimeoutMs());
+        if (ready < 0 && errno != EINTR) break;
+        if (ready > 0 && (fds[1].revents & POLLIN)) break;
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            // One read per wakeup, so a continuous storm still gets flushed
+            // at maxLatencyMs
+            ssize_t length = read(notifyFd_, buffer.data(), buffer.size());
+            if (length > 0) readEvents(buffer.data(), static_cast<size_t>(length));
+        }
+        if (flushTimeoutMs() == 0) flush();
+    }
+#endif
+}
+
+void FileWatcher::readEvents(const char* buffer, size_t size) {
+#ifdef _WIN32
+    if (size == 0) {
+        // The kernel buffer overflowed and the changes were discarded
+        markOverflowed();
+        return;
+    }
+
+    for (size_t offset = 0;;) {
+        const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+        int wideLength = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+        int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr);
+        std::string path(static_cast<size_t>(length), '\0');
+        WideCharToMultiByte(CP_ACP, 0, info->FileName, wideLength, &path[0], length, nullptr, nullptr);
+        std::replace(path.begin(), path.end(), '\\', '/');
+
+        size_t slash = path.rfind('/');
+        std::string directory = slash == std::string::npos ? std::string() : path.substr(0, slash);
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+        switch (info->Action) {
+            case FILE_ACTION_ADDED:
+            case FILE_ACTION_RENAMED_NEW_NAME: {
+                DWORD attributes = GetFileAttributesA((root_ + "\\" + path).c_str());
+                bool isDirectory = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+                onEvent(info->Action == FILE_ACTION_ADDED ? Pending::CREATED : Pending::MOVED_IN,
+                        directory, name, isDirectory);
+                break;
+            }
+            case FILE_ACTION_REMOVED:
+            case FILE_ACTION_RENAMED_OLD_NAME:
+                // The entry is gone; only directories we watch are known to be directories
+                onEvent(Pending::DELETED, directory, name, isWatched(path));
+                break;
+            case FILE_ACTION_MODIFIED: {
+                // Directories report MODIFIED whenever their contents change
+                DWORD attributes = GetFileAttributesA((root_ + "\\" + path).c_str());
+                if (attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                    onEvent(Pending::MODIFIED, directory, name, false);
+                }
+                break;
+            }
+        }
+
+        if (info->NextEntryOffset == 0) break;
+        offset += info->NextEntryOffset;
+    }
+#elif defined(__linux__)
+    if (backend_ == Backend::INOTIFY) {
+        for (size_t offset = 0; offset < size;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                markOverflowed();
+                continue;
+            }
+
+            std::string directory;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = watchPaths_.find(event->wd);
+                if (it == watchPaths_.end()) continue;
+                if (event->mask & IN_IGNORED) {
+                    // The directory is gone (or was unmounted); its parent reports the deletion
+                    auto watched = watched_.find(it->second);
+                    if (watched != watched_.end() && watched->second == event->wd) watched_.erase(watched);
+                    watchPaths_.erase(it);
+                    continue;
+                }
+                directory = it->second;
+            }
+            if (event->len == 0) continue;
+
+            std::string name(event->name);
+            bool isDirectory = (event->mask & IN_ISDIR) != 0;
+            if (event->mask & IN_CREATE) {
+                onEvent(Pending::CREATED, directory, name, isDirectory);
+            } else if (event->mask & IN_MOVED_TO) {
+                onEvent(Pending::MOVED_IN, directory, name, isDirectory);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                onEvent(Pending::DELETED, directory, name, isDirectory);
+            } else if (event->mask & (IN_MODIFY | IN_CLOSE_WRITE)) {
+                onEvent(Pending::MODIFIED, directory, name, isDirectory);
+            }
+        }
+        return;
+    }
+
+    // Records are packed without padding, so each is copied out before use
+    for (size_t offset = 0; offset + sizeof(fanotify_event_metadata) <= size;) {
+        fanotify_event_metadata event;
+        std::memcpy(&event, buffer + offset, sizeof(event));
+        if (event.vers != FANOTIFY_METADATA_VERSION || event.event_len < sizeof(event) ||
+            offset + event.event_len > size) {
+            break;
+        }
+        const char* record = buffer + offset;
+        offset += event.event_len;
+
+        if (event.mask & FAN_Q_OVERFLOW) {
+            markOverflowed();
+            continue;
+        }
+
+        fanotify_event_info_fid info;
+        if (event.event_len < sizeof(event) + sizeof(info) + sizeof(file_handle)) continue;
+        std::memcpy(&info, record + sizeof(event), sizeof(info));
+        if (info.hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) continue;
+
+        alignas(file_handle) unsigned char handleStorage[sizeof(file_handle) + MAX_HANDLE_SZ];
+        file_handle* handle = reinterpret_cast<file_handle*>(handleStorage);
+        const char* handleStart = record + sizeof(event) + sizeof(info);
+        std::memcpy(handle, handleStart, sizeof(file_handle));
+        size_t handleSize = sizeof(file_handle) + handle->handle_bytes;
+        if (handle->handle_bytes > MAX_HANDLE_SZ || sizeof(event) + sizeof(info) + handleSize >= event.event_len) {
+            continue;
+        }
+        std::memcpy(handleStorage, handleStart, handleSize);
+        std::string name(handleStart + handleSize);
+        if (name.empty() || name == ".") continue;
+
+        // Resolve the parent directory's handle to a root-relative path. Paths
+        // outside the root are cached as "/" so unrelated activity elsewhere
+        // on the file system costs one lookup.
+        std::string key(handleStart, handleSize);
+        auto cached = handlePaths_.find(key);
+        if (cached == handlePaths_.end()) {
+            int fd = open_by_handle_at(mountFd_, handle, O_PATH | O_CLOEXEC);
+            if (fd < 0) continue;   // already deleted; its parent reports that
+            char target[PATH_MAX];
+            ssize_t length = readlink(("/proc/self/fd/" + std::to_string(fd)).c_str(), target, sizeof(target));
+            close(fd);
+            if (length <= 0) continue;
+            std::string absolute(target, static_cast<size_t>(length));
+            if (absolute.size() > 10 && absolute.compare(absolute.size() - 10, 10, " (deleted)") == 0) continue;
+
+            std::string relative = "/";
+            if (absolute == realRoot_) {
+                relative.clear();
+            } else if (isWithin(absolute, realRoot_) || realRoot_ == "/") {
+                relative = absolute.substr(realRoot_ == "/" ? 1 : realRoot_.size() + 1);
+            }
+            cached = handlePaths_.emplace(std::move(key), std::move(relative)).first;
+        }
+        if (cached->second == "/") continue;
+        std::string directory = cached->second;
+
+        bool isDirectory = (event.mask & FAN_ONDIR) != 0;
+        bool created = (event.mask & (FAN_CREATE | FAN_MOVED_TO)) != 0;
+        bool deleted = (event.mask & (FAN_DELETE | FAN_MOVED_FROM)) != 0;
+        if (created && deleted) {
+            // Merged events lose their order; the file system tells which came last
+            struct stat st;
+            std::string path = root_ + "/" + joinRelative(directory, name);
+            onEvent(Pending::DELETED, directory, name, isDirectory);
+            if (lstat(path.c_str(), &st) == 0) {
+                onEvent(Pending::CREATED, directory, name, S_ISDIR(st.st_mode));
+            }
+        } else if (created) {
+            onEvent((event.mask & FAN_MOVED_TO) ? Pending::MOVED_IN : Pending::CREATED, directory, name, isDirectory);
+        } else if (deleted) {
+            onEvent(Pending::DELETED, directory, name, isDirectory);
+        } else if (event.mask & (FAN_MODIFY | FAN_CLOSE_WRITE)) {
+            onEvent(Pending::MODIFIED, directory, name, isDirectory);
+        }
+    }
+#else
+    (void)buffer;
+    (void)size;
+#endif
+}
+
+void FileWatcher::onEvent(Pending type, const std::string& directory, const std::string& name, bool isDirectory) {
+    if (!isWatched(directory)) return;
+
+    std::string path = joinRelative(directory, name);
+    bool ignored = false;
+    if (ignore_) {
+        if (isDirectory && type != Pending::DELETED) {
+            // Rules cached for an earlier directory of this name are stale
+            ignore_->invalidate(path);
+        } else if (!isDirectory && (name == ".gitignore" || name == ".ignore")) {
+            // Paths already reported may be ignored now and vice versa. That
+            // needs a rescan, unless the directory is new in this batch
+            // (nothing in it was reported yet) or on its way out (rm -rf).
+            ignore_->invalidate(directory);
+            auto parent = pending_.find(directory);
+            bool isNew = parent != pending_.end() &&
+                         (parent->second.type == Pending::CREATED || parent->second.type == Pending::MOVED_IN ||
+                          parent->second.type == Pending::REPLACED);
+            if (!isNew) ignoreChanged_.insert(directory);
+        }
+        ignored = ignore_->isIgnored(path, isDirectory);
+        if (ignored && !options_.reportIgnored) return;
+    }
+
+    record(type, path, isDirectory, ignored);
+
+    if (!isDirectory) return;
+    if (type == Pending::DELETED || type == Pending::MOVED_IN) {
+        // A moved directory's cached handle path (possibly "outside the
+        // root") is stale now
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (type == Pending::DELETED) unwatchBelow(path);
+#if defined(__linux__)
+        handlePaths_.clear();
+#endif
+    }
+    if (type != Pending::DELETED && options_.watchNewDirectories && !ignored) {
+        scanNewDirectory(path);
+    }
+}
+
+void FileWatcher::scanNewDirectory(const std::string& path) {
+    // Watch first, then list: anything created after the listing is
+    // reported by the new watch, anything before it by the listing
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!watch(path)) return;
+    }
+    std::vector<FileWalker::Entry> entries;
+    if (!FileWalker::listDirectory(root_ + "/" + path, entries)) return;
+    for (const FileWalker::Entry& entry : entries) {
+        if (entry.isDirectory && entry.name == ".git") continue;
+        onEvent(Pending::CREATED, path, entry.name, entry.isDirectory);
+    }
+}
+
+void FileWatcher::markOverflowed() {
+    Clock::time_point now = Clock::now();
+    if (pending_.empty() && !overflowed_) firstEvent_ = now;
+    lastEvent_ = now;
+    overflowed_ = true;
+    pending_.clear();
+}
+
+void FileWatcher::record(Pending type, const std::string& path, bool isDirectory, bool ignored) {
+    Clock::time_point now = Clock::now();
+    if (pending_.empty() && !overflowed_) firstEvent_ = now;
+    lastEvent_ = now;
+    if (overflowed_) return;   // the batch is a rescan anyway
+
+    if (type == Pending::DELETED && isDirectory) {
+        // Whatever happened inside the directory is subsumed by its deletion
+        std::string prefix = path + "/";
+        auto first = pending_.lower_bound(prefix);
+        auto last = first;
+        while (last != pending_.end() && last->first.compare(0, prefix.size(), prefix) == 0) ++last;
+        pending_.erase(first, last);
+    }
+
+    auto it = pending_.find(path);
+    if (it == pending_.end()) {
+        pending_.emplace(path, PendingChange{type, isDirectory, ignored});
+        return;
+    }
+
+    PendingChange& change = it->second;
+    switch (type) {
+        case Pending::CREATED:
+        case Pending::MOVED_IN:
+            if (change.type == Pending::DELETED || change.isDirectory != isDirectory) {
+                change.type = Pending::REPLACED;
+            } else if (change.type == Pending::CREATED) {
+                change.type = type;
+            }
+            change.isDirectory = isDirectory;
+            break;
+        case Pending::DELETED:
+            if (change.type == Pending::CREATED) {
+                pending_.erase(it);   // never existed as far as the consumer knows
+            } else {
+                change.type = Pending::DELETED;
+                change.isDirectory = isDirectory;
+            }
+            break;
+        case Pending::MODIFIED:
+        case Pending::REPLACED:
+            break;   // a created, replaced or deleted entry is not also "modified"
+    }
+}
+
+void FileWatcher::flush() {
+    for (const std::string& directory : ignoreChanged_) {
+        if (directoryExists(directory.empty() ? root_ : root_ + "/" + directory)) {
+            markOverflowed();
+            break;
+        }
+    }
+    ignoreChanged_.clear();
+
+    std::vector<Change> changes;
+    if (overflowed_) {
+        changes.push_back({ChangeType::RESCAN, std::string(), true});
+    } else {
+        changes.reserve(pending_.size());
+        for (auto& [path, change] : pending_) {
+            switch (change.type) {
+                case Pending::CREATED:
+                case Pending::MOVED_IN:
+                    changes.push_back({ChangeType::CREATED, path, change.isDirectory, change.ignored});
+                    break;
+                case Pending::DELETED:
+                    changes.push_back({ChangeType::DELETED, path, change.isDirectory, change.ignored});
+                    break;
+                case Pending::MODIFIED:
+                    changes.push_back({ChangeType::MODIFIED, path, change.isDirectory, change.ignored});
+                    break;
+                case Pending::REPLACED:
+                    changes.push_back({ChangeType::DELETED, path, change.isDirectory, change.ignored});
+                    changes.push_back({ChangeType::CREATED, path, change.isDirectory, change.ignored});
+                    break;
+            }
+        }
+    }
+    pending_.clear();
+    overflowed_ = false;
+
+    if (!changes.empty() && onBatch_) onBatch_(changes);
+}
@@ -0,0 +1,382 @@
+#include "fuzzy_finder.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+
+using namespace HybridIDE;
+
+namespace {
+
+// Alignment scores, as in fzf
+constexpr int kScoreMatch = 16;
+constexpr int kScoreGapStart = -3;
+constexpr int kScoreGapExtension = -1;
+constexpr int kBonusSeparator = 9;    // after a path separator
+constexpr int kBonusBoundary = 8;     // at the start, or after _ - . or a space
+constexpr int kBonusCamel = 7;        // lower to upper case, or letter to digit
+constexpr int kBonusConsecutive = -(kScoreGapStart + kScoreGapExtension);
+constexpr int kFirstCharMultiplier = 2;
+constexpr int kNone = INT_MIN / 4;
+
+constexpr size_t kChunkPaths = 8192;   // paths per scoring task
+
+inline char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+// a-z and 0-9 have a bit each, common separators too; everything else
+// shares the remaining bits
+inline uint64_t maskBit(char c) {
+    unsigned char u = static_cast<unsigned char>(fold(c));
+    if (u >= 'a' && u <= 'z') return uint64_t(1) << (u - 'a');
+    if (u >= '0' && u <= '9') return uint64_t(1) << (26 + u - '0');
+    switch (u) {
+        case '/': case '\\': return uint64_t(1) << 36;
+        case '.': return uint64_t(1) << 37;
+        case '_': return uint64_t(1) << 38;
+        case '-': return uint64_t(1) << 39;
+        case ' ': return uint64_t(1) << 40;
+        default: return uint64_t(1) << (41 + u % 23);
+    }
+}
+
+uint64_t maskOf(std::string_view text) {
+    uint64_t mask = 0;
+    for (char c : text) mask |= maskBit(c);
+    return mask;
+}
+
+// Character classes for the alignment bonus
+enum CharClass { kLower, kUpper, kDigit, kSeparator, kDelimiter, kOther, kClassCount };
+
+struct ClassTable {
+    uint8_t classes[256];
+    int8_t bonus[kClassCount][kClassCount];   // [class before][class here]
+
+    ClassTable() {
+        for (int c = 0; c < 256; ++c) {
+            classes[c] = (c >= 'a' && c <= 'z') ? kLower
+                       : (c >= 'A' && c <= 'Z') ? kUpper
+                       : (c >= '0' && c <= '9') ? kDigit
+                       : (c == '/' || c == '\\') ? kSeparator
+                       : (c == '_' || c == '-' || c == '.' || c == ' ') ? kDelimiter
+                       : kOther;
+        }
+        for (int before = 0; before < kClassCount; ++before) {
+            for (int here = 0; here < kClassCount; ++here) {
+                int value = 0;
+                if (here == kSeparator || here == kDelimiter) value = 0;
+                else if (before == kSeparator) value = kBonusSeparator;
+                else if (before == kDelimiter || before == kOther) value = kBonusBoundary;
+                else if (before == kLower && here == kUpper) value = kBonusCamel;
+                else if (before != kDigit && here == kDigit) value = kBonusCamel;
+                bonus[before][here] = static_cast<int8_t>(value);
+            }
+        }
+    }
+};
+
+const ClassTable kClasses;
+
+inline int bonusAt(const char* text, size_t at) {
+    if (at == 0) return kBonusBoundary;
+    return kClasses.bonus[kClasses.classes[static_cast<unsigned char>(text[at - 1])]]
+                         [kClasses.classes[static_cast<unsigned char>(text[at])]];
+}
+
+struct Scored {
+    int score;
+    uint32_t length;
+    uint32_t index;
+};
+
+// Heap order: the worst result on top
+inline bool better(const Scored& a, const Scored& b) {
+    if (a.score != b.score) return a.score > b.score;
+    if (a.length != b.length) return a.length < b.length;
+    return a.index < b.index;
+}
+
+void offer(std::vector<Scored>& heap, size_t limit, const Scored& scored) {
+    if (heap.size() < limit) {
+        heap.push_back(scored);
+        std::push_heap(heap.begin(), heap.end(), better);
+    } else if (better(scored, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = scored;
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+// Scores one query against paths. Matching runs on the folded copy of a
+// path unless the query is case-sensitive; bonuses come from the original.
+class Matcher {
+public:
+    explicit Matcher(std::string_view query) : query_(query) {}
+
+    // Whether text holds the query as a subsequence; sets the window
+    // [first, last] every alignment lies in
+    bool window(const char* text, size_t length, size_t& first, size_t& last) const {
+        const char* at = text;
+        const char* end = text + length;
+        for (size_t q = 0; q < query_.size(); ++q) {
+            at = static_cast<const char*>(std::memchr(at, query_[q], static_cast<size_t>(end - at)));
+            if (!at) return false;
+            if (q == 0) first = static_cast<size_t>(at - text);
+            ++at;
+        }
+        for (last = length - 1; text[last] != query_.back(); --last) {}
+        return true;
+    }
+
+    // Best alignment score of text (as matched) over [first, last]; with
+    // positions, also where it matched. Gives up, returning kNone, once the
+    // score cannot reach cutoff.
+    //
+    // Only cells where the row's character occurs can score, so each row
+    // is a list of those columns. A gap from column c' to c costs
+    // kScoreGapStart plus kScoreGapExtension per further column, so the
+    // best gap into c is the running best of previous[c'] -
+    // kScoreGapExtension * c' over c' <= c - 2, shifted by c.
+    int score(const char* text, const char* original, size_t first, size_t last,
+              std::vector<uint32_t>* positions, int cutoff = kNone) {
+        size_t width = last - first + 1;
+        size_t rows = query_.size();
+        const char* chars = text + first;
+
+        // Row r can only match between the earliest column the query's
+        // first r + 1 characters fit in and the latest that leaves room
+        // for the rest; cells outside could never finish an alignment
+        lo_.resize(rows);
+        hi_.resize(rows);
+        for (size_t row = 0, c = 0; row < rows; ++row, ++c) {
+            while (chars[c] != query_[row]) ++c;
+            lo_[row] = c;
+        }
+        for (size_t row = rows, c = width; row-- > 0;) {
+            while (chars[--c] != query_[row]) {}
+            hi_[row] = c;
+        }
+
+        previous_.clear();
+        int rowBest = kNone;
+        for (size_t c = lo_[0]; c <= hi_[0]; ++c) {
+            if (chars[c] != query_[0]) continue;
+            int value = kScoreMatch + bonusAt(original, first + c) * kFirstCharMultiplier;
+            previous_.push_back(Cell{static_cast<uint32_t>(c), value});
+            rowBest = std::max(rowBest, value);
+        }
+        if (positions) from_.assign(rows * width, -1);
+
+        for (size_t row = 1; row < rows; ++row) {
+            // No remaining character can add more than a match and the
+            // largest bonus
+            if (rowBest + int(rows - row) * (kScoreMatch + kBonusSeparator) < cutoff) return kNone;
+            rowBest = kNone;
+            current_.clear();
+
+            int run = kNone;        // best previous[c'] - kScoreGapExtension * c' so far
+            int runFrom = -1;
+            size_t next = 0;        // first previous cell not folded into run
+            char wanted = query_[row];
+            for (size_t c = lo_[row]; c <= hi_[row]; ++c) {
+                if (chars[c] != wanted) continue;
+                while (next < previous_.size() && previous_[next].column + 2 <= c) {
+                    int key = previous_[next].value - kScoreGapExtension * int(previous_[next].column);
+                    if (key > run) {
+                        run = key;
+                        runFrom = int(previous_[next].column);
+                    }
+                    ++next;
+                }
+
+                int bonus = bonusAt(original, first + c);
+                int best = kNone, bestFrom = -1;
+                if (next < previous_.size() && previous_[next].column + 1 == c) {
+                    best = previous_[next].value + std::max(bonus, kBonusConsecutive);
+                    bestFrom = static_cast<int>(c - 1);
+                }
+                if (runFrom >= 0) {
+                    int gap = run + kScoreGapStart + kScoreGapExtension * int(c - 2);
+                    if (gap + bonus > best) {
+                        best = gap + bonus;
+                        bestFrom = runFrom;
+                    }
+                }
+                if (bestFrom < 0) continue;
+                current_.push_back(Cell{static_cast<uint32_t>(c), best + kScoreMatch});
+                rowBest = std::max(rowBest, best + kScoreMatch);
+                if (positions) from_[row * width + c] = bestFrom;
+            }
+            previous_.swap(current_);
+        }
+
+        if (previous_.empty()) return kNone;
+        size_t end = 0;
+        for (size_t i = 1; i < previous_.size(); ++i) {
+            if (previous_[i].value > previous_[end].value) end = i;
+        }
+        if (positions) {
+            positions->resize(rows);
+            int column = static_cast<int>(previous_[end].column);
+            for (size_t row = rows; row-- > 0;) {
+                (*positions)[row] = static_cast<uint32_t>(first + column);
+                if (row > 0) column = from_[row * width + column];
+            }
+        }
+        return previous_[end].value;
+    }
+
+private:
+    // A column of a row where the row's character matched, and its score
+    struct Cell {
+        uint32_t column;
+        int value;
+    };
+
+    std::string_view query_;
+    std::vector<size_t> lo_;   // per row, the columns it can match in
+    std::vector<size_t> hi_;
+    std::vector<Cell> previous_;
+    std::vector<Cell> current_;
+    std::vector<int> from_;
+};
+
+} // namespace
+
+FuzzyFinder::FuzzyFinder(size_t threads) : threads_(threads) {
+    offsets_.push_back(0);
+}
+
+FuzzyFinder::~FuzzyFinder() = default;
+
+WorkStealingPool& FuzzyFinder::pool() {
+    if (!pool_) pool_ = std::make_unique<WorkStealingPool>(threads_);
+    return *pool_;
+}
+
+void FuzzyFinder::setPaths(const std::vector<std::string>& paths) {
+    size_t bytes = 0;
+    for (const std::string& path : paths) bytes += path.size();
+
+    text_.clear();
+    text_.reserve(bytes);
+    folded_.clear();
+    folded_.reserve(bytes);
+    offsets_.clear();
+    offsets_.reserve(paths.size() + 1);
+    masks_.clear();
+    masks_.reserve(paths.size());
+    offsets_.push_back(0);
+    for (const std::string& path : paths) {
+        text_ += path;
+        for (char c : path) folded_ += fold(c);
+        offsets_.push_back(static_cast<uint32_t>(text_.size()));
+        masks_.push_back(maskOf(path));
+    }
+
+    hasLast_ = false;
+    lastMatches_.clear();
+}
+
+std::vector<FuzzyFinder::Result> FuzzyFinder::find(std::string_view query, size_t limit) {
+    std::vector<Result> results;
+    std::string needle;
+    bool caseSensitive = false;
+    for (char c : query) {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') continue;
+        caseSensitive = caseSensitive || (c >= 'A' && c <= 'Z');
+        needle += c;
+    }
+    if (limit == 0) return results;
+
+    if (needle.empty()) {
+        for (uint32_t i = 0; i < size() && results.size() < limit; ++i) {
+            results.push_back(Result{i, 0, std::string(path(i)), {}});
+        }
+        return results;
+    }
+    if (!caseSensitive) std::transform(needle.begin(), needle.end(), needle.begin(), fold);
+
+    // The next keystroke can only narrow the previous query's matches
+    bool narrowing = hasLast_ && caseSensitive == lastCaseSensitive_ &&
+                     needle.compare(0, lastQuery_.size(), lastQuery_) == 0;
+    std::vector<uint32_t> candidates;
+    if (narrowing) candidates.swap(lastMatches_);
+    size_t count = narrowing ? candidates.size() : size();
+
+    uint64_t required = maskOf(needle);
+    size_t chunks = (count + kChunkPaths - 1) / kChunkPaths;
+    std::vector<std::vector<Scored>> heaps(chunks);
+    std::vector<std::vector<uint32_t>> matched(chunks);
+    // No path can score more than a match and the largest bonus per
+    // character. Chunks share the best of their full heaps' worst scores,
+    // since a path below any full heap cannot make the final list.
+    int bestPossible = int(needle.size()) * (kScoreMatch + kBonusSeparator) +
+                       (kFirstCharMultiplier - 1) * kBonusSeparator;
+    std::atomic<int> floor{kNone};
+    auto scoreChunk = [&](size_t chunk) {
+        Matcher matcher(needle);
+        const std::string& haystack = caseSensitive ? text_ : folded_;
+        std::vector<Scored>& heap = heaps[chunk];
+        size_t end = std::min(count, (chunk + 1) * kChunkPaths);
+        for (size_t i = chunk * kChunkPaths; i < end; ++i) {
+            uint32_t index = narrowing ? candidates[i] : static_cast<uint32_t>(i);
+            if ((masks_[index] & required) != required) continue;
+            uint32_t length = offsets_[index + 1] - offsets_[index];
+            const char* text = haystack.data() + offsets_[index];
+            size_t first = 0, last = 0;
+            if (!matcher.window(text, length, first, last)) continue;
+            matched[chunk].push_back(index);
+            // Once the heap is full, a path must at least tie its worst
+            // entry, and beat it on length if it can only tie
+            int cutoff = floor.load(std::memory_order_relaxed);
+            if (heap.size() == limit) {
+                const Scored& worst = heap.front();
+                if (bestPossible == worst.score && length >= worst.length) continue;
+                cutoff = std::max(cutoff, worst.score);
+            }
+            if (bestPossible < cutoff) continue;
+            int score = matcher.score(text, text_.data() + offsets_[index], first, last, nullptr, cutoff);
+            if (score <= kNone) continue;
+            offer(heap, limit, Scored{score, length, index});
+            if (heap.size() == limit && heap.front().score > floor.load(std::memory_order_relaxed)) {
+                floor.store(heap.front().score, std::memory_order_relaxed);
+            }
+        }
+    };
+    if (chunks == 1) {
+        scoreChunk(0);
+    } else if (chunks > 1) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            pool().submit([&scoreChunk, chunk] { scoreChunk(chunk); });
+        }
+        pool().wait();
+    }
+
+    // Chunks are in path order, so the matches stay ascending
+    lastMatches_.clear();
+    std::vector<Scored> best;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        lastMatches_.insert(lastMatches_.end(), matched[chunk].begin(), matched[chunk].end());
+        for (const Scored& scored : heaps[chunk]) offer(best, limit, scored);
+    }
+    lastQuery_ = needle;
+    lastCaseSensitive_ = caseSensitive;
+    hasLast_ = true;
+
+    std::sort(best.begin(), best.end(), better);
+    Matcher matcher(needle);
+    const std::string& haystack = caseSensitive ? text_ : folded_;
+    for (const Scored& scored : best) {
+        Result result{scored.index, scored.score, std::string(path(scored.index)), {}};
+        const char* text = haystack.data() + offsets_[scored.index];
+        size_t first = 0, last = 0;
+        matcher.window(text, scored.length, first, last);
+        matcher.score(text, result.path.data(), first, last, &result.positions);
+        results.push_back(std::move(result));
+    }
+    return results;
+}
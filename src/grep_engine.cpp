@@ -0,0 +1,231 @@
+#include "grep_engine.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr size_t kChunkFiles = 32;   // files per search task
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+struct GrepEngine::Search {
+    uint64_t id = 0;
+    std::string root;
+    std::string pattern;
+    Query query;
+    Options options;
+    BatchCallback onBatch;
+    std::thread thread;
+
+    std::atomic<bool> cancelled{false};     // deliver nothing more
+    std::atomic<bool> stopped{false};       // start no more work: cancelled or limit reached
+    std::atomic<bool> limitReached{false};
+    std::atomic<bool> finished{false};
+    std::atomic<size_t> files{0};
+    std::atomic<size_t> claimed{0};         // matches counted against maxResults
+
+    // Searchers not in use. A regex's DFA is built up as it runs, so each
+    // thread takes one back for its next chunk instead of starting over.
+    std::mutex searcherMutex;
+    std::vector<std::unique_ptr<ContentSearcher>> searchers;
+
+    // Undelivered matches; oldest is when the first of them was found (0
+    // while empty), readable without the lock
+    std::mutex deliveryMutex;
+    std::vector<Match> buffer;
+    std::atomic<int64_t> oldest{0};
+    size_t delivered = 0;
+
+    void run();
+    void searchFiles(const std::vector<std::string>& paths);
+    void add(std::vector<Match>& found);
+    void flushIfDue();
+    void flushLocked(bool done);
+};
+
+void GrepEngine::Search::run() {
+    {
+        WorkStealingPool pool(options.threads);
+        FileWalker::Options walk = options.walk;
+        walk.threads = 1;
+        walk.cancel = &stopped;
+
+        FileWalker::walk(root, walk, [&](FileWalker::Directory& directory) {
+            std::vector<std::string> chunk;
+            for (const FileWalker::Entry& entry : directory.entries) {
+                if (entry.isDirectory) continue;
+                chunk.push_back(directory.path.empty() ? entry.name : directory.path + "/" + entry.name);
+                if (chunk.size() == kChunkFiles) {
+                    pool.submit([this, paths = std::move(chunk)] { searchFiles(paths); });
+                    chunk.clear();
+                }
+            }
+            if (!chunk.empty()) pool.submit([this, paths = std::move(chunk)] { searchFiles(paths); });
+        });
+        pool.wait();
+    }
+
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    if (!cancelled.load()) flushLocked(true);
+    finished.store(true);
+}
+
+void GrepEngine::Search::searchFiles(const std::vector<std::string>& paths) {
+    if (stopped.load(std::memory_order_relaxed)) return;
+
+    std::unique_ptr<ContentSearcher> searcher;
+    {
+        std::lock_guard<std::mutex> lock(searcherMutex);
+        if (!searchers.empty()) {
+            searcher = std::move(searchers.back());
+            searchers.pop_back();
+        }
+    }
+    if (!searcher) searcher = std::make_unique<ContentSearcher>(pattern, query);
+
+    FileContent content;
+    std::vector<Match> found;
+    std::string base = root.back() == '/' || root.back() == '\\' ? root : root + "/";
+    for (const std::string& path : paths) {
+        if (stopped.load(std::memory_order_relaxed)) return;
+        if (!content.load(base + path)) continue;
+        files.fetch_add(1, std::memory_order_relaxed);
+
+        std::string_view data = content.view();
+        if (!ContentSearcher::isBinary(data)) {
+            searcher->find(data, path, query.maxResults, found);
+            if (!found.empty()) add(found);
+            found.clear();
+        }
+        flushIfDue();
+    }
+
+    std::lock_guard<std::mutex> lock(searcherMutex);
+    searchers.push_back(std::move(searcher));
+}
+
+void GrepEngine::Search::add(std::vector<Match>& found) {
+    size_t before = claimed.fetch_add(found.size());
+    if (before + found.size() >= query.maxResults) {
+        found.resize(before < query.maxResults ? query.maxResults - before : 0);
+        limitReached.store(true);
+        stopped.store(true);
+    }
+    if (found.empty()) return;
+
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    if (cancelled.load()) return;
+    if (buffer.empty()) oldest.store(nowNs(), std::memory_order_relaxed);
+    buffer.insert(buffer.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+    if (delivered == 0 || buffer.size() >= options.batchSize) flushLocked(false);
+}
+
+void GrepEngine::Search::flushIfDue() {
+    int64_t since = oldest.load(std::memory_order_relaxed);
+    if (since == 0 || nowNs() - since < int64_t(kFlushIntervalMs) * 1000000) return;
+
+    std::lock_guard<std::mutex> lock(deliveryMutex);
+    if (!cancelled.load() && !buffer.empty()) flushLocked(false);
+}
+
+void GrepEngine::Search::flushLocked(bool done) {
+    if (buffer.empty() && !done) return;
+    delivered += buffer.size();
+
+    Progress progress;
+    progress.searchId = id;
+    progress.filesSearched = files.load();
+    progress.matches = delivered;
+    progress.done = done;
+    progress.limitReached = limitReached.load();
+    onBatch(progress, buffer);
+
+    buffer.clear();
+    oldest.store(0, std::memory_order_relaxed);
+}
+
+// ============================================================================
+// GrepEngine
+// ============================================================================
+
+GrepEngine::GrepEngine() : nextId_(1) {
+}
+
+GrepEngine::~GrepEngine() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelLocked();
+    reap(true);
+}
+
+uint64_t GrepEngine::start(const std::string& root, const std::string& pattern, const Query& query,
+                           const Options& options, BatchCallback onBatch, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelLocked();
+    reap(false);
+
+    if (pattern.empty() || root.empty() || query.maxResults == 0) return 0;
+    auto searcher = std::make_unique<ContentSearcher>(pattern, query);
+    if (!searcher->isValid()) {
+        if (error) *error = searcher->getError();
+        return 0;
+    }
+
+    auto search = std::make_unique<Search>();
+    search->id = nextId_++;
+    search->root = root;
+    search->pattern = pattern;
+    search->query = query;
+    search->options = options;
+    search->options.batchSize = std::max<size_t>(options.batchSize, 1);
+    search->onBatch = std::move(onBatch);
+    search->searchers.push_back(std::move(searcher));
+    Search* running = search.get();
+    search->thread = std::thread([running] { running->run(); });
+
+    current_ = std::move(search);
+    return current_->id;
+}
+
+void GrepEngine::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelLocked();
+    reap(false);
+}
+
+void GrepEngine::wait() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_ && current_->thread.joinable()) current_->thread.join();
+}
+
+void GrepEngine::cancelLocked() {
+    if (!current_) return;
+    current_->stopped.store(true);
+    {
+        // Waits out a batch being delivered right now
+        std::lock_guard<std::mutex> delivery(current_->deliveryMutex);
+        current_->cancelled.store(true);
+    }
+    retired_.push_back(std::move(current_));
+}
+
+void GrepEngine::reap(bool block) {
+    for (auto it = retired_.begin(); it != retired_.end();) {
+        Search& search = **it;
+        if (!block && !search.finished.load()) {
+            ++it;
+            continue;
+        }
+        if (search.thread.joinable()) search.thread.join();
+        it = retired_.erase(it);
+    }
+}
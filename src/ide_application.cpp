@@ -481,7 +481,22 @@ bool IDEApplication::build() {
 
     CompileOptions options;
     options.sourceFile = filePath;
-    return compiler->compile(options, nullptr);
+
+    // With the buildDirectorySources setting, the project's other sources
+    // under the file's directory are linked in too (the tree's extension
+    // index lists them without a walk); by default the file builds alone
+    std::string project = projectExplorer->getCurrentProject();
+    if (getSetting("buildDirectorySources") == "true" && !project.empty()) {
+        fs::path file = fs::absolute(filePath).lexically_normal();
+        fs::path relative = file.parent_path().lexically_relative(fs::absolute(project).lexically_normal());
+        if (!relative.empty() && *relative.begin() != "..") {
+            std::string directory = relative == "." ? std::string() : relative.generic_string();
+            for (const std::string& source : projectExplorer->getFiles(".cpp", directory)) {
+                if (fs::absolute(source).lexically_normal() != file) options.additionalSources.push_back(source);
+            }
+        }
+    }
+    return compiler->compile(options, [](const std::string&) {});
 }
 
 bool IDEApplication::buildAndRun() {
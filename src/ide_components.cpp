@@ -1,8 +1,15 @@
 #include "ide_application.h"
+#include "file_walker.h"
+#include "file_operations.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <future>
+#include <chrono>
 
 using namespace HybridIDE;
 
@@ -10,7 +17,7 @@ using namespace HybridIDE;
 // IDEWindow Implementation
 // ============================================================================
 
-IDEWindow::IDEWindow(const WindowConfig& config) : config(config), window(nullptr), running(false) {
+IDEWindow::IDEWindow(const WindowConfig& config) : window(nullptr), config(config), running(false) {
     std::cout << "Creating IDE Window: " << config.title << std::endl;
 }
 
@@ -77,97 +84,381 @@ void IDEWindow::run() {
 // ============================================================================
 
 EditorTab::EditorTab(const std::string& filePath) 
-    : filePath(filePath), modified(false), currentLine(0), currentColumn(0) {
+    : filePath(filePath), modified(false), currentLine(0), currentColumn(0),
+      selectionStart(0), selectionEnd(0), revision(0), pendingSaveRevision(0) {
+    resetHighlighting();
 }
 
 EditorTab::~EditorTab() {
-    if (modified) {
+    if (isModified()) {
         std::cout << "Warning: File " << filePath << " has unsaved changes" << std::endl;
     }
 }
 
 bool EditorTab::open(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
+    FileView view;
+    if (!FileOperations::readFile(filePath, view, config.mmapThreshold)) {
         return false;
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    content = buffer.str();
+    if (view.mapping()) {
+        // Large file: the mapping becomes the original piece, pages fault in on demand
+        buffer.setText(view.mapping());
+    } else {
+        buffer.setText(view.release());
+    }
     this->filePath = filePath;
     modified = false;
+    selectionStart = selectionEnd = 0;
+    moveCursor(0);
+    resetHighlighting();
+    history.clear();
     
     return true;
 }
 
+// Write a buffer (or a snapshot of one) to disk, piece by piece. A mapped
+// buffer still reads from the file on disk, so it must never be truncated
+// in place: only the rename over it is allowed.
+static bool writeBuffer(const TextBuffer& buffer, const std::string& path) {
+    std::vector<std::string_view> pieces;
+    for (std::string_view chunk : buffer.view()) pieces.push_back(chunk);
+    FileOperations::WriteOptions options;
+    options.allowInPlace = !buffer.isFileBacked();
+    return FileOperations::writeFile(path, pieces, options);
+}
+
 bool EditorTab::save() {
     if (filePath.empty()) {
         return false;
     }
 
-    std::ofstream file(filePath);
-    if (!file.is_open()) {
+    if (pendingSave.valid()) {
+        pendingSave.wait();
+    }
+    if (!writeBuffer(buffer, filePath)) {
         return false;
     }
-
-    file << content;
     modified = false;
     return true;
 }
 
+std::shared_future<bool> EditorTab::saveAsync() {
+    if (filePath.empty()) {
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future().share();
+    }
+
+    // The worker writes an O(1) snapshot while editing continues. Saves are
+    // chained so an older snapshot can never land on disk after a newer one.
+    TextBuffer contents = buffer.snapshot();
+    std::shared_future<bool> previous = pendingSave;
+    std::string path = filePath;
+    pendingSave = std::async(std::launch::async, [contents, previous, path]() {
+        if (previous.valid()) {
+            previous.wait();
+        }
+        return writeBuffer(contents, path);
+    }).share();
+
+    // The tab stays modified until the write is known to have landed; see
+    // isModified()
+    pendingSaveRevision = revision;
+    return pendingSave;
+}
+
+bool EditorTab::pendingSaveCovers() const {
+    return pendingSave.valid() && revision == pendingSaveRevision &&
+           pendingSave.wait_for(std::chrono::seconds(0)) == std::future_status::ready && pendingSave.get();
+}
+
+TextBuffer EditorTab::snapshot() const {
+    return buffer.snapshot();
+}
+
 bool EditorTab::saveAs(const std::string& filePath) {
     this->filePath = filePath;
     return save();
 }
 
 bool EditorTab::close() {
-    if (modified) {
+    if (isModified()) {
         return save();
     }
     return true;
 }
 
-std::string EditorTab::getContent() const {
-    return content;
+TextBuffer::View EditorTab::getContent() const {
+    return buffer.view();
+}
+
+const TextBuffer& EditorTab::getBuffer() const {
+    return buffer;
 }
 
 void EditorTab::setContent(const std::string& content) {
-    this->content = content;
+    size_t oldEndLine = buffer.lineCount() - 1;
+    buffer.setText(content);
+    selectionStart = selectionEnd = 0;
+    moveCursor(0);
+    resetHighlighting();
+    history.clear();
     modified = true;
+    notifyChange(0, oldEndLine, buffer.lineCount() - 1);
 }
 
 void EditorTab::insertText(int line, int col, const std::string& text) {
-    // Simple implementation
-    content += text;
-    modified = true;
+    size_t offset = buffer.offsetAt(line, col);
+    history.record(offset, std::string_view(), text);
+    replaceRange(offset, offset, text);
 }
 
 void EditorTab::deleteText(int startLine, int startCol, int endLine, int endCol) {
+    size_t start = buffer.offsetAt(startLine, startCol);
+    size_t end = buffer.offsetAt(endLine, endCol);
+    if (end > start) {
+        history.record(start, buffer.substr(start, end - start), std::string_view());
+        replaceRange(start, end, std::string_view());
+    }
+}
+
+bool EditorTab::applyEdits(std::vector<TextBuffer::Edit> edits) {
+    if (edits.empty()) return true;
+
+    std::stable_sort(edits.begin(), edits.end(),
+                     [](const TextBuffer::Edit& a, const TextBuffer::Edit& b) { return a.offset < b.offset; });
+
+    size_t total = buffer.length();
+    size_t previousEnd = 0;
+    size_t removedBytes = 0;
+    for (const TextBuffer::Edit& edit : edits) {
+        if (edit.offset < previousEnd || edit.offset > total || edit.length > total - edit.offset) {
+            return false;
+        }
+        previousEnd = edit.offset + edit.length;
+        removedBytes += edit.length;
+    }
+
+    // Removed text is captured into one block so the undo entry can point at it
+    std::string removed;
+    removed.reserve(removedBytes);
+    for (const TextBuffer::Edit& edit : edits) {
+        if (edit.length == 0) continue;
+        for (std::string_view chunk : buffer.view(edit.offset, edit.length)) {
+            removed.append(chunk.data(), chunk.size());
+        }
+    }
+
+    std::vector<UndoHistory::Edit> deltas;
+    deltas.reserve(edits.size());
+    size_t position = 0;
+    for (const TextBuffer::Edit& edit : edits) {
+        deltas.push_back({edit.offset, std::string_view(removed).substr(position, edit.length), edit.text});
+        position += edit.length;
+    }
+    history.breakCoalescing();
+    history.recordBatch(deltas);
+
+    applyBatch(edits);
+    return true;
+}
+
+bool EditorTab::undo() {
+    std::vector<UndoHistory::Change> changes;
+    if (!history.undo(changes)) return false;
+    applyHistoryChanges(changes);
+    return true;
+}
+
+bool EditorTab::redo() {
+    std::vector<UndoHistory::Change> changes;
+    if (!history.redo(changes)) return false;
+    applyHistoryChanges(changes);
+    return true;
+}
+
+bool EditorTab::canUndo() const {
+    return history.canUndo();
+}
+
+bool EditorTab::canRedo() const {
+    return history.canRedo();
+}
+
+void EditorTab::setUndoMemoryLimit(size_t bytes) {
+    history.setMemoryLimit(bytes);
+}
+
+void EditorTab::setChangeCallback(std::function<void(const ChangeEvent&)> callback) {
+    changeCallback = callback;
+}
+
+unsigned long long EditorTab::getRevision() const {
+    return revision;
+}
+
+void EditorTab::applyHistoryChanges(const std::vector<UndoHistory::Change>& changes) {
+    if (changes.size() == 1) {
+        const UndoHistory::Change& change = changes.front();
+        replaceRange(change.offset, change.offset + change.eraseLength, change.insertText);
+        return;
+    }
+
+    std::vector<TextBuffer::Edit> edits;
+    edits.reserve(changes.size());
+    for (const UndoHistory::Change& change : changes) {
+        edits.push_back({change.offset, change.eraseLength, change.insertText});
+    }
+    applyBatch(edits);
+}
+
+void EditorTab::applyBatch(const std::vector<TextBuffer::Edit>& edits) {
+    const TextBuffer::Edit& first = edits.front();
+    const TextBuffer::Edit& last = edits.back();
+    int firstLine = 0, oldEndLine = 0, newEndLine = 0, column = 0;
+    buffer.positionAt(first.offset, firstLine, column);
+    buffer.positionAt(last.offset + last.length, oldEndLine, column);
+
+    long long growth = 0;
+    for (const TextBuffer::Edit& edit : edits) {
+        growth += static_cast<long long>(edit.text.size()) - static_cast<long long>(edit.length);
+    }
+    buffer.applyEdits(edits);
+
+    // One index invalidation and one notification for the whole batch
+    size_t newEnd = static_cast<size_t>(static_cast<long long>(last.offset + last.length) + growth);
+    buffer.positionAt(newEnd, newEndLine, column);
+    highlighter.applyEdit(static_cast<size_t>(firstLine), static_cast<size_t>(oldEndLine),
+                          static_cast<size_t>(newEndLine));
+    brackets.applyEdit(static_cast<size_t>(firstLine), static_cast<size_t>(oldEndLine),
+                       static_cast<size_t>(newEndLine));
+    selectionStart = selectionEnd = newEnd;
+    moveCursor(newEnd);
     modified = true;
+    notifyChange(static_cast<size_t>(firstLine), static_cast<size_t>(oldEndLine),
+                 static_cast<size_t>(newEndLine));
+}
+
+void EditorTab::notifyChange(size_t startLine, size_t oldEndLine, size_t newEndLine) {
+    ++revision;
+    if (changeCallback) {
+        changeCallback({startLine, oldEndLine, newEndLine, revision});
+    }
+}
+
+void EditorTab::replaceRange(size_t start, size_t end, std::string_view text) {
+    int firstLine = 0, lastLine = 0, column = 0;
+    buffer.positionAt(start, firstLine, column);
+    buffer.positionAt(end, lastLine, column);
+
+    if (end > start) {
+        buffer.erase(start, end - start);
+    }
+    buffer.insert(start, text);
+
+    size_t newEndLine = static_cast<size_t>(firstLine) + TextBuffer::countLineFeeds(text.data(), text.size());
+    highlighter.applyEdit(static_cast<size_t>(firstLine), static_cast<size_t>(lastLine), newEndLine);
+    brackets.applyEdit(static_cast<size_t>(firstLine), static_cast<size_t>(lastLine), newEndLine);
+    selectionStart = selectionEnd = start + text.size();
+    moveCursor(selectionEnd);
+    modified = true;
+    notifyChange(static_cast<size_t>(firstLine), static_cast<size_t>(lastLine), newEndLine);
 }
 
 std::string EditorTab::getSelectedText() const {
-    return "";
+    size_t start = std::min(selectionStart, buffer.length());
+    size_t end = std::min(selectionEnd, buffer.length());
+    return end > start ? buffer.substr(start, end - start) : "";
 }
 
 void EditorTab::selectAll() {
+    selectionStart = 0;
+    selectionEnd = buffer.length();
+    moveCursor(selectionEnd);
 }
 
 void EditorTab::selectRange(int startLine, int startCol, int endLine, int endCol) {
+    selectionStart = buffer.offsetAt(startLine, startCol);
+    selectionEnd = buffer.offsetAt(endLine, endCol);
+    if (selectionEnd < selectionStart) {
+        std::swap(selectionStart, selectionEnd);
+    }
+    moveCursor(selectionEnd);
+}
+
+void EditorTab::moveCursor(size_t offset) {
+    buffer.positionAt(offset, currentLine, currentColumn);
+}
+
+void EditorTab::resetHighlighting() {
+    highlighter.setLanguage(config.enableSyntaxHighlight ? getLanguage() : "plaintext");
+    highlighter.reset(buffer.lineCount());
+    brackets.reset(buffer.lineCount());
+}
+
+std::vector<SyntaxHighlighter::Token> EditorTab::getLineTokens(int line) {
+    if (line < 0) return {};
+    return highlighter.tokenizeLine(buffer, static_cast<size_t>(line));
+}
+
+bool EditorTab::findMatchingBracket(int line, int col, int& matchLine, int& matchCol) {
+    if (line < 0 || col < 0) return false;
+    BracketIndex::Position match;
+    if (!brackets.findMatch(buffer, highlighter, {static_cast<size_t>(line), static_cast<size_t>(col)}, match)) {
+        return false;
+    }
+    matchLine = static_cast<int>(match.line);
+    matchCol = static_cast<int>(match.column);
+    return true;
+}
+
+std::vector<BracketIndex::FoldRegion> EditorTab::getFoldRegions(int firstLine, int lastLine) {
+    if (lastLine <= firstLine || lastLine <= 0) return {};
+    return brackets.getFoldRegions(buffer, highlighter, static_cast<size_t>(std::max(firstLine, 0)),
+                                   static_cast<size_t>(lastLine));
 }
 
 std::vector<int> EditorTab::find(const std::string& text, bool caseSensitive) {
     std::vector<int> positions;
+    TextSearch::Options options;
+    options.caseSensitive = caseSensitive;
+    findStreaming(text, options, [&positions](const std::vector<TextSearch::Match>& batch) {
+        for (const auto& match : batch) {
+            positions.push_back(static_cast<int>(match.offset));
+        }
+        return true;
+    });
     return positions;
 }
 
+size_t EditorTab::findStreaming(const std::string& pattern, const TextSearch::Options& options,
+                                const TextSearch::BatchCallback& onBatch) const {
+    return TextSearch::findAll(buffer, pattern, options, onBatch);
+}
+
 int EditorTab::replaceAll(const std::string& find, const std::string& replace) {
-    return 0;
+    if (find.empty()) return 0;
+
+    // Every match becomes one edit of a single transaction
+    std::vector<TextBuffer::Edit> edits;
+    TextSearch::Options options;
+    findStreaming(find, options, [&edits, &replace](const std::vector<TextSearch::Match>& batch) {
+        for (const TextSearch::Match& match : batch) {
+            edits.push_back({match.offset, match.length, replace});
+        }
+        return true;
+    });
+
+    int count = static_cast<int>(edits.size());
+    if (count > 0) {
+        applyEdits(std::move(edits));
+    }
+    return count;
 }
 
 bool EditorTab::isModified() const {
-    return modified;
+    return modified && !pendingSaveCovers();
 }
 
 std::string EditorTab::getFilePath() const {
@@ -176,19 +467,7 @@ std::string EditorTab::getFilePath() const {
 
 std::string EditorTab::getLanguage() const {
     if (filePath.empty()) return "plaintext";
-    
-    size_t pos = filePath.rfind('.');
-    if (pos == std::string::npos) return "plaintext";
-    
-    std::string ext = filePath.substr(pos + 1);
-    if (ext == "cpp" || ext == "cc" || ext == "cxx") return "cpp";
-    if (ext == "h" || ext == "hpp") return "cpp";
-    if (ext == "js") return "javascript";
-    if (ext == "ts") return "typescript";
-    if (ext == "py") return "python";
-    if (ext == "java") return "java";
-    
-    return "plaintext";
+    return SyntaxHighlighter::languageForPath(filePath);
 }
 
 int EditorTab::getCurrentLine() const {
@@ -223,17 +502,29 @@ ProjectExplorer::ProjectExplorer() {
 }
 
 ProjectExplorer::~ProjectExplorer() {
+    stopWatching();
+    stopIndexing();
 }
 
 bool ProjectExplorer::openProject(const std::string& projectPath) {
+    bool watching = watcher && watcher->isRunning();
+    stopWatching();
     this->projectPath = projectPath;
     buildFileTree();
+    if (watching) startWatching(onChanges);
     std::cout << "Opened project: " << projectPath << std::endl;
     return true;
 }
 
 bool ProjectExplorer::closeProject() {
+    stopWatching();
+    stopIndexing();
+    grep.cancel();
+    contentIndex.close();
+    index.close();
     projectPath.clear();
+    tree.reset("");
+    finderStale = true;
     return true;
 }
 
@@ -241,26 +532,160 @@ std::string ProjectExplorer::getCurrentProject() const {
     return projectPath;
 }
 
-ProjectExplorer::FileNode ProjectExplorer::getFileTree() const {
-    return rootNode;
+const FileTree& ProjectExplorer::getFileTree() const {
+    return tree;
+}
+
+ProjectIndex& ProjectExplorer::getIndex() {
+    return index;
 }
 
-std::vector<std::string> ProjectExplorer::getFiles(const std::string& extension) const {
+// Depth-first collection of the paths of nodes accepted by the filter
+template <typename Filter>
+static void collectPaths(const FileTree& tree, const Filter& filter, std::vector<std::string>& paths) {
+    for (FileTree::Node node : tree.root().subtree()) {
+        if (filter(node)) paths.push_back(node.path());
+    }
+}
+
+std::vector<std::string> ProjectExplorer::getFiles(const std::string& extension, const std::string& directory) const {
+    std::string suffix = extension;
+    if (!suffix.empty() && suffix[0] != '.') suffix.insert(suffix.begin(), '.');
+
     std::vector<std::string> files;
+    FileTree::NodeId under = tree.find(directory);
+    if (under == FileTree::kInvalid || !tree.isDirectory(under)) return files;
+    if (suffix.empty()) {
+        for (FileTree::NodeId id : tree.descendants(under)) {
+            if (!tree.isDirectory(id)) files.push_back(tree.path(id));
+        }
+        return files;
+    }
+
+    // The index is keyed by the part after the last dot; a longer suffix
+    // (".tar.gz") narrows that list down
+    std::string_view last = std::string_view(suffix).substr(suffix.rfind('.'));
+    for (FileTree::NodeId id : tree.filesWithExtension(last, under)) {
+        std::string_view name = tree.name(id);
+        if (last.size() == suffix.size() ||
+            (name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)) {
+            files.push_back(tree.path(id));
+        }
+    }
     return files;
 }
 
 std::vector<std::string> ProjectExplorer::getDirectories() const {
     std::vector<std::string> dirs;
+    for (FileTree::NodeId id : tree.directories()) {
+        dirs.push_back(tree.path(id));
+    }
     return dirs;
 }
 
+bool ProjectExplorer::startWatching(ChangeHandler onChanges) {
+    stopWatching();
+    if (projectPath.empty()) return false;
+    this->onChanges = std::move(onChanges);
+
+    if (!watcher) watcher = std::make_unique<FileWatcher>();
+    FileWatcher::Options options;
+    options.reportIgnored = true;
+    bool started = watcher->start(std::string(tree.name(FileTree::kRoot)), options,
+                                  [this](std::vector<FileWatcher::Change>& changes) {
+        if (this->onChanges) this->onChanges(changes);
+        changes.erase(std::remove_if(changes.begin(), changes.end(),
+                                     [](const FileWatcher::Change& change) { return change.ignored; }),
+                      changes.end());
+        if (changes.empty()) return;
+
+        std::lock_guard<std::mutex> lock(changesMutex);
+        if (pendingChanges.empty()) {
+            pendingChanges.swap(changes);
+        } else {
+            pendingChanges.insert(pendingChanges.end(), std::make_move_iterator(changes.begin()),
+                                  std::make_move_iterator(changes.end()));
+        }
+    });
+    if (started) watchTree();
+    return started;
+}
+
+void ProjectExplorer::stopWatching() {
+    if (watcher) watcher->stop();
+    std::lock_guard<std::mutex> lock(changesMutex);
+    pendingChanges.clear();
+}
+
+bool ProjectExplorer::watchDirectory(const std::string& relativePath) {
+    return watcher && watcher->addDirectory(relativePath);
+}
+
+// The root is watched by start(); add every directory below it. Already
+// watched directories are skipped, so this doubles as the resync after a rescan.
+void ProjectExplorer::watchTree() {
+    for (FileTree::Node node : tree.root().subtree()) {
+        if (node.isDirectory()) watcher->addDirectory(node.relativePath());
+    }
+}
+
+size_t ProjectExplorer::applyFileChanges() {
+    std::vector<FileWatcher::Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(changesMutex);
+        changes.swap(pendingChanges);
+    }
+
+    for (const FileWatcher::Change& change : changes) {
+        if (change.type == FileWatcher::ChangeType::RESCAN) {
+            buildFileTree();
+            if (watcher && watcher->isRunning()) watchTree();
+            return changes.size();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        index.applyChanges(changes);
+    }
+    contentIndex.applyChanges(changes);
+
+    // Batches are sorted by path, so runs of changes share a parent;
+    // remember the last one instead of resolving it from the root each time
+    std::string_view parentPath;
+    FileTree::NodeId parent = FileTree::kInvalid;
+    for (const FileWatcher::Change& change : changes) {
+        std::string_view path(change.path);
+        size_t slash = path.rfind('/');
+        std::string_view directory = slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+        std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+        if (parent == FileTree::kInvalid || directory != parentPath) {
+            parentPath = directory;
+            parent = tree.find(directory);
+        }
+        if (parent == FileTree::kInvalid) continue;
+
+        if (change.type == FileWatcher::ChangeType::CREATED) {
+            tree.insertChild(parent, name, change.isDirectory);
+            finderStale = true;
+        } else if (change.type == FileWatcher::ChangeType::DELETED) {
+            FileTree::NodeId node = tree.findChild(parent, name);
+            if (node != FileTree::kInvalid) {
+                tree.remove(node);
+                finderStale = true;
+                parent = FileTree::kInvalid;   // may have been inside the removed subtree
+            }
+        }
+    }
+    return changes.size();
+}
+
 bool ProjectExplorer::createFile(const std::string& path) {
     std::ofstream file(path);
     return file.is_open();
 }
 
 bool ProjectExplorer::createDirectory(const std::string& path) {
+    (void)path;
     return true;
 }
 
@@ -274,13 +699,177 @@ bool ProjectExplorer::renameFile(const std::string& oldPath, const std::string&
 
 std::vector<std::string> ProjectExplorer::searchFiles(const std::string& pattern) const {
     std::vector<std::string> results;
+    if (pattern.empty()) return results;
+
+    // Glob patterns match the file name (or the project-relative path if
+    // they contain a '/'); anything else is a case-insensitive substring
+    if (pattern.find_first_of("*?[") != std::string::npos) {
+        bool byPath = pattern.find('/') != std::string::npos;
+        collectPaths(tree, [&](const FileTree::Node& node) {
+            if (node.isDirectory()) return false;
+            return byPath ? IgnoreRules::globMatch(pattern, node.relativePath())
+                          : IgnoreRules::globMatch(pattern, node.name());
+        }, results);
+        return results;
+    }
+
+    auto lower = [](unsigned char c) { return static_cast<char>(std::tolower(c)); };
+    std::string needle(pattern.size(), '\0');
+    std::transform(pattern.begin(), pattern.end(), needle.begin(), lower);
+    collectPaths(tree, [&](const FileTree::Node& node) {
+        std::string_view name = node.name();
+        if (node.isDirectory() || name.size() < needle.size()) return false;
+        auto it = std::search(name.begin(), name.end(), needle.begin(), needle.end(),
+                              [&](char a, char b) { return lower(static_cast<unsigned char>(a)) == b; });
+        return it != name.end();
+    }, results);
     return results;
 }
 
+bool ProjectExplorer::searchContent(const std::string& pattern, const TrigramIndex::Query& query,
+                                    std::vector<TrigramIndex::Match>& matches, std::string* error) {
+    if (contentIndexStale) {
+        if (indexer.joinable()) {
+            indexer.join();
+        } else {
+            std::vector<TrigramIndex::Document> documents = contentDocuments();
+            syncContentIndex(documents);
+        }
+        contentIndexStale = false;
+    }
+    return contentIndex.search(pattern, query, matches, error);
+}
+
+bool ProjectExplorer::prepareContentIndex() {
+    if (!contentIndexStale) return true;
+    if (indexer.joinable()) {
+        if (!indexed) return false;
+        indexer.join();
+        contentIndexStale = false;
+        return true;
+    }
+    if (projectPath.empty()) return false;
+
+    // The tree is only read here; the indexer gets its file list
+    indexed = false;
+    indexer = std::thread([this, documents = contentDocuments()]() mutable {
+        syncContentIndex(documents);
+        indexed = true;
+    });
+    return false;
+}
+
+uint64_t ProjectExplorer::streamContent(const std::string& pattern, const GrepEngine::Query& query,
+                                        GrepEngine::BatchCallback onBatch, std::string* error) {
+    if (projectPath.empty()) {
+        grep.cancel();
+        return 0;
+    }
+    return grep.start(projectPath, pattern, query, GrepEngine::Options(), std::move(onBatch), error);
+}
+
+void ProjectExplorer::cancelContentSearch() {
+    grep.cancel();
+}
+
+std::vector<FuzzyFinder::Result> ProjectExplorer::quickOpen(const std::string& query, size_t limit) {
+    if (finderStale) {
+        std::vector<std::string> paths;
+        for (FileTree::Node node : tree.root().subtree()) {
+            if (!node.isDirectory()) paths.push_back(node.relativePath());
+        }
+        finder.setPaths(paths);
+        finderStale = false;
+    }
+    return finder.find(query, limit);
+}
+
+std::vector<TrigramIndex::Document> ProjectExplorer::contentDocuments() const {
+    std::vector<TrigramIndex::Document> documents;
+    for (FileTree::Node node : tree.root().subtree()) {
+        if (node.isDirectory()) continue;
+        TrigramIndex::Document document;
+        document.path = node.relativePath();
+        documents.push_back(std::move(document));
+    }
+    return documents;
+}
+
+// Make the content index cover these files. Each file is stat'ed
+// (fileInfo()): one edited in place leaves its directory's mtime, and so
+// its recorded hash, unchanged. Files whose hash matches the one they were
+// indexed with are not read again, so after the first search of a session
+// only changed files cost anything.
+void ProjectExplorer::syncContentIndex(std::vector<TrigramIndex::Document>& documents) {
+    ProjectIndex::FileInfo info;
+    for (TrigramIndex::Document& document : documents) {
+        if (cancelIndexing) return;
+        std::lock_guard<std::mutex> lock(indexMutex);
+        document.hasHash = index.fileInfo(document.path, info);
+        document.hash = info.hash;
+    }
+    contentIndex.update(documents);
+    contentIndex.save();
+    std::lock_guard<std::mutex> lock(indexMutex);
+    index.save();
+}
+
+// Waits for a running indexer; it stops early if still hashing
+void ProjectExplorer::stopIndexing() {
+    if (!indexer.joinable()) return;
+    cancelIndexing = true;
+    indexer.join();
+    cancelIndexing = false;
+}
+
 void ProjectExplorer::buildFileTree() {
-    rootNode.name = projectPath;
-    rootNode.path = projectPath;
-    rootNode.isDirectory = true;
+    std::string root = projectPath;
+    while (root.size() > 1 && (root.back() == '/' || root.back() == '\\')) {
+        root.pop_back();
+    }
+
+    grep.cancel();
+    stopIndexing();
+    tree.reset(root);
+    finderStale = true;
+    if (root.empty()) {
+        contentIndex.close();
+        index.close();
+        return;
+    }
+
+    // Directories unchanged since the last session come from the index
+    // instead of being read again. Files are hashed by fileInfo() when a
+    // hash is first needed, not all of them before the tree is usable.
+    ProjectIndex::Options indexOptions;
+    indexOptions.hashContents = false;
+    std::vector<FileWalker::Directory> directories = index.open(root, indexOptions);
+    index.save();
+    contentIndex.open(root, TrigramIndex::Options());
+    contentIndexStale = true;
+    if (directories.empty()) return;
+
+    size_t entryCount = 1;
+    for (const FileWalker::Directory& directory : directories) {
+        entryCount += directory.entries.size();
+    }
+    tree.reserve(entryCount);
+
+    // A directory's id is always larger than its parent's, so visiting ids in
+    // order creates every directory's node before its own entries are added
+    std::vector<FileTree::NodeId> nodes(directories.size(), FileTree::kInvalid);
+    nodes[0] = FileTree::kRoot;
+    for (const FileWalker::Directory& directory : directories) {
+        FileTree::NodeId parent = nodes[directory.id];
+        if (parent == FileTree::kInvalid) continue;
+
+        for (const FileWalker::Entry& entry : directory.entries) {
+            FileTree::NodeId id = tree.addChild(parent, entry.name, entry.isDirectory);
+            if (entry.directoryId != FileWalker::kNoDirectory) {
+                nodes[entry.directoryId] = id;
+            }
+        }
+    }
 }
 
 // ============================================================================
@@ -366,6 +955,7 @@ std::string AIAssistant::refactorCode(const std::string& code, const std::string
 }
 
 std::string AIAssistant::explainCode(const std::string& code) {
+    (void)code;
     return "Code explanation: This code performs various operations.";
 }
 
@@ -374,6 +964,7 @@ std::string AIAssistant::fixCode(const std::string& code, const std::string& err
 }
 
 AIAssistant::CodeReview AIAssistant::reviewCode(const std::string& code) {
+    (void)code;
     CodeReview review;
     review.score = 85;
     review.issues.push_back("Consider adding error handling");
@@ -382,9 +973,19 @@ AIAssistant::CodeReview AIAssistant::reviewCode(const std::string& code) {
     return review;
 }
 
+std::string AIAssistant::explainCode(const TextBuffer& snapshot) {
+    return explainCode(snapshot.toString());
+}
+
+AIAssistant::CodeReview AIAssistant::reviewCode(const TextBuffer& snapshot) {
+    return reviewCode(snapshot.toString());
+}
+
 void AIAssistant::setAPIKey(const std::string& key) {
+    (void)key;
     client->initialize();
 }
 
 void AIAssistant::setModel(const std::string& model) {
+    (void)model;
 }
@@ -0,0 +1,430 @@
+#include "json_reader.h"
+#include <charconv>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+constexpr size_t kBlock = 64;
+
+inline int ctz64(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+// Bit i set where byte i of a 64-byte block is of each class
+struct Classes {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t structural = 0;   // { } [ ] : ,
+    uint64_t whitespace = 0;
+};
+
+#if defined(__AVX2__)
+inline Classes classify(const char* p) {
+    Classes classes;
+    for (int half = 0; half < 2; ++half) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + half * 32));
+        // '[' and ']' are '{' and '}' less 0x20
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                            _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        int shift = half * 32;
+        auto bits = [](__m256i mask) { return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(mask))); };
+        classes.quote |= bits(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << shift;
+        classes.backslash |= bits(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << shift;
+        classes.structural |= bits(structural) << shift;
+        classes.whitespace |= bits(whitespace) << shift;
+    }
+    return classes;
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+inline Classes classify(const char* p) {
+    Classes classes;
+    for (int quarter = 0; quarter < 4; ++quarter) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + quarter * 16));
+        // '[' and ']' are '{' and '}' less 0x20
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        int shift = quarter * 16;
+        auto bits = [](__m128i mask) { return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(mask))); };
+        classes.quote |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+        classes.backslash |= bits(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+        classes.structural |= bits(structural) << shift;
+        classes.whitespace |= bits(whitespace) << shift;
+    }
+    return classes;
+}
+#else
+inline Classes classify(const char* p) {
+    Classes classes;
+    for (size_t i = 0; i < kBlock; ++i) {
+        uint64_t bit = uint64_t(1) << i;
+        switch (p[i]) {
+            case '"': classes.quote |= bit; break;
+            case '\\': classes.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': classes.structural |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': classes.whitespace |= bit; break;
+            default: break;
+        }
+    }
+    return classes;
+}
+#endif
+
+// Bit i set where an odd number of the bits 0..i are set
+inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Bytes escaped by a backslash. A backslash escapes the next byte unless
+// it is escaped itself; carry says byte 0 is escaped by the block before.
+inline uint64_t escapedBytes(uint64_t backslash, uint64_t& carry) {
+    uint64_t escaped = carry;
+    backslash &= ~carry;
+    carry = 0;
+    while (backslash) {
+        int i = ctz64(backslash);
+        if (i == 63) {
+            carry = 1;
+            break;
+        }
+        escaped |= uint64_t(1) << (i + 1);
+        backslash &= ~(uint64_t(3) << i);
+    }
+    return escaped;
+}
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Append a code point as UTF-8
+void appendUTF8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Four hex digits at p, or -1
+int32_t hex4(const char* p, const char* end) {
+    if (end - p < 4) return -1;
+    uint32_t code = 0;
+    auto result = std::from_chars(p, p + 4, code, 16);
+    return result.ec == std::errc() && result.ptr == p + 4 ? static_cast<int32_t>(code) : -1;
+}
+
+} // namespace
+
+// ============================================================================
+// JsonDocument
+// ============================================================================
+
+JsonDocument::JsonDocument(std::string_view text) : text_(text) {
+    // Offsets are 32-bit
+    if (text_.size() >= UINT32_MAX) return;
+    index();
+    valid_ = valid_ && matchBrackets();
+}
+
+void JsonDocument::index() {
+    uint64_t escapeCarry = 0;
+    uint64_t inString = 0;      // all ones while a string runs past a block
+    uint64_t scalarCarry = 0;   // the block before ended inside a scalar
+
+    for (size_t base = 0; base < text_.size(); base += kBlock) {
+        const char* block = text_.data() + base;
+        char tail[kBlock];
+        if (text_.size() - base < kBlock) {
+            // The last block is padded with whitespace
+            std::memset(tail, ' ', kBlock);
+            std::memcpy(tail, block, text_.size() - base);
+            block = tail;
+        }
+
+        Classes classes = classify(block);
+        uint64_t quotes = classes.quote & ~escapedBytes(classes.backslash, escapeCarry);
+        // Set from an opening quote up to, not including, its closing quote
+        uint64_t strings = prefixXor(quotes) ^ inString;
+        inString = static_cast<uint64_t>(static_cast<int64_t>(strings) >> 63);
+
+        uint64_t scalars = ~(classes.structural | classes.whitespace | quotes | strings);
+        uint64_t tokens = (classes.structural & ~strings) | (quotes & strings) |
+                          (scalars & ~((scalars << 1) | scalarCarry));
+        scalarCarry = scalars >> 63;
+
+        while (tokens) {
+            tokens_.push_back(static_cast<uint32_t>(base + ctz64(tokens)));
+            tokens &= tokens - 1;
+        }
+    }
+
+    valid_ = !tokens_.empty() && !inString;
+}
+
+bool JsonDocument::matchBrackets() {
+    closes_.assign(tokens_.size(), 0);
+    std::vector<uint32_t> open;
+    for (uint32_t token = 0; token < tokens_.size(); ++token) {
+        char c = at(token);
+        if (c == '{' || c == '[') {
+            open.push_back(token);
+        } else if (c == '}' || c == ']') {
+            if (open.empty() || at(open.back()) != (c == '}' ? '{' : '[')) return false;
+            closes_[open.back()] = token;
+            open.pop_back();
+        }
+    }
+    // One value, and nothing after it
+    return open.empty() && JsonValue(this, 0).following() == tokens_.size();
+}
+
+void JsonDocument::unescape(std::string_view escaped, std::string& out) {
+    out.reserve(out.size() + escaped.size());
+    const char* p = escaped.data();
+    const char* end = p + escaped.size();
+    while (p < end) {
+        const char* backslash = static_cast<const char*>(std::memchr(p, '\\', static_cast<size_t>(end - p)));
+        if (!backslash) {
+            out.append(p, static_cast<size_t>(end - p));
+            break;
+        }
+        out.append(p, static_cast<size_t>(backslash - p));
+        p = backslash + 1;
+        if (p == end) break;
+
+        char c = *p++;
+        switch (c) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                int32_t code = hex4(p, end);
+                if (code < 0) {
+                    out += c;
+                    break;
+                }
+                p += 4;
+                // Code points past the BMP arrive as a surrogate pair
+                if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    int32_t low = hex4(p + 2, end);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                appendUTF8(out, static_cast<uint32_t>(code));
+                break;
+            }
+            default: out += c; break;   // \" \\ \/
+        }
+    }
+}
+
+// ============================================================================
+// JsonValue
+// ============================================================================
+
+char JsonValue::first() const {
+    return document_->at(token_);
+}
+
+uint32_t JsonValue::following() const {
+    char c = first();
+    return c == '{' || c == '[' ? document_->closes_[token_] + 1 : token_ + 1;
+}
+
+JsonValue::Type JsonValue::type() const {
+    if (!document_) return Type::MISSING;
+    switch (first()) {
+        case '{': return Type::OBJECT;
+        case '[': return Type::ARRAY;
+        case '"': return Type::STRING;
+        case 't': case 'f': return Type::BOOLEAN;
+        case 'n': return Type::NULL_VALUE;
+        case '}': case ']': case ':': case ',': return Type::MISSING;
+        default: return Type::NUMBER;
+    }
+}
+
+JsonValue JsonValue::operator[](std::string_view name) const {
+    if (!isObject()) return JsonValue();
+    const std::vector<uint32_t>& tokens = document_->tokens_;
+    uint32_t close = document_->closes_[token_];
+    std::string scratch;
+    for (uint32_t token = token_ + 1; token + 2 < close;) {
+        JsonValue key(document_, token);
+        if (key.first() != '"' || document_->at(token + 1) != ':') return JsonValue();
+        JsonValue member(document_, token + 2);
+        scratch.clear();
+        if (key.stringView(scratch) == name) return member.type() == Type::MISSING ? JsonValue() : member;
+        token = member.following();
+        if (token >= tokens.size() || document_->at(token) != ',') break;
+        ++token;
+    }
+    return JsonValue();
+}
+
+JsonValue::Iterator JsonValue::begin() const {
+    Type kind = type();
+    if (kind != Type::OBJECT && kind != Type::ARRAY) return end();
+    uint32_t close = document_->closes_[token_];
+    // The first element, or the value of the first member
+    uint32_t token = kind == Type::OBJECT ? token_ + 3 : token_ + 1;
+    return token < close && JsonValue(document_, token).type() != Type::MISSING ? Iterator(document_, token) : end();
+}
+
+JsonValue::Iterator JsonValue::end() const {
+    return Iterator(document_, 0);
+}
+
+JsonValue::Iterator& JsonValue::Iterator::operator++() {
+    JsonValue current(document_, token_);
+    bool member = document_->at(token_ - 1) == ':';
+    uint32_t next = current.following();
+    token_ = 0;
+    if (next < document_->tokens_.size() && document_->at(next) == ',') {
+        next += member ? 3 : 1;
+        if (next < document_->tokens_.size() && JsonValue(document_, next).type() != Type::MISSING) token_ = next;
+    }
+    return *this;
+}
+
+size_t JsonValue::size() const {
+    size_t count = 0;
+    for (Iterator it = begin(); it != end(); ++it) ++count;
+    return count;
+}
+
+JsonValue JsonValue::at(size_t index) const {
+    if (!isArray()) return JsonValue();
+    for (Iterator it = begin(); it != end(); ++it) {
+        if (index-- == 0) return *it;
+    }
+    return JsonValue();
+}
+
+std::string JsonValue::name() const {
+    if (!document_ || token_ < 2 || document_->at(token_ - 1) != ':') return std::string();
+    return JsonValue(document_, token_ - 2).string();
+}
+
+std::string_view JsonValue::escaped() const {
+    const std::string_view& text = document_->text_;
+    const std::vector<uint32_t>& tokens = document_->tokens_;
+    size_t start = tokens[token_] + 1;
+    // The closing quote is the last byte before the next token bar whitespace
+    size_t quote = token_ + 1 < tokens.size() ? tokens[token_ + 1] : text.size();
+    while (quote > start && text[quote - 1] != '"') --quote;
+    return quote > start ? text.substr(start, quote - 1 - start) : std::string_view();
+}
+
+std::string_view JsonValue::raw() const {
+    if (!document_) return std::string_view();
+    const std::string_view& text = document_->text_;
+    const std::vector<uint32_t>& tokens = document_->tokens_;
+    size_t start = tokens[token_];
+    char c = first();
+    if (c == '{' || c == '[') return text.substr(start, tokens[document_->closes_[token_]] + 1 - start);
+    if (c == '"') return text.substr(start, escaped().size() + 2);
+    size_t end = token_ + 1 < tokens.size() ? tokens[token_ + 1] : text.size();
+    while (end > start && isWhitespace(text[end - 1])) --end;
+    return text.substr(start, end - start);
+}
+
+std::string JsonValue::string(std::string_view fallback) const {
+    if (!isString()) return std::string(fallback);
+    std::string value;
+    JsonDocument::unescape(escaped(), value);
+    return value;
+}
+
+std::string_view JsonValue::stringView(std::string& scratch) const {
+    if (!isString()) return std::string_view();
+    std::string_view text = escaped();
+    if (text.find('\\') == std::string_view::npos) return text;
+    scratch.clear();
+    JsonDocument::unescape(text, scratch);
+    return scratch;
+}
+
+bool JsonValue::boolean(bool fallback) const {
+    if (type() != Type::BOOLEAN) return fallback;
+    std::string_view text = raw();
+    if (text == "true") return true;
+    if (text == "false") return false;
+    return fallback;
+}
+
+int64_t JsonValue::integer(int64_t fallback) const {
+    if (type() != Type::NUMBER) return fallback;
+    std::string_view text = raw();
+    int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() ? value : fallback;
+}
+
+uint64_t JsonValue::unsignedInteger(uint64_t fallback) const {
+    if (type() != Type::NUMBER) return fallback;
+    std::string_view text = raw();
+    uint64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() ? value : fallback;
+}
+
+double JsonValue::number(double fallback) const {
+    if (type() != Type::NUMBER) return fallback;
+    std::string_view text = raw();
+    double value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() ? value : fallback;
+}
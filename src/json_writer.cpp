@@ -0,0 +1,240 @@
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+// Bytes that must be escaped inside a JSON string: controls, quote, backslash
+struct EscapeTable {
+    bool escape[256] = {};
+
+    EscapeTable() {
+        for (int c = 0; c < 0x20; ++c) escape[c] = true;
+        escape[static_cast<unsigned char>('"')] = true;
+        escape[static_cast<unsigned char>('\\')] = true;
+    }
+};
+
+const EscapeTable kEscapes;
+
+inline int ctz32(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+#if defined(__AVX2__)
+constexpr size_t kEscapeBlock = 32;
+using Block = __m256i;
+
+// Bit i set if byte i of the block needs escaping
+inline uint32_t escapeMask(const char* p) {
+    Block v = _mm256_loadu_si256(reinterpret_cast<const Block*>(p));
+    Block control = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F));
+    Block quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    Block backslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, _mm256_or_si256(quote, backslash))));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+constexpr size_t kEscapeBlock = 16;
+using Block = __m128i;
+
+inline uint32_t escapeMask(const char* p) {
+    Block v = _mm_loadu_si128(reinterpret_cast<const Block*>(p));
+    Block control = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    Block quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    Block backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(quote, backslash))));
+}
+#else
+constexpr size_t kEscapeBlock = 0;
+#endif
+
+// Length of the run at the start of [p, end) that needs no escaping
+inline size_t cleanPrefix(const char* p, const char* end) {
+    const char* start = p;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    while (static_cast<size_t>(end - p) >= kEscapeBlock) {
+        uint32_t mask = escapeMask(p);
+        if (mask) return static_cast<size_t>(p - start) + ctz32(mask);
+        p += kEscapeBlock;
+    }
+#endif
+    while (p < end && !kEscapes.escape[static_cast<unsigned char>(*p)]) ++p;
+    return static_cast<size_t>(p - start);
+}
+
+void appendEscape(std::string& out, char c) {
+    static const char hex[] = "0123456789abcdef";
+    switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default: {
+            unsigned char u = static_cast<unsigned char>(c);
+            char escape[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+            out.append(escape, sizeof(escape));
+        }
+    }
+}
+
+} // namespace
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    // Most text needs no escaping; room for it is made once
+    out.reserve(out.size() + text.size());
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        size_t clean = cleanPrefix(p, end);
+        out.append(p, clean);
+        p += clean;
+        if (p == end) break;
+        appendEscape(out, *p++);
+    }
+}
+
+void JsonWriter::appendString(std::string& out, std::string_view text) {
+    out += '"';
+    appendEscaped(out, text);
+    out += '"';
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out_ += '}';
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out_ += ']';
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    appendString(out_, name);
+    out_ += ':';
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    appendString(out_, text);
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_ += "null";
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool flag) {
+    separate();
+    out_ += flag ? "true" : "false";
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(int64_t number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    out_.append(digits, static_cast<size_t>(result.ptr - digits));
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::unsignedInteger(uint64_t number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    out_.append(digits, static_cast<size_t>(result.ptr - digits));
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::floating(double number) {
+    if (!std::isfinite(number)) return null();
+    separate();
+    // Shortest representation that reads back as the same double
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    out_.append(digits, static_cast<size_t>(result.ptr - digits));
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginString() {
+    separate();
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::stringPart(std::string_view text) {
+    appendEscaped(out_, text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endString() {
+    out_ += '"';
+    comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out_.append(json.data(), json.size());
+    comma_ = true;
+    return *this;
+}
+
+void JsonWriter::clear() {
+    out_.clear();
+    comma_ = false;
+}
+
+std::string JsonWriter::take() {
+    std::string document = std::move(out_);
+    clear();
+    return document;
+}
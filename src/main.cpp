@@ -3,7 +3,15 @@
 #endif
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdlib>
 #include "../include/webview_host.h"
 #include "../include/compiler.h"
 #include "../include/system_info.h"
@@ -14,6 +22,16 @@
 #include "../include/auto_updater.h"
 #include "../include/docker_manager.h"
 #include "../include/auto_coder.h"
+#include "../include/text_buffer.h"
+#include "../include/mapped_file.h"
+#include "../include/syntax_highlighter.h"
+#include "../include/bracket_index.h"
+#include "../include/file_watcher.h"
+#include "../include/grep_engine.h"
+#include "../include/ide_application.h"
+#include "../include/async_io.h"
+#include "../include/json_writer.h"
+#include "../include/json_reader.h"
 
 // Global variables
 #ifdef _WIN32
@@ -26,6 +44,10 @@ HybridIDE::AutoInstaller* g_autoInstaller = nullptr;
 HybridIDE::AutoUpdater* g_autoUpdater = nullptr;
 HybridIDE::DockerManager* g_dockerManager = nullptr;
 HybridIDE::AutoCoder* g_autoCoder = nullptr;
+HybridIDE::ProjectExplorer* g_project = nullptr;
+bool g_projectWatched = false;   // the project's watcher keeps its tree current
+std::atomic<bool> g_projectReady{false};   // g_project belongs to the message thread once set
+std::thread g_projectLoader;
 
 #ifdef _WIN32
 // Window procedure
@@ -53,49 +75,37 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 void sendToFrontend(const std::string& type, const std::string& data) {
     if (!g_webViewHost) return;
     
-    std::string message = "{\"type\":\"" + type + "\",\"data\":" + data + "}";
+    std::string message;
+    message.reserve(type.size() + data.size() + 24);
+    message += "{\"type\":";
+    HybridIDE::JsonWriter::appendString(message, type);
+    message += ",\"data\":";
+    message += data;
+    message += '}';
     g_webViewHost->postMessage(message);
 }
 
 // Handle build request from frontend
-void handleBuildRequest(const std::string& data) {
-    // Parse data JSON
+void handleBuildRequest(const HybridIDE::JsonValue& data) {
     // Expected: {"sourceFile": "path", "outputFile": "path", "flags": [...]}
-    
-    // For simplicity, extract basic fields (in production, use JSON library)
-    std::string sourceFile, outputFile;
-    
-    size_t srcPos = data.find("\"sourceFile\"");
-    if (srcPos != std::string::npos) {
-        size_t start = data.find("\"", srcPos + 12);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            sourceFile = data.substr(start + 1, end - start - 1);
-        }
-    }
-    
-    size_t outPos = data.find("\"outputFile\"");
-    if (outPos != std::string::npos) {
-        size_t start = data.find("\"", outPos + 12);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            outputFile = data.substr(start + 1, end - start - 1);
-        }
-    }
+    std::string sourceFile = data["sourceFile"].string();
+    std::string outputFile = data["outputFile"].string();
     
     // Verify build request
     VerificationResult verification = PromptVerifier::verifyBuildRequest(sourceFile, outputFile);
     
     if (!verification.valid) {
-        std::string error = "{\"success\":false,\"message\":\"" + verification.message + "\"}";
-        sendToFrontend("buildComplete", error);
+        HybridIDE::JsonWriter error;
+        error.beginObject().member("success", false).member("message", verification.message).endObject();
+        sendToFrontend("buildComplete", error.str());
         return;
     }
     
     // Send warnings
     for (const auto& warning : verification.warnings) {
-        std::string warn = "{\"message\":\"" + warning + "\"}";
-        sendToFrontend("buildLog", warn);
+        HybridIDE::JsonWriter warn;
+        warn.beginObject().member("message", warning).endObject();
+        sendToFrontend("buildLog", warn.str());
     }
     
     // Start compilation in background thread
@@ -108,44 +118,42 @@ void handleBuildRequest(const std::string& data) {
         options.optimize = false;
         
         bool success = g_compiler->compile(options, [](const std::string& log) {
-            std::string logMsg = "{\"message\":\"" + log + "\"}";
-            sendToFrontend("buildLog", logMsg);
+            HybridIDE::JsonWriter logMsg;
+            logMsg.beginObject().member("message", log).endObject();
+            sendToFrontend("buildLog", logMsg.str());
         });
         
-        std::string result = success ? 
-            "{\"success\":true,\"message\":\"Build completed successfully\",\"outputFile\":\"" + outputFile + "\"}" :
-            "{\"success\":false,\"message\":\"Build failed\"}";
+        HybridIDE::JsonWriter result;
+        result.beginObject().member("success", success);
+        if (success) {
+            result.member("message", "Build completed successfully").member("outputFile", outputFile);
+        } else {
+            result.member("message", "Build failed");
+        }
+        result.endObject();
         
-        sendToFrontend("buildComplete", result);
+        sendToFrontend("buildComplete", result.str());
     }).detach();
 }
 
 // Handle system info request
-void handleSystemInfoRequest(const std::string& data) {
+void handleSystemInfoRequest(const HybridIDE::JsonValue& data) {
     std::string info = SystemInfo::toJSON();
     sendToFrontend("systemInfo", info);
 }
 
 // Handle run request
-void handleRunRequest(const std::string& data) {
-    // Parse executable path from data
-    std::string execPath;
-    
-    size_t pathPos = data.find("\"path\"");
-    if (pathPos != std::string::npos) {
-        size_t start = data.find("\"", pathPos + 6);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            execPath = data.substr(start + 1, end - start - 1);
-        }
-    }
+void handleRunRequest(const HybridIDE::JsonValue& data) {
+    // Expected: {"path": "executable"}
+    std::string execPath = data["path"].string();
     
     // Verify run request
     VerificationResult verification = PromptVerifier::verifyRunRequest(execPath);
     
     if (!verification.valid) {
-        std::string error = "{\"success\":false,\"message\":\"" + verification.message + "\"}";
-        sendToFrontend("runComplete", error);
+        HybridIDE::JsonWriter error;
+        error.beginObject().member("success", false).member("message", verification.message).endObject();
+        sendToFrontend("runComplete", error.str());
         return;
     }
     
@@ -165,9 +173,9 @@ void handleRunRequest(const std::string& data) {
         
         char buffer[256];
         while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            std::string output = buffer;
-            std::string logMsg = "{\"message\":\"" + output + "\"}";
-            sendToFrontend("runLog", logMsg);
+            HybridIDE::JsonWriter logMsg;
+            logMsg.beginObject().member("message", buffer).endObject();
+            sendToFrontend("runLog", logMsg.str());
         }
         
 #ifdef _WIN32
@@ -175,118 +183,687 @@ void handleRunRequest(const std::string& data) {
 #else
         int exitCode = pclose(pipe);
 #endif
-        std::string result = "{\"success\":true,\"exitCode\":" + std::to_string(exitCode) + "}";
-        sendToFrontend("runComplete", result);
+        HybridIDE::JsonWriter result;
+        result.beginObject().member("success", true).member("exitCode", exitCode).endObject();
+        sendToFrontend("runComplete", result.str());
     }).detach();
 }
 
-// Handle file read request
-void handleReadFileRequest(const std::string& data) {
-    std::string path;
-    
-    size_t pathPos = data.find("\"path\"");
-    if (pathPos != std::string::npos) {
-        size_t start = data.find("\"", pathPos + 6);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            path = data.substr(start + 1, end - start - 1);
-        }
+// ============================================================================
+// Open documents and viewport reads
+// ============================================================================
+
+// Files at or above this size are memory-mapped rather than read
+static const size_t kMapThreshold = 16 * 1024 * 1024;
+// Files below this size are sent whole with the openFile response and can
+// be edited; larger ones are paged in read-only through readRange. Only
+// files too big for the editor to hold are paged, and those are mapped.
+static const size_t kInlineContentLimit = kMapThreshold;
+// Upper bounds for one readRange response
+static const size_t kMaxRangeLines = 2000;
+static const size_t kMaxRangeBytes = 1024 * 1024;
+static const size_t kMaxLineBytes = 64 * 1024;
+
+struct OpenDocument {
+    HybridIDE::TextBuffer buffer;
+    HybridIDE::SyntaxHighlighter highlighter;
+    HybridIDE::BracketIndex brackets;   // fold markers for readRange
+    unsigned long long revision = 0;
+};
+
+// Documents are loaded and saved on AsyncIO's threads, so the table is
+// shared with the message thread
+std::mutex g_documentsMutex;
+std::map<std::string, OpenDocument> g_documents;
+unsigned long long g_nextRevision = 1;
+
+// {"success", "message", "path"}: the reply to a file request that
+// carries no content
+static std::string fileStatusJSON(bool success, std::string_view message, std::string_view path) {
+    HybridIDE::JsonWriter json;
+    json.beginObject().member("success", success).member("message", message).member("path", path).endObject();
+    return json.take();
+}
+
+// Set up the highlighter and fold index of a document whose buffer holds
+// the file's text. Takes no lock: the document is not shared yet.
+static void prepareDocument(const std::string& path, OpenDocument& document) {
+    document.highlighter.setLanguage(HybridIDE::SyntaxHighlighter::languageForPath(path));
+    document.highlighter.reset(document.buffer.lineCount());
+    document.brackets.reset(document.buffer.lineCount());
+}
+
+// Enter a prepared document into the open-document table. Callers hold
+// g_documentsMutex.
+static OpenDocument* installDocument(const std::string& path, OpenDocument& document) {
+    document.revision = g_nextRevision++;
+    OpenDocument& slot = g_documents[path];
+    slot = std::move(document);
+    return &slot;
+}
+
+// Called once a document is loaded, with g_documentsMutex released: a
+// snapshot of its buffer and its revision, or nullptr if it could not be read
+using DocumentLoaded = std::function<void(const HybridIDE::TextBuffer* buffer, unsigned long long revision)>;
+
+// Install a loaded document and hand done a snapshot of it; the lock is
+// held only for the insert
+static void finishLoad(const std::string& path, OpenDocument& document, const DocumentLoaded& done) {
+    prepareDocument(path, document);
+    HybridIDE::TextBuffer snapshot = document.buffer;
+    unsigned long long revision;
+    {
+        std::lock_guard<std::mutex> lock(g_documentsMutex);
+        revision = installDocument(path, document)->revision;
     }
+    done(&snapshot, revision);
+}
+
+// Load (or reload) a document into the open-document table off the message
+// thread; done runs on an I/O thread. Small files are read through the
+// ring; large ones are mapped. Either way the line scan (setText touches
+// every page of a mapping) and prepareDocument run on the pool, so the
+// ring's reaper only hands the result over.
+static void loadDocumentAsync(const std::string& path, DocumentLoaded done) {
+    HybridIDE::AsyncIO& io = HybridIDE::AsyncIO::shared();
+    io.stat(path, [&io, path, done](HybridIDE::AsyncIO::Stat&& stat) {
+        if (stat.error || stat.isDirectory) {
+            done(nullptr, 0);
+            return;
+        }
+        if (stat.size >= kMapThreshold) {
+            io.runOnPool([path, done] {
+                FileView view;
+                if (!FileOperations::readFile(path, view, kMapThreshold)) {
+                    done(nullptr, 0);
+                    return;
+                }
+                OpenDocument document;
+                if (view.mapping()) {
+                    document.buffer.setText(view.mapping());
+                } else {
+                    document.buffer.setText(view.release());
+                }
+                finishLoad(path, document, done);
+            });
+            return;
+        }
+        io.read(path, [&io, path, done](HybridIDE::AsyncIO::Read&& read) {
+            if (read.error) {
+                done(nullptr, 0);
+                return;
+            }
+            io.runOnPool([path, done, data = std::move(read.data)]() mutable {
+                OpenDocument document;
+                document.buffer.setText(std::move(data));
+                finishLoad(path, document, done);
+            });
+        });
+    });
+}
+
+// Handle file read request; the reply is sent once the file is in
+void handleReadFileRequest(const HybridIDE::JsonValue& data) {
+    std::string path = data["path"].string();
     
-    std::string content;
-    if (FileOperations::readFile(path, content)) {
-        // Escape content for JSON
-        std::string escaped;
-        for (char c : content) {
-            if (c == '"') escaped += "\\\"";
-            else if (c == '\\') escaped += "\\\\";
-            else if (c == '\n') escaped += "\\n";
-            else if (c == '\r') escaped += "\\r";
-            else if (c == '\t') escaped += "\\t";
-            else escaped += c;
+    loadDocumentAsync(path, [path](const HybridIDE::TextBuffer* buffer, unsigned long long revision) {
+        if (!buffer) {
+            sendToFrontend("fileContent", fileStatusJSON(false, "Failed to read file", path));
+            return;
         }
-        
-        std::string response = "{\"success\":true,\"content\":\"" + escaped + "\",\"path\":\"" + path + "\"}";
-        sendToFrontend("fileContent", response);
-    } else {
-        std::string error = "{\"success\":false,\"message\":\"Failed to read file\",\"path\":\"" + path + "\"}";
-        sendToFrontend("fileContent", error);
+
+        bool partial = buffer->length() >= kInlineContentLimit;
+
+        HybridIDE::JsonWriter response;
+        response.reserve(partial ? 256 : buffer->length() + buffer->length() / 8 + 256);
+        response.beginObject();
+        response.member("success", true);
+        response.member("path", path);
+        response.member("revision", revision);
+        response.member("lineCount", buffer->lineCount());
+        response.member("length", buffer->length());
+        response.member("partial", partial);
+        if (!partial) {
+            // Escaped straight from the buffer's pieces, without joining them first
+            response.key("content").beginString();
+            for (std::string_view chunk : buffer->view()) response.stringPart(chunk);
+            response.endString();
+        }
+        response.endObject();
+        sendToFrontend("fileContent", response.str());
+    });
+}
+
+// Reply with lines [firstLine, firstLine + count) of an open document.
+// Returns false, sending nothing, if path is not open.
+static bool sendRange(const std::string& path, size_t firstLine, size_t count) {
+    HybridIDE::JsonWriter response;
+    {
+        std::lock_guard<std::mutex> lock(g_documentsMutex);
+        auto it = g_documents.find(path);
+        if (it == g_documents.end()) return false;
+        OpenDocument& document = it->second;
+
+        const HybridIDE::TextBuffer& buffer = document.buffer;
+        size_t totalLines = buffer.lineCount();
+        firstLine = std::min(firstLine, totalLines);
+        size_t lastLine = std::min(firstLine + count, totalLines);
+
+        // A revision other than the current one tells the client its cache is stale
+        response.beginObject();
+        response.member("success", true);
+        response.member("path", path);
+        response.member("revision", document.revision);
+        response.member("lineCount", totalLines);
+        response.member("firstLine", firstLine);
+        response.key("lines").beginArray();
+
+        size_t bytes = 0;
+        for (size_t line = firstLine; line < lastLine && bytes < kMaxRangeBytes; ++line) {
+            size_t start = buffer.lineStart(line);
+            size_t length = std::min(buffer.lineEnd(line) - start, kMaxLineBytes);
+            response.value(buffer.substr(start, length));
+            bytes += length;
+        }
+        response.endArray();
+
+        response.key("folds").beginArray();
+        if (!buffer.isFileBacked()) {
+            auto folds = document.brackets.getFoldRegions(buffer, document.highlighter, firstLine, lastLine);
+            for (const auto& fold : folds) {
+                response.beginArray().value(fold.startLine).value(fold.endLine).endArray();
+            }
+        }
+        response.endArray();
+        response.endObject();
     }
+    sendToFrontend("fileRange", response.str());
+    return true;
+}
+
+// Handle viewport read request: {"path", "firstLine", "lineCount", "revision"}.
+// Besides the lines, the response lists fold regions starting in the range
+// as [startLine, endLine] pairs; mapped files skip them, since the first
+// query may have to lex the whole file. A file that is not open is loaded
+// first, off the message thread.
+void handleReadRangeRequest(const HybridIDE::JsonValue& data) {
+    std::string path = data["path"].string();
+    size_t firstLine = data["firstLine"].unsignedInteger(0);
+    size_t count = std::min<size_t>(data["lineCount"].unsignedInteger(100), kMaxRangeLines);
+    if (sendRange(path, firstLine, count)) return;
+
+    loadDocumentAsync(path, [path, firstLine, count](const HybridIDE::TextBuffer* buffer, unsigned long long) {
+        // Unreadable, or closed again before the reply could be built
+        if (!buffer || !sendRange(path, firstLine, count)) {
+            sendToFrontend("fileRange", fileStatusJSON(false, "File is not open", path));
+        }
+    });
+}
+
+// Handle file close request: drop the backend copy of the document
+void handleCloseFileRequest(const HybridIDE::JsonValue& data) {
+    std::string path = data["path"].string();
+    
+    std::lock_guard<std::mutex> lock(g_documentsMutex);
+    g_documents.erase(path);
 }
 
 // Handle file save request
-void handleSaveFileRequest(const std::string& data) {
-    std::string path, content;
-    
-    size_t pathPos = data.find("\"path\"");
-    if (pathPos != std::string::npos) {
-        size_t start = data.find("\"", pathPos + 6);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            path = data.substr(start + 1, end - start - 1);
+void handleSaveFileRequest(const HybridIDE::JsonValue& data) {
+    // The content is unescaped once, straight from the message
+    std::string path = data["path"].string();
+    std::string content = data["content"].string();
+    
+    // Swap the open document over first: a mapped buffer must not be
+    // reading the file while it is replaced
+    {
+        std::lock_guard<std::mutex> lock(g_documentsMutex);
+        auto it = g_documents.find(path);
+        if (it != g_documents.end()) {
+            it->second.buffer.setText(content);
+            it->second.highlighter.reset(it->second.buffer.lineCount());
+            it->second.brackets.reset(it->second.buffer.lineCount());
+            it->second.revision = g_nextRevision++;
         }
     }
     
-    size_t contentPos = data.find("\"content\"");
-    if (contentPos != std::string::npos) {
-        size_t start = data.find("\"", contentPos + 9);
-        size_t end = data.find_last_of("\"");
-        if (start != std::string::npos && end != std::string::npos && end > start) {
-            content = data.substr(start + 1, end - start - 1);
-            
-            // Unescape JSON content
-            std::string unescaped;
-            for (size_t i = 0; i < content.length(); i++) {
-                if (content[i] == '\\' && i + 1 < content.length()) {
-                    if (content[i+1] == 'n') { unescaped += '\n'; i++; }
-                    else if (content[i+1] == 'r') { unescaped += '\r'; i++; }
-                    else if (content[i+1] == 't') { unescaped += '\t'; i++; }
-                    else if (content[i+1] == '"') { unescaped += '"'; i++; }
-                    else if (content[i+1] == '\\') { unescaped += '\\'; i++; }
-                    else unescaped += content[i];
-                } else {
-                    unescaped += content[i];
+    // Written on AsyncIO's pool; saves of one file land in order
+    HybridIDE::AsyncIO::shared().write(path, std::move(content), FileOperations::WriteOptions(),
+                                       [path](bool&& saved) {
+        sendToFrontend("fileSaved", fileStatusJSON(saved, saved ? "File saved" : "Failed to save file", path));
+    });
+}
+
+// ============================================================================
+// Explorer change notifications
+// ============================================================================
+
+// Directories the explorer has listed, by watcher path, with the path the
+// frontend knows them by. The project's watcher covers them (ignored ones
+// are added to it as they are listed); changes inside them are pushed as
+// "fileTreeChanged" deltas so the explorer never re-lists.
+std::mutex g_listedMutex;
+std::map<std::string, std::string> g_listedDirectories;
+
+// Explorer paths are relative to the working directory ("./src"); the
+// watcher is rooted there and wants "src". Paths leaving it are not watched.
+static bool toWatcherPath(const std::string& path, std::string& relative) {
+    relative = path;
+    std::replace(relative.begin(), relative.end(), '\\', '/');
+    if (relative.empty() || relative[0] == '/' || relative.find(':') != std::string::npos) return false;
+    while (relative.compare(0, 2, "./") == 0) relative.erase(0, 2);
+    if (relative == ".") relative.clear();
+    while (!relative.empty() && relative.back() == '/') relative.pop_back();
+    return relative != ".." && relative.compare(0, 3, "../") != 0 &&
+           relative.find("/../") == std::string::npos;
+}
+
+// Returns false if changes in the directory will not be reported
+static bool watchListedDirectory(const std::string& path) {
+    std::string relative;
+    if (!g_projectReady || !toWatcherPath(path, relative)) return false;
+    std::lock_guard<std::mutex> lock(g_listedMutex);
+    if (!g_project->watchDirectory(relative)) return false;
+    g_listedDirectories[relative] = path;
+    return true;
+}
+
+// Listings the explorer pages through, by the path it asked for. A
+// directory is read once and sorted once per sort key; the watcher drops a
+// listing when its directory changes, one it does not watch is read again
+// once the directory's mtime moves, and when too many entries are cached
+// the least recently used listings go first.
+struct CachedListing {
+    std::vector<FileInfo> entries;   // directory order
+    bool hasSize = false;
+    bool hasModified = false;
+    bool watched = false;
+    std::filesystem::file_time_type directoryModified;   // before the read; for unwatched listings
+    uint64_t generation = 0;         // changes whenever the listing is read again
+    uint64_t lastUsed = 0;
+    std::map<std::string, std::vector<uint32_t>> orders;   // entry indices by sort key
+};
+
+static const size_t kMaxCachedEntries = 1000000;
+static const size_t kMaxPageSize = 5000;
+std::mutex g_listingMutex;
+std::map<std::string, CachedListing> g_listings;
+uint64_t g_listingGeneration = 0;
+uint64_t g_listingClock = 0;
+uint64_t g_listingChanges = 0;   // batches that touched a listed directory
+
+// Caller holds g_listingMutex; drops the listing of path and, for a
+// deleted directory, everything listed below it
+static void dropListings(const std::string& path, bool withSubdirectories) {
+    g_listings.erase(path);
+    if (!withSubdirectories) return;
+    for (const char* separator : {"/", "\\"}) {
+        std::string prefix = path + separator;
+        auto it = g_listings.lower_bound(prefix);
+        while (it != g_listings.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = g_listings.erase(it);
+        }
+    }
+}
+
+// Watcher batches -> {"changes":[{"change","path","parent","name","type"}]};
+// a "rescan" change asks the explorer to re-list what it shows
+static void sendFileTreeChanges(const std::vector<HybridIDE::FileWatcher::Change>& changes) {
+    using HybridIDE::FileWatcher;
+
+    HybridIDE::JsonWriter response;
+    response.beginObject().key("changes").beginArray();
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_listedMutex);
+        std::lock_guard<std::mutex> listingLock(g_listingMutex);
+        for (const FileWatcher::Change& change : changes) {
+            if (change.type == FileWatcher::ChangeType::RESCAN) {
+                g_listings.clear();
+                response.beginObject().member("change", "rescan").endObject();
+                ++count;
+                continue;
+            }
+
+            size_t slash = change.path.rfind('/');
+            std::string directory = slash == std::string::npos ? std::string() : change.path.substr(0, slash);
+            std::string name = slash == std::string::npos ? change.path : change.path.substr(slash + 1);
+            auto listed = g_listedDirectories.find(directory);
+            if (listed == g_listedDirectories.end()) continue;
+
+            const char* kind = "modified";
+            if (change.type == FileWatcher::ChangeType::CREATED) kind = "created";
+            if (change.type == FileWatcher::ChangeType::DELETED) kind = "deleted";
+
+            // A modification only matters to listings that carry sizes or times
+            auto cached = g_listings.find(listed->second);
+            if (cached != g_listings.end() && (change.type != FileWatcher::ChangeType::MODIFIED ||
+                                               cached->second.hasSize || cached->second.hasModified)) {
+                g_listings.erase(cached);
+            }
+            if (change.type == FileWatcher::ChangeType::DELETED && change.isDirectory) {
+                dropListings((std::filesystem::path(listed->second) / name).string(), true);
+            }
+
+            response.beginObject();
+            response.member("change", kind);
+            response.member("path", (std::filesystem::path(listed->second) / name).string());
+            response.member("parent", listed->second);
+            response.member("name", name);
+            response.member("type", change.isDirectory ? "folder" : "file");
+            response.endObject();
+            ++count;
+
+            if (change.type == FileWatcher::ChangeType::DELETED && change.isDirectory) {
+                // The watcher already dropped its watches below the directory
+                std::string prefix = change.path + "/";
+                auto first = g_listedDirectories.lower_bound(change.path);
+                auto last = first;
+                while (last != g_listedDirectories.end() &&
+                       (last->first == change.path || last->first.compare(0, prefix.size(), prefix) == 0)) {
+                    ++last;
                 }
+                g_listedDirectories.erase(first, last);
             }
-            content = unescaped;
         }
+        if (count > 0) ++g_listingChanges;
     }
-    
-    if (FileOperations::writeFile(path, content)) {
-        std::string response = "{\"success\":true,\"message\":\"File saved\",\"path\":\"" + path + "\"}";
-        sendToFrontend("fileSaved", response);
-    } else {
-        std::string error = "{\"success\":false,\"message\":\"Failed to save file\",\"path\":\"" + path + "\"}";
-        sendToFrontend("fileSaved", error);
+    response.endArray().endObject();
+    if (count > 0) sendToFrontend("fileTreeChanged", response.str());
+}
+
+// ============================================================================
+// Content search
+// ============================================================================
+
+// One batch of a streaming search -> {"searchId", "matches":[{"path",
+// "line", "column", "length", "text"}], "filesSearched", "done",
+// "limitReached"}; paths are given the way the explorer knows them
+static void sendContentSearchBatch(const HybridIDE::GrepEngine::Progress& progress,
+                                   std::vector<HybridIDE::GrepEngine::Match>& batch) {
+    HybridIDE::JsonWriter response;
+    response.beginObject();
+    response.member("searchId", progress.searchId);
+    response.key("matches").beginArray();
+    for (const HybridIDE::GrepEngine::Match& match : batch) {
+        response.beginObject();
+        response.member("path", (std::filesystem::path(".") / match.path).string());
+        response.member("line", match.line);
+        response.member("column", match.column);
+        response.member("length", match.length);
+        response.member("text", match.text);
+        response.endObject();
     }
+    response.endArray();
+    response.member("filesSearched", progress.filesSearched);
+    response.member("done", progress.done);
+    response.member("limitReached", progress.limitReached);
+    response.endObject();
+    sendToFrontend("contentSearchResults", response.str());
 }
 
-// Handle list directory request
-void handleListDirectoryRequest(const std::string& data) {
-    std::string path;
-    
-    size_t pathPos = data.find("\"path\"");
-    if (pathPos != std::string::npos) {
-        size_t start = data.find("\"", pathPos + 6);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            path = data.substr(start + 1, end - start - 1);
+// Ids of content searches, whether answered by the index or streamed
+uint64_t g_contentSearchId = 0;
+
+// Handle content search request: {"pattern", "regex", "caseSensitive",
+// "maxResults"}. Once the project's trigram index is up to date it answers
+// at once; until then the project is searched in the background, which
+// cancels the search before it. Either way matches arrive as batches, and
+// the reply carries the search's id (0 and an error for an invalid
+// pattern), so batches still in flight from older searches can be dropped.
+// While the project is being opened nothing is searched and the reply has
+// loading set.
+void handleSearchContentRequest(const HybridIDE::JsonValue& data) {
+    HybridIDE::GrepEngine::Query query;
+    std::string pattern = data["pattern"].string();
+    query.regex = data["regex"].boolean(false);
+    query.caseSensitive = data["caseSensitive"].boolean(true);
+    query.maxResults = data["maxResults"].unsignedInteger(query.maxResults);
+
+    bool loading = !g_projectReady;
+    bool indexed = !loading && g_project->prepareContentIndex();
+    std::string error;
+    uint64_t id = 0;
+    std::vector<HybridIDE::TrigramIndex::Match> matches;
+    if (indexed) {
+        g_project->cancelContentSearch();
+        if (!pattern.empty() && g_project->searchContent(pattern, query, matches, &error)) id = ++g_contentSearchId;
+    } else if (!loading) {
+        uint64_t next = g_contentSearchId + 1;
+        auto onBatch = [next](const HybridIDE::GrepEngine::Progress& progress,
+                              std::vector<HybridIDE::GrepEngine::Match>& batch) {
+            HybridIDE::GrepEngine::Progress renumbered = progress;
+            renumbered.searchId = next;
+            sendContentSearchBatch(renumbered, batch);
+        };
+        if (g_project->streamContent(pattern, query, onBatch, &error) != 0) id = g_contentSearchId = next;
+    }
+
+    HybridIDE::JsonWriter response;
+    response.beginObject();
+    response.member("success", !loading && (id != 0 || error.empty()));
+    response.member("searchId", id);
+    response.member("loading", loading);
+    if (!error.empty()) response.member("message", error);
+    response.endObject();
+    sendToFrontend("contentSearchStarted", response.str());
+
+    if (id == 0 || !indexed) return;
+    HybridIDE::GrepEngine::Progress progress;
+    progress.searchId = id;
+    progress.limitReached = matches.size() >= query.maxResults;
+    size_t batchSize = HybridIDE::GrepEngine::Options().batchSize;
+    for (size_t start = 0; start == 0 || start < matches.size(); start += batchSize) {
+        size_t end = std::min(matches.size(), start + batchSize);
+        std::vector<HybridIDE::GrepEngine::Match> batch(std::make_move_iterator(matches.begin() + start),
+                                                        std::make_move_iterator(matches.begin() + end));
+        progress.matches = end;
+        progress.done = end == matches.size();
+        sendContentSearchBatch(progress, batch);
+    }
+}
+
+void handleCancelSearchRequest(const HybridIDE::JsonValue& data) {
+    (void)data;
+    if (g_projectReady) g_project->cancelContentSearch();
+}
+
+// ============================================================================
+// Quick open
+// ============================================================================
+
+// Open the project on a background thread: the walk (and writing its
+// index) takes too long for the message thread. Handlers leave g_project
+// alone until g_projectReady is set; "projectReady" tells the frontend to
+// ask again.
+static void loadProject() {
+    g_projectReady = false;
+    if (g_projectLoader.joinable()) g_projectLoader.join();
+    g_projectLoader = std::thread([]() {
+        g_project->openProject(".");
+        g_projectWatched = g_project->startWatching(sendFileTreeChanges);
+        g_projectReady = true;
+        sendToFrontend("projectReady", "{}");
+    });
+}
+
+// Handle quick open request: {"query", "maxResults", "refresh"} ->
+// {"query", "loading", "results":[{"path", "relativePath", "score",
+// "positions"}]}, positions being byte offsets into relativePath. The
+// project is opened at startup and its watcher patches the tree after
+// that; "refresh" opens it again only when it could not be watched. While
+// it is being opened the results are empty and loading is set.
+void handleQuickOpenRequest(const HybridIDE::JsonValue& data) {
+    std::string query = data["query"].string();
+    size_t limit = data["maxResults"].unsignedInteger(50);
+
+    bool loading = !g_projectReady;
+    if (!loading && data["refresh"].boolean(false) && !g_projectWatched) {
+        loadProject();
+        loading = true;
+    } else if (!loading) {
+        g_project->applyFileChanges();
+    }
+
+    std::vector<HybridIDE::FuzzyFinder::Result> results;
+    if (!loading) results = g_project->quickOpen(query, limit);
+
+    HybridIDE::JsonWriter response;
+    response.beginObject();
+    response.member("query", query);
+    response.member("loading", loading);
+    response.key("results").beginArray();
+    for (const HybridIDE::FuzzyFinder::Result& result : results) {
+        response.beginObject();
+        response.member("path", (std::filesystem::path(".") / result.path).string());
+        response.member("relativePath", result.path);
+        response.member("score", result.score);
+        response.key("positions").beginArray();
+        for (uint32_t position : result.positions) response.value(position);
+        response.endArray();
+        response.endObject();
+    }
+    response.endArray();
+    response.endObject();
+    sendToFrontend("quickOpenResults", response.str());
+}
+
+// Entry order for a sort key: "type" (folders first, then by name),
+// "name", "size" or "modified", ties broken by name
+static std::vector<uint32_t> sortListing(const std::vector<FileInfo>& entries, const std::string& key, bool descending) {
+    std::vector<uint32_t> order(entries.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    auto before = [&](uint32_t a, uint32_t b) {
+        const FileInfo& x = entries[a];
+        const FileInfo& y = entries[b];
+        if (key == "type" && x.type != y.type) return x.type == "folder";
+        if (key == "size" && x.size != y.size) return x.size < y.size;
+        if (key == "modified" && x.modified != y.modified) return x.modified < y.modified;
+        return x.name < y.name;
+    };
+    std::sort(order.begin(), order.end(), before);
+    if (descending) std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Handle list directory request: {"path", "size", "modified", "sort",
+// "descending", "offset", "limit", "cursor"} -> {"path", "sort",
+// "descending", "offset", "total", "generation", "files", "nextCursor"}.
+// Without a limit the whole directory is sent. A cursor ("generation:
+// offset", from the reply before) continues a page run; one from before
+// the directory changed starts over at offset 0, and generation tells the
+// explorer to drop the pages it holds.
+void handleListDirectoryRequest(const HybridIDE::JsonValue& data) {
+    std::string path = data["path"].string();
+    std::string sort = data["sort"].string();
+    if (sort != "name" && sort != "size" && sort != "modified") sort = "type";
+    bool descending = data["descending"].boolean(false);
+    size_t offset = data["offset"].unsignedInteger(0);
+    size_t limit = std::min<size_t>(data["limit"].unsignedInteger(0), kMaxPageSize);
+    std::string cursor = data["cursor"].string();
+
+    // Only the fields the frontend shows, or sorts by, are stat'ed for
+    FileOperations::ListOptions options;
+    options.size = data["size"].boolean(true) || sort == "size";
+    options.modified = data["modified"].boolean(true) || sort == "modified";
+    options.statThreads = 0;
+
+    // Watched before it is read, so no change can slip in between
+    bool watched = watchListedDirectory(path);
+    std::error_code error;
+    std::filesystem::file_time_type directoryModified;
+    if (!watched) directoryModified = std::filesystem::last_write_time(path, error);
+
+    HybridIDE::JsonWriter response;
+    response.beginObject().member("success", true).member("path", path);
+    {
+        std::unique_lock<std::mutex> lock(g_listingMutex);
+        auto found = g_listings.find(path);
+        bool fresh = found != g_listings.end() && (!options.size || found->second.hasSize) &&
+                     (!options.modified || found->second.hasModified) &&
+                     (watched ? found->second.watched : !error && found->second.directoryModified == directoryModified);
+
+        // The directory is read without the lock, which the watcher thread
+        // needs; a change reported meanwhile may be missing from what was
+        // read, so that listing is sent but not kept
+        CachedListing read;
+        if (!fresh) {
+            uint64_t changes = g_listingChanges;
+            lock.unlock();
+            read.entries = FileOperations::listDirectory(path, options);
+            read.hasSize = options.size;
+            read.hasModified = options.modified;
+            read.watched = watched;
+            read.directoryModified = directoryModified;
+            lock.lock();
+
+            read.generation = ++g_listingGeneration;
+            g_listings.erase(path);
+            found = g_listings.end();
+            if (changes == g_listingChanges && (watched || !error)) {
+                found = g_listings.emplace(path, std::move(read)).first;
+            }
+        }
+        CachedListing& listing = found != g_listings.end() ? found->second : read;
+        listing.lastUsed = ++g_listingClock;
+
+        std::string orderKey = descending ? sort + "-" : sort;
+        auto order = listing.orders.find(orderKey);
+        if (order == listing.orders.end()) {
+            order = listing.orders.emplace(orderKey, sortListing(listing.entries, sort, descending)).first;
+        }
+
+        if (!cursor.empty()) {
+            size_t colon = cursor.find(':');
+            bool current = colon != std::string::npos &&
+                           std::strtoull(cursor.c_str(), nullptr, 10) == listing.generation;
+            offset = current ? std::strtoull(cursor.c_str() + colon + 1, nullptr, 10) : 0;
+        }
+        size_t total = listing.entries.size();
+        offset = std::min(offset, total);
+        size_t end = limit == 0 ? total : std::min(total, offset + limit);
+
+        response.reserve((end - offset) * 96 + 256);
+        response.member("sort", sort);
+        response.member("descending", descending);
+        response.member("offset", offset);
+        response.member("total", total);
+        response.member("generation", listing.generation);
+        response.key("files").beginArray();
+        for (size_t i = offset; i < end; ++i) {
+            FileOperations::writeFileInfo(response, listing.entries[order->second[i]]);
+        }
+        response.endArray();
+        if (end < total) {
+            response.member("nextCursor", std::to_string(listing.generation) + ":" + std::to_string(end));
+        }
+        response.endObject();
+
+        // Evict the least recently used listings beyond the entry budget
+        size_t cached = 0;
+        for (const auto& entry : g_listings) cached += entry.second.entries.size();
+        while (cached > kMaxCachedEntries && g_listings.size() > 1) {
+            auto oldest = g_listings.end();
+            for (auto it = g_listings.begin(); it != g_listings.end(); ++it) {
+                if (it->first != path && (oldest == g_listings.end() || it->second.lastUsed < oldest->second.lastUsed)) {
+                    oldest = it;
+                }
+            }
+            cached -= oldest->second.entries.size();
+            g_listings.erase(oldest);
         }
     }
-    
-    std::vector<FileInfo> files = FileOperations::listDirectory(path);
-    std::string fileList = FileOperations::fileListToJSON(files);
-    
-    std::string response = "{\"success\":true,\"path\":\"" + path + "\",\"files\":" + fileList + "}";
-    sendToFrontend("directoryListing", response);
+
+    sendToFrontend("directoryListing", response.str());
 }
 
 // Handle auto-install request
-void handleAutoInstallRequest(const std::string& data) {
+void handleAutoInstallRequest(const HybridIDE::JsonValue& data) {
     std::thread([]() {
         g_autoInstaller->setProgressCallback([](const std::string& message, int progress) {
-            std::string progressMsg = "{\"message\":\"" + message + "\",\"progress\":" + std::to_string(progress) + "}";
-            sendToFrontend("installProgress", progressMsg);
+            HybridIDE::JsonWriter progressMsg;
+            progressMsg.beginObject().member("message", message).member("progress", progress).endObject();
+            sendToFrontend("installProgress", progressMsg.str());
         });
         
         bool success = g_autoInstaller->executePostBuildSteps();
@@ -300,26 +877,10 @@ void handleAutoInstallRequest(const std::string& data) {
 }
 
 // Handle plugin generation request
-void handleGeneratePluginRequest(const std::string& data) {
-    std::string code, pluginName;
-    
-    size_t namePos = data.find("\"name\"");
-    if (namePos != std::string::npos) {
-        size_t start = data.find("\"", namePos + 6);
-        size_t end = data.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            pluginName = data.substr(start + 1, end - start - 1);
-        }
-    }
-    
-    size_t codePos = data.find("\"code\"");
-    if (codePos != std::string::npos) {
-        size_t start = data.find("\"", codePos + 6);
-        size_t end = data.find_last_of("\"");
-        if (start != std::string::npos && end != std::string::npos && end > start) {
-            code = data.substr(start + 1, end - start - 1);
-        }
-    }
+void handleGeneratePluginRequest(const HybridIDE::JsonValue& data) {
+    // Expected: {"name": "...", "code": "..."}
+    std::string pluginName = data["name"].string();
+    std::string code = data["code"].string();
     
     bool success = g_pluginManager->generatePluginFromCode(code, pluginName);
     
@@ -328,49 +889,53 @@ void handleGeneratePluginRequest(const std::string& data) {
         success = g_pluginManager->loadPlugin("./plugins/" + pluginName);
     }
     
-    std::string result = success ? 
-        "{\"success\":true,\"message\":\"Plugin generated and loaded\",\"name\":\"" + pluginName + "\"}" :
-        "{\"success\":false,\"message\":\"Plugin generation failed\"}";
+    HybridIDE::JsonWriter result;
+    result.beginObject().member("success", success);
+    if (success) {
+        result.member("message", "Plugin generated and loaded").member("name", pluginName);
+    } else {
+        result.member("message", "Plugin generation failed");
+    }
+    result.endObject();
     
-    sendToFrontend("pluginGenerated", result);
+    sendToFrontend("pluginGenerated", result.str());
 }
 
 // Handle list plugins request
-void handleListPluginsRequest(const std::string& data) {
+void handleListPluginsRequest(const HybridIDE::JsonValue& data) {
     auto plugins = g_pluginManager->getLoadedPlugins();
     
-    std::string pluginList = "[";
-    for (size_t i = 0; i < plugins.size(); ++i) {
-        const auto& plugin = plugins[i];
-        pluginList += "{";
-        pluginList += "\"name\":\"" + plugin.manifest.name + "\",";
-        pluginList += "\"version\":\"" + plugin.manifest.version + "\",";
-        pluginList += "\"author\":\"" + plugin.manifest.author + "\",";
-        pluginList += "\"description\":\"" + plugin.manifest.description + "\",";
-        pluginList += "\"enabled\":" + std::string(plugin.enabled ? "true" : "false");
-        pluginList += "}";
-        if (i < plugins.size() - 1) pluginList += ",";
+    HybridIDE::JsonWriter response;
+    response.beginObject().member("success", true).key("plugins").beginArray();
+    for (const auto& plugin : plugins) {
+        response.beginObject();
+        response.member("name", plugin.manifest.name);
+        response.member("version", plugin.manifest.version);
+        response.member("author", plugin.manifest.author);
+        response.member("description", plugin.manifest.description);
+        response.member("enabled", plugin.enabled);
+        response.endObject();
     }
-    pluginList += "]";
+    response.endArray().endObject();
     
-    std::string response = "{\"success\":true,\"plugins\":" + pluginList + "}";
-    sendToFrontend("pluginList", response);
+    sendToFrontend("pluginList", response.str());
 }
 
 // Handle check updates request
-void handleCheckUpdatesRequest(const std::string& data) {
+void handleCheckUpdatesRequest(const HybridIDE::JsonValue& data) {
     std::thread([]() {
         if (g_autoUpdater->checkForUpdates()) {
             auto updateInfo = g_autoUpdater->getLatestVersion();
             
-            std::string info = "{";
-            info += "\"version\":\"" + updateInfo.version + "\",";
-            info += "\"releaseNotes\":\"" + updateInfo.releaseNotes + "\",";
-            info += "\"downloadUrl\":\"" + updateInfo.downloadUrl + "\"";
-            info += "}";
+            HybridIDE::JsonWriter response;
+            response.beginObject().member("success", true).member("updateAvailable", true);
+            response.key("updateInfo").beginObject();
+            response.member("version", updateInfo.version);
+            response.member("releaseNotes", updateInfo.releaseNotes);
+            response.member("downloadUrl", updateInfo.downloadUrl);
+            response.endObject().endObject();
             
-            std::string response = "{\"success\":true,\"updateAvailable\":true,\"updateInfo\":" + info + "}";
-            sendToFrontend("updateCheck", response);
+            sendToFrontend("updateCheck", response.str());
         } else {
             std::string response = "{\"success\":true,\"updateAvailable\":false}";
             sendToFrontend("updateCheck", response);
@@ -379,15 +944,14 @@ void handleCheckUpdatesRequest(const std::string& data) {
 }
 
 // Handle download update request
-void handleDownloadUpdateRequest(const std::string& data) {
+void handleDownloadUpdateRequest(const HybridIDE::JsonValue& data) {
     std::thread([]() {
         auto updateInfo = g_autoUpdater->getLatestVersion();
         
         g_autoUpdater->setDownloadProgressCallback([](int progress, long long current, long long total) {
-            std::string progressMsg = "{\"progress\":" + std::to_string(progress) + 
-                                    ",\"current\":" + std::to_string(current) + 
-                                    ",\"total\":" + std::to_string(total) + "}";
-            sendToFrontend("updateProgress", progressMsg);
+            HybridIDE::JsonWriter progressMsg;
+            progressMsg.beginObject().member("progress", progress).member("current", current).member("total", total).endObject();
+            sendToFrontend("updateProgress", progressMsg.str());
         });
         
         if (g_autoUpdater->downloadUpdate(updateInfo)) {
@@ -401,102 +965,104 @@ void handleDownloadUpdateRequest(const std::string& data) {
 }
 
 // Docker Manager handlers
-void handleSearchContainersRequest(const std::string& data) {
-    std::string query = data; // Parse JSON in production
+void handleSearchContainersRequest(const HybridIDE::JsonValue& data) {
+    std::string query = data["query"].string();
     auto results = g_dockerManager->searchContainers(query);
     
     // Convert results to JSON string
-    std::string json = "[";
-    for (size_t i = 0; i < results.size(); ++i) {
-        json += "{";
-        json += "\"name\":\"" + results[i].name + "\",";
-        json += "\"description\":\"" + results[i].description + "\",";
-        json += "\"stars\":" + std::to_string(results[i].stars) + ",";
-        json += "\"official\":" + std::string(results[i].official ? "true" : "false");
-        json += "}";
-        if (i < results.size() - 1) json += ",";
-    }
-    json += "]";
-    sendToFrontend("searchResults", json);
-}
-
-void handlePullImageRequest(const std::string& data) {
-    std::string imageName = data; // Parse JSON
-    if (g_dockerManager->pullImage(imageName)) {
+    HybridIDE::JsonWriter json;
+    json.beginArray();
+    for (const auto& result : results) {
+        json.beginObject();
+        json.member("name", result.name);
+        json.member("description", result.description);
+        json.member("stars", result.stars);
+        json.member("official", result.official);
+        json.endObject();
+    }
+    json.endArray();
+    sendToFrontend("searchResults", json.str());
+}
+
+void handlePullImageRequest(const HybridIDE::JsonValue& data) {
+    std::string imageName = data["imageName"].string();
+    if (g_dockerManager->pullImage(imageName, data["tag"].string("latest"))) {
         sendToFrontend("imagePulled", "{\"success\":true}");
     } else {
         sendToFrontend("imagePulled", "{\"success\":false}");
     }
 }
 
-void handleListContainersRequest(const std::string& data) {
+void handleListContainersRequest(const HybridIDE::JsonValue& data) {
     auto containers = g_dockerManager->listContainers(true);
     
     // Convert containers to JSON string
-    std::string json = "[";
-    for (size_t i = 0; i < containers.size(); ++i) {
-        json += "{";
-        json += "\"id\":\"" + containers[i].id + "\",";
-        json += "\"name\":\"" + containers[i].name + "\",";
-        json += "\"image\":\"" + containers[i].image + "\",";
-        json += "\"status\":\"" + containers[i].status + "\"";
-        json += "}";
-        if (i < containers.size() - 1) json += ",";
-    }
-    json += "]";
-    sendToFrontend("containerList", json);
-}
-
-void handleStartContainerRequest(const std::string& data) {
-    std::string containerId = data;
+    HybridIDE::JsonWriter json;
+    json.beginArray();
+    for (const auto& container : containers) {
+        json.beginObject();
+        json.member("id", container.id);
+        json.member("name", container.name);
+        json.member("image", container.image);
+        json.member("status", container.status);
+        json.endObject();
+    }
+    json.endArray();
+    sendToFrontend("containerList", json.str());
+}
+
+void handleStartContainerRequest(const HybridIDE::JsonValue& data) {
+    std::string containerId = data["id"].string();
     if (g_dockerManager->startContainer(containerId)) {
         sendToFrontend("containerStarted", "{\"success\":true}");
     }
 }
 
-void handleStopContainerRequest(const std::string& data) {
-    std::string containerId = data;
+void handleStopContainerRequest(const HybridIDE::JsonValue& data) {
+    std::string containerId = data["id"].string();
     if (g_dockerManager->stopContainer(containerId)) {
         sendToFrontend("containerStopped", "{\"success\":true}");
     }
 }
 
-void handleGenerateDockerfileRequest(const std::string& data) {
-    std::string projectType = data;
-    std::string baseImage = "ubuntu:22.04";
+void handleGenerateDockerfileRequest(const HybridIDE::JsonValue& data) {
+    std::string projectType = data["appType"].string();
+    std::string baseImage = data["baseImage"].string("ubuntu:22.04");
     auto dockerfile = g_dockerManager->generateDockerfile(baseImage, projectType);
-    std::string json = "{\"content\":\"" + dockerfile + "\"}";
-    sendToFrontend("dockerfileGenerated", json);
+    HybridIDE::JsonWriter json;
+    json.beginObject().member("content", dockerfile).endObject();
+    sendToFrontend("dockerfileGenerated", json.str());
 }
 
-void handleRepairContainerRequest(const std::string& data) {
-    std::string containerId = data;
+void handleRepairContainerRequest(const HybridIDE::JsonValue& data) {
+    std::string containerId = data["id"].string();
     if (g_dockerManager->repairContainer(containerId)) {
         sendToFrontend("containerRepaired", "{\"success\":true}");
     }
 }
 
-void handleBackupContainerRequest(const std::string& data) {
-    std::string containerId = data;
+void handleBackupContainerRequest(const HybridIDE::JsonValue& data) {
+    std::string containerId = data["id"].string();
     if (g_dockerManager->backupContainer(containerId, "./backups")) {
         sendToFrontend("containerBackedUp", "{\"success\":true}");
     }
 }
 
 // AutoCoder handlers
-void handleGenerateCodeRequest(const std::string& data) {
-    // Parse: { "prompt": "...", "language": "..." }
-    std::string prompt = data;
+void handleGenerateCodeRequest(const HybridIDE::JsonValue& data) {
+    // Expected: { "prompt": "...", "language": "..." }
+    std::string prompt = data["prompt"].string();
     HybridIDE::Language language = HybridIDE::Language::CPP; // Default to C++
     auto code = g_autoCoder->generateCode(prompt, language);
-    std::string json = "{\"code\":\"" + code + "\"}";
-    sendToFrontend("codeGenerated", json);
+    HybridIDE::JsonWriter json;
+    json.beginObject().member("code", code).endObject();
+    sendToFrontend("codeGenerated", json.str());
 }
 
-void handleGenerateProjectRequest(const std::string& data) {
-    // Parse: { "name": "...", "description": "...", "languages": [...] }
+void handleGenerateProjectRequest(const HybridIDE::JsonValue& data) {
+    // Expected: { "name": "...", "description": "...", "languages": [...] }
     HybridIDE::AutoCoder::ProjectSpec spec;
-    spec.description = data;
+    spec.description = data["description"].string();
     spec.features = {};
     spec.targetPlatform = "cross-platform";
     spec.languages = {HybridIDE::Language::CPP};
@@ -508,15 +1074,15 @@ void handleGenerateProjectRequest(const std::string& data) {
     }
 }
 
-void handleFixErrorsRequest(const std::string& data) {
-    std::string filePath = data;
+void handleFixErrorsRequest(const HybridIDE::JsonValue& data) {
+    std::string filePath = data["projectPath"].string();
     if (g_autoCoder->fixAllErrors(filePath)) {
         sendToFrontend("errorsFixed", "{\"success\":true}");
     }
 }
 
-void handleRecursiveFixRequest(const std::string& data) {
-    std::string projectPath = data;
+void handleRecursiveFixRequest(const HybridIDE::JsonValue& data) {
+    std::string projectPath = data["projectPath"].string();
     if (g_autoCoder->recursiveFixUntilZeroErrors(projectPath)) {
         sendToFrontend("recursiveFixComplete", "{\"success\":true}");
     } else {
@@ -524,15 +1090,15 @@ void handleRecursiveFixRequest(const std::string& data) {
     }
 }
 
-void handleGenerateTestsRequest(const std::string& data) {
-    std::string filePath = data;
+void handleGenerateTestsRequest(const HybridIDE::JsonValue& data) {
+    std::string filePath = data["modulePath"].string();
     if (g_autoCoder->generateTests(filePath)) {
         sendToFrontend("testsGenerated", "{\"success\":true}");
     }
 }
 
-void handleRunUntilCompleteRequest(const std::string& data) {
-    std::string projectPath = data;
+void handleRunUntilCompleteRequest(const HybridIDE::JsonValue& data) {
+    std::string projectPath = data["projectPath"].string();
     if (g_autoCoder->runUntilComplete(projectPath)) {
         sendToFrontend("projectComplete", "{\"success\":true}");
     }
@@ -598,6 +1164,11 @@ int main(int argc, char* argv[]) {
     // Initialize auto coder
     g_autoCoder = new HybridIDE::AutoCoder();
     
+    // Quick open and content search over the same tree, opened in the
+    // background; its watcher also pushes the explorer's changes
+    g_project = new HybridIDE::ProjectExplorer();
+    loadProject();
+    
     // Check for updates on startup
     std::thread([]() {
         if (g_autoUpdater->checkForUpdates()) {
@@ -631,8 +1202,13 @@ int main(int argc, char* argv[]) {
     g_webViewHost->registerMessageHandler("run", handleRunRequest);
     g_webViewHost->registerMessageHandler("getSystemInfo", handleSystemInfoRequest);
     g_webViewHost->registerMessageHandler("openFile", handleReadFileRequest);
+    g_webViewHost->registerMessageHandler("readRange", handleReadRangeRequest);
+    g_webViewHost->registerMessageHandler("closeFile", handleCloseFileRequest);
     g_webViewHost->registerMessageHandler("saveFile", handleSaveFileRequest);
     g_webViewHost->registerMessageHandler("listDirectory", handleListDirectoryRequest);
+    g_webViewHost->registerMessageHandler("searchContent", handleSearchContentRequest);
+    g_webViewHost->registerMessageHandler("cancelSearch", handleCancelSearchRequest);
+    g_webViewHost->registerMessageHandler("quickOpen", handleQuickOpenRequest);
     g_webViewHost->registerMessageHandler("autoInstall", handleAutoInstallRequest);
     g_webViewHost->registerMessageHandler("generatePlugin", handleGeneratePluginRequest);
     g_webViewHost->registerMessageHandler("listPlugins", handleListPluginsRequest);
@@ -668,7 +1244,9 @@ int main(int argc, char* argv[]) {
         DispatchMessage(&msg);
     }
     
-    // Cleanup
+    // Cleanup; a running search would still post to the WebView
+    if (g_projectLoader.joinable()) g_projectLoader.join();
+    g_project->cancelContentSearch();
     delete g_webViewHost;
 #else
     // Linux: Run console-based tests
@@ -693,6 +1271,8 @@ int main(int argc, char* argv[]) {
     delete g_autoUpdater;
     delete g_dockerManager;
     delete g_autoCoder;
+    if (g_projectLoader.joinable()) g_projectLoader.join();
+    delete g_project;
     
 #ifdef _WIN32
     CoUninitialize();
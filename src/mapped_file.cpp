@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace HybridIDE;
+
+// An empty file has no mapping; data() then points at this byte
+static const char kEmpty = '\0';
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return nullptr;
+    }
+
+    file->size_ = static_cast<size_t>(size.QuadPart);
+    file->data_ = &kEmpty;
+    if (file->size_ > 0) {
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(handle);
+            return nullptr;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(handle);
+            return nullptr;
+        }
+        file->mapping_ = mapping;
+        file->data_ = static_cast<const char*>(view);
+    }
+    CloseHandle(handle);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    file->size_ = static_cast<size_t>(st.st_size);
+    file->data_ = &kEmpty;
+    if (file->size_ > 0) {
+        void* view = mmap(nullptr, file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            return nullptr;
+        }
+        file->data_ = static_cast<const char*>(view);
+    }
+    // The mapping keeps the file referenced; the descriptor is not needed
+    ::close(fd);
+#endif
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (size_ == 0) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+#else
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+void MappedFile::advise(Access access) const {
+#ifndef _WIN32
+    if (size_ == 0) return;
+
+    int advice = MADV_NORMAL;
+    if (access == Access::SEQUENTIAL) advice = MADV_SEQUENTIAL;
+    else if (access == Access::RANDOM) advice = MADV_RANDOM;
+    madvise(const_cast<char*>(data_), size_, advice);
+#else
+    (void)access;
+#endif
+}
+
+void MappedFile::release() const {
+    if (size_ == 0) return;
+
+#ifdef _WIN32
+    VirtualUnlock(const_cast<char*>(data_), size_);
+#else
+    // The mapping is private and never written, so nothing is lost
+    madvise(const_cast<char*>(data_), size_, MADV_DONTNEED);
+#endif
+}
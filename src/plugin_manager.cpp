@@ -1,4 +1,5 @@
 #include "plugin_manager.h"
+#include "async_io.h"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -153,20 +154,36 @@ std::vector<Plugin> PluginManager::scanPluginsDirectory(const std::string& direc
         return found;
     }
 
+    // Every manifest is stat'ed in one batch, then the ones present are
+    // read concurrently
+    std::vector<std::string> pluginPaths;
+    std::vector<std::string> manifestPaths;
     for (const auto& entry : fs::directory_iterator(directory)) {
         if (entry.is_directory()) {
-            std::string manifestPath = entry.path().string() + "/manifest.json";
-            if (fs::exists(manifestPath)) {
-                Plugin plugin;
-                plugin.manifest = parseManifest(manifestPath);
-                plugin.path = entry.path().string();
-                plugin.enabled = false;
-                plugin.handle = nullptr;
-                found.push_back(plugin);
-            }
+            pluginPaths.push_back(entry.path().string());
+            manifestPaths.push_back(pluginPaths.back() + "/manifest.json");
+        }
+    }
+
+    AsyncIO& io = AsyncIO::shared();
+    std::vector<AsyncIO::Stat> manifests = io.stat(manifestPaths).get();
+    std::vector<std::pair<size_t, std::future<AsyncIO::Read>>> reads;
+    for (size_t i = 0; i < manifests.size(); ++i) {
+        if (manifests[i].error == 0) {
+            reads.emplace_back(i, io.read(manifestPaths[i]));
         }
     }
 
+    for (auto& [index, read] : reads) {
+        AsyncIO::Read manifest = read.get();
+        Plugin plugin;
+        plugin.manifest = manifest.error ? PluginManifest() : parseManifestText(manifest.data);
+        plugin.path = pluginPaths[index];
+        plugin.enabled = false;
+        plugin.handle = nullptr;
+        found.push_back(plugin);
+    }
+
     return found;
 }
 
@@ -313,12 +330,16 @@ bool PluginManager::checkDependencies(const Plugin& plugin) {
 }
 
 PluginManifest PluginManager::parseManifest(const std::string& manifestPath) {
-    PluginManifest manifest;
-    
-    std::ifstream file(manifestPath);
-    if (!file) {
-        return manifest;
+    std::string text;
+    if (!FileOperations::readFile(manifestPath, text)) {
+        return PluginManifest();
     }
+    return parseManifestText(text);
+}
+
+PluginManifest PluginManager::parseManifestText(const std::string& text) {
+    PluginManifest manifest;
+    std::istringstream file(text);
 
     // Simple JSON parsing (in production, use a proper JSON library)
     std::string line;
@@ -353,7 +374,6 @@ PluginManifest PluginManager::parseManifest(const std::string& manifestPath) {
         }
     }
 
-    file.close();
     return manifest;
 }
 
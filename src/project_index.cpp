@@ -0,0 +1,619 @@
+#include "project_index.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// ----------------------------------------------------------------------------
+// On-disk layout: IndexHeader, DirectoryRecord[directoryCount] sorted by
+// path, EntryRecord[entryCount] sorted by name within each directory, then
+// the string pool. Every record is a multiple of 8 bytes, so the tables stay
+// aligned in the mapping.
+// ----------------------------------------------------------------------------
+
+constexpr char kMagic[8] = {'H', 'Y', 'I', 'D', 'X', 0, 0, 0};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+constexpr uint32_t kEntryDirectory = 1;
+constexpr uint32_t kEntryHasInfo = 2;
+
+// Marks a timestamp that must not be trusted
+constexpr int64_t kUnknown = INT64_MIN;
+
+// Anything modified this close to a save may change again without its
+// timestamp moving (coarse file system clocks), so it is saved as unknown
+constexpr int64_t kRacyWindow = 2000000000;
+
+// Files at least this large are mapped for hashing instead of read
+constexpr uint64_t kMapThreshold = 1024 * 1024;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t directoryCount;
+    uint64_t entryCount;
+    uint64_t stringBytes;
+    int64_t writtenAt;
+    uint64_t reserved[2];
+};
+
+struct DirectoryRecord {
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    int64_t modified;
+    uint32_t firstEntry;
+    uint32_t entryCount;
+};
+
+struct EntryRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t flags;
+    uint32_t reserved;
+    int64_t modified;
+    uint64_t size;
+    uint64_t hash;
+};
+
+static_assert(sizeof(IndexHeader) == 64, "index header layout");
+static_assert(sizeof(DirectoryRecord) == 24, "directory record layout");
+static_assert(sizeof(EntryRecord) == 40, "entry record layout");
+
+// A loaded index file, searched in place
+class CachedIndex {
+public:
+    bool load(const std::string& path) {
+        file_ = MappedFile::open(path);
+        if (!file_ || file_->size() < sizeof(IndexHeader)) return fail();
+
+        const IndexHeader* header = reinterpret_cast<const IndexHeader*>(file_->data());
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+            header->byteOrder != kByteOrder) {
+            return fail();
+        }
+
+        uint64_t available = file_->size() - sizeof(IndexHeader);
+        if (header->directoryCount > available / sizeof(DirectoryRecord)) return fail();
+        available -= header->directoryCount * sizeof(DirectoryRecord);
+        if (header->entryCount > available / sizeof(EntryRecord)) return fail();
+        available -= header->entryCount * sizeof(EntryRecord);
+        if (header->stringBytes != available) return fail();
+
+        directories_ = reinterpret_cast<const DirectoryRecord*>(file_->data() + sizeof(IndexHeader));
+        entries_ = reinterpret_cast<const EntryRecord*>(directories_ + header->directoryCount);
+        strings_ = reinterpret_cast<const char*>(entries_ + header->entryCount);
+        directoryCount_ = static_cast<size_t>(header->directoryCount);
+
+        // Check every reference once so lookups can trust them
+        for (size_t i = 0; i < directoryCount_; ++i) {
+            const DirectoryRecord& directory = directories_[i];
+            if (uint64_t(directory.pathOffset) + directory.pathLength > header->stringBytes ||
+                uint64_t(directory.firstEntry) + directory.entryCount > header->entryCount) {
+                return fail();
+            }
+        }
+        for (uint64_t i = 0; i < header->entryCount; ++i) {
+            if (uint64_t(entries_[i].nameOffset) + entries_[i].nameLength > header->stringBytes) return fail();
+        }
+        return true;
+    }
+
+    const DirectoryRecord* find(std::string_view path) const {
+        const DirectoryRecord* end = directories_ + directoryCount_;
+        const DirectoryRecord* it = std::lower_bound(directories_, end, path,
+            [this](const DirectoryRecord& record, std::string_view key) {
+                return pathOf(record) < key;
+            });
+        return it != end && pathOf(*it) == path ? it : nullptr;
+    }
+
+    const EntryRecord* entries(const DirectoryRecord& directory) const {
+        return entries_ + directory.firstEntry;
+    }
+
+    std::string_view nameOf(const EntryRecord& entry) const {
+        return std::string_view(strings_ + entry.nameOffset, entry.nameLength);
+    }
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    const DirectoryRecord* directories_ = nullptr;
+    const EntryRecord* entries_ = nullptr;
+    const char* strings_ = nullptr;
+    size_t directoryCount_ = 0;
+
+    std::string_view pathOf(const DirectoryRecord& record) const {
+        return std::string_view(strings_ + record.pathOffset, record.pathLength);
+    }
+
+    bool fail() {
+        file_.reset();
+        directoryCount_ = 0;
+        return false;
+    }
+};
+
+std::string joinPath(const std::string& root, const std::string& relativePath) {
+    if (relativePath.empty()) return root;
+    return root.back() == '/' || root.back() == '\\' ? root + relativePath : root + "/" + relativePath;
+}
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool statPath(const std::string& path, int64_t& modified, uint64_t& size) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) return false;
+    // FILETIME counts 100ns ticks since 1601
+    int64_t ticks = (int64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    modified = (ticks - 116444736000000000LL) * 100;
+    size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return false;
+    modified = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    size = static_cast<uint64_t>(st.st_size);
+#endif
+    return true;
+}
+
+// Hash a file expected to be size bytes long; false if it cannot be read
+// or no longer has that size
+bool hashFile(const std::string& path, uint64_t size, uint64_t& hash) {
+    if (size >= kMapThreshold) {
+        std::shared_ptr<const MappedFile> file = MappedFile::open(path);
+        if (!file || file->size() != size) return false;
+        file->advise(MappedFile::Access::SEQUENTIAL);
+        hash = ProjectIndex::hashContent(file->view());
+        return true;
+    }
+
+    thread_local std::string buffer;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    // One byte extra shows whether the file grew since it was stat()ed
+    buffer.resize(static_cast<size_t>(size) + 1);
+    size_t read = std::fread(&buffer[0], 1, buffer.size(), file);
+    std::fclose(file);
+    if (read != size) return false;
+    hash = ProjectIndex::hashContent(std::string_view(buffer.data(), read));
+    return true;
+}
+
+std::vector<FileWalker::Entry>::const_iterator findVisible(const std::vector<FileWalker::Entry>& entries,
+                                                           std::string_view name) {
+    // Visible entries are sorted directories first, then by name; a file
+    // is searched among the files only
+    auto files = std::partition_point(entries.begin(), entries.end(),
+                                      [](const FileWalker::Entry& e) { return e.isDirectory; });
+    auto it = std::lower_bound(files, entries.end(), name,
+                               [](const FileWalker::Entry& e, std::string_view key) { return e.name < key; });
+    return it != entries.end() && it->name == name ? it : entries.end();
+}
+
+} // namespace
+
+// ============================================================================
+// ProjectIndex
+// ============================================================================
+
+ProjectIndex::ProjectIndex() : dirty_(false) {
+}
+
+ProjectIndex::~ProjectIndex() {
+    close();
+}
+
+std::string ProjectIndex::indexPath() const {
+    return joinPath(joinPath(root_, kDirectory), kFileName);
+}
+
+std::vector<FileWalker::Directory> ProjectIndex::open(const std::string& root, const Options& options) {
+    close();
+    std::vector<FileWalker::Directory> directories;
+
+    root_ = root;
+    while (root_.size() > 1 && (root_.back() == '/' || root_.back() == '\\')) {
+        root_.pop_back();
+    }
+    options_ = options;
+    stats_ = Stats();
+    if (root_.empty()) return directories;
+
+    CachedIndex cache;
+    stats_.loaded = cache.load(indexPath());
+
+    std::mutex mutex;
+    std::atomic<size_t> reused(0), listed(0), hashed(0);
+
+    FileWalker::Options walk = options.walk;
+    walk.lister = [&](const std::string& relativePath, const std::string& absolutePath,
+                      std::vector<FileWalker::Entry>& raw) {
+        Listing listing;
+        uint64_t size = 0;
+        if (!statPath(absolutePath, listing.modified, size)) listing.modified = kUnknown;
+
+        const DirectoryRecord* record = stats_.loaded ? cache.find(relativePath) : nullptr;
+        if (record && listing.modified != kUnknown && record->modified == listing.modified) {
+            const EntryRecord* records = cache.entries(*record);
+            listing.reused = true;
+            listing.entries.resize(record->entryCount);
+            raw.resize(record->entryCount);
+            for (uint32_t i = 0; i < record->entryCount; ++i) {
+                Entry& entry = listing.entries[i];
+                entry.name = std::string(cache.nameOf(records[i]));
+                entry.isDirectory = (records[i].flags & kEntryDirectory) != 0;
+                entry.hasInfo = (records[i].flags & kEntryHasInfo) != 0;
+                entry.info.modified = records[i].modified;
+                entry.info.size = records[i].size;
+                entry.info.hash = records[i].hash;
+                raw[i] = FileWalker::Entry{entry.name, entry.isDirectory, FileWalker::kNoDirectory};
+            }
+            reused.fetch_add(1);
+        } else {
+            if (!FileWalker::listDirectory(absolutePath, raw)) return false;
+            listing.entries.resize(raw.size());
+            for (size_t i = 0; i < raw.size(); ++i) {
+                listing.entries[i].name = raw[i].name;
+                listing.entries[i].isDirectory = raw[i].isDirectory;
+            }
+            std::sort(listing.entries.begin(), listing.entries.end(),
+                      [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+            // Files still present keep their metadata, so an unchanged
+            // file is confirmed by a stat instead of being hashed again
+            if (record) {
+                const EntryRecord* records = cache.entries(*record);
+                auto at = listing.entries.begin();
+                for (uint32_t i = 0; i < record->entryCount && at != listing.entries.end(); ++i) {
+                    std::string_view name = cache.nameOf(records[i]);
+                    while (at != listing.entries.end() && at->name < name) ++at;
+                    if (at == listing.entries.end() || at->name != name) continue;
+                    if (!at->isDirectory && (records[i].flags & kEntryHasInfo) != 0) {
+                        at->hasInfo = true;
+                        at->info.modified = records[i].modified;
+                        at->info.size = records[i].size;
+                        at->info.hash = records[i].hash;
+                    }
+                }
+            }
+            listed.fetch_add(1);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        listings_[relativePath] = std::move(listing);
+        return true;
+    };
+
+    FileWalker::walk(root_, walk, [&](FileWalker::Directory& directory) {
+        Listing* listing = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = listings_.find(directory.path);
+            if (it != listings_.end()) listing = &it->second;
+        }
+
+        // Listings of unchanged directories are trusted as they are; the
+        // visible files of changed ones are stat()ed and hashed if needed
+        if (listing && options_.hashContents) {
+            std::string prefix = directory.path.empty() ? std::string() : directory.path + "/";
+            for (Entry& entry : listing->entries) {
+                if (entry.isDirectory || (listing->reused && entry.hasInfo)) continue;
+                if (findVisible(directory.entries, entry.name) == directory.entries.end()) continue;
+                if (refresh(prefix + entry.name, entry)) hashed.fetch_add(1);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directories.size() <= directory.id) {
+            directories.resize(directory.id + 1);
+        }
+        directories[directory.id] = std::move(directory);
+    });
+
+    stats_.directories = directories.size();
+    stats_.reused = reused.load();
+    stats_.listed = listed.load();
+    stats_.hashed = hashed.load();
+    dirty_ = !stats_.loaded || stats_.listed > 0 || stats_.hashed > 0;
+    return directories;
+}
+
+bool ProjectIndex::refresh(const std::string& relativePath, Entry& entry) {
+    std::string path = joinPath(root_, relativePath);
+    FileInfo info;
+    if (!statPath(path, info.modified, info.size)) {
+        entry.hasInfo = false;
+        return false;
+    }
+    if (entry.hasInfo && entry.info.modified == info.modified && entry.info.size == info.size) {
+        return false;
+    }
+    entry.hasInfo = hashFile(path, info.size, info.hash);
+    if (entry.hasInfo) entry.info = info;
+    return entry.hasInfo;
+}
+
+const ProjectIndex::Entry* ProjectIndex::findEntry(const std::string& relativePath) const {
+    size_t slash = relativePath.rfind('/');
+    std::string directory = slash == std::string::npos ? std::string() : relativePath.substr(0, slash);
+    std::string_view name = slash == std::string::npos ? std::string_view(relativePath)
+                                                        : std::string_view(relativePath).substr(slash + 1);
+
+    auto listing = listings_.find(directory);
+    if (listing == listings_.end()) return nullptr;
+    const std::vector<Entry>& entries = listing->second.entries;
+    auto entry = std::lower_bound(entries.begin(), entries.end(), name,
+                                  [](const Entry& e, std::string_view key) { return e.name < key; });
+    if (entry == entries.end() || entry->name != name || entry->isDirectory) return nullptr;
+    return &*entry;
+}
+
+bool ProjectIndex::fileInfo(const std::string& relativePath, FileInfo& info) {
+    Entry* entry = const_cast<Entry*>(findEntry(relativePath));
+    if (!entry) return false;
+    if (refresh(relativePath, *entry)) dirty_ = true;
+    if (!entry->hasInfo) return false;
+    info = entry->info;
+    return true;
+}
+
+bool ProjectIndex::recordedInfo(const std::string& relativePath, FileInfo& info) const {
+    const Entry* entry = findEntry(relativePath);
+    if (!entry || !entry->hasInfo) return false;
+    info = entry->info;
+    return true;
+}
+
+void ProjectIndex::applyChanges(const std::vector<FileWatcher::Change>& changes) {
+    for (const FileWatcher::Change& change : changes) {
+        if (change.type == FileWatcher::ChangeType::RESCAN) continue;
+
+        size_t slash = change.path.rfind('/');
+        std::string directory = slash == std::string::npos ? std::string() : change.path.substr(0, slash);
+        std::string name = slash == std::string::npos ? change.path : change.path.substr(slash + 1);
+
+        auto listing = listings_.find(directory);
+        if (listing == listings_.end()) continue;
+        listing->second.modified = kUnknown;
+        dirty_ = true;
+
+        std::vector<Entry>& entries = listing->second.entries;
+        auto entry = std::lower_bound(entries.begin(), entries.end(), name,
+                                      [](const Entry& e, const std::string& key) { return e.name < key; });
+        bool found = entry != entries.end() && entry->name == name;
+
+        if (change.type == FileWatcher::ChangeType::CREATED) {
+            if (!found) {
+                entry = entries.insert(entry, Entry());
+                entry->name = name;
+            }
+            entry->isDirectory = change.isDirectory;
+            entry->hasInfo = false;
+        } else if (change.type == FileWatcher::ChangeType::MODIFIED) {
+            if (found) entry->hasInfo = false;
+        } else if (change.type == FileWatcher::ChangeType::DELETED) {
+            if (found) entries.erase(entry);
+            if (change.isDirectory) {
+                // The directory's own listing, then everything below it
+                listings_.erase(change.path);
+                std::string prefix = change.path + "/";
+                auto below = listings_.lower_bound(prefix);
+                while (below != listings_.end() && below->first.compare(0, prefix.size(), prefix) == 0) {
+                    below = listings_.erase(below);
+                }
+            }
+        }
+    }
+}
+
+bool ProjectIndex::save() {
+    if (root_.empty() || !dirty_) return true;
+
+    int64_t writtenAt = now();
+    int64_t racy = writtenAt - kRacyWindow;
+
+    std::vector<DirectoryRecord> directories;
+    std::vector<EntryRecord> entries;
+    std::string strings;
+    directories.reserve(listings_.size());
+
+    for (const auto& item : listings_) {
+        const Listing& listing = item.second;
+        DirectoryRecord directory;
+        directory.pathOffset = static_cast<uint32_t>(strings.size());
+        directory.pathLength = static_cast<uint32_t>(item.first.size());
+        directory.modified = listing.modified >= racy ? kUnknown : listing.modified;
+        directory.firstEntry = static_cast<uint32_t>(entries.size());
+        directory.entryCount = static_cast<uint32_t>(listing.entries.size());
+        strings += item.first;
+        directories.push_back(directory);
+
+        for (const Entry& entry : listing.entries) {
+            EntryRecord record = {};
+            record.nameOffset = static_cast<uint32_t>(strings.size());
+            record.nameLength = static_cast<uint32_t>(entry.name.size());
+            record.flags = entry.isDirectory ? kEntryDirectory : 0;
+            if (entry.hasInfo && entry.info.modified < racy) {
+                record.flags |= kEntryHasInfo;
+                record.modified = entry.info.modified;
+                record.size = entry.info.size;
+                record.hash = entry.info.hash;
+            }
+            strings += entry.name;
+            entries.push_back(record);
+        }
+        if (strings.size() > UINT32_MAX || entries.size() > UINT32_MAX) return false;
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrder;
+    header.directoryCount = directories.size();
+    header.entryCount = entries.size();
+    header.stringBytes = strings.size();
+    header.writtenAt = writtenAt;
+
+    fs::path directory(indexDirectory(root_));
+    if (directory.empty()) return false;
+    std::error_code error;
+
+    // Written beside the index and renamed over it, so a crash or a second
+    // instance never sees a half-written file
+    fs::path target = directory / kFileName;
+    fs::path temporary = directory / (std::string(kFileName) + ".tmp");
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(directories.data()),
+                   static_cast<std::streamsize>(directories.size() * sizeof(DirectoryRecord)));
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(EntryRecord)));
+        file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!file) {
+            file.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+    fs::rename(temporary, target, error);
+    if (error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    dirty_ = false;
+    return true;
+}
+
+std::string ProjectIndex::indexDirectory(const std::string& root) {
+    std::error_code error;
+    fs::path directory = fs::path(root) / kDirectory;
+    if (!fs::is_directory(directory, error)) {
+        if (!fs::create_directories(directory, error)) return std::string();
+        // Keep the caches out of version control
+        std::ofstream(directory / ".gitignore", std::ios::binary) << "*\n";
+    }
+    return directory.string();
+}
+
+void ProjectIndex::close() {
+    save();
+    root_.clear();
+    listings_.clear();
+    dirty_ = false;
+}
+
+// ============================================================================
+// Content hash (XXH64)
+// ============================================================================
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t mixRound(uint64_t accumulator, uint64_t input) {
+    accumulator += input * kPrime2;
+    return rotateLeft(accumulator, 31) * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t accumulator, uint64_t value) {
+    accumulator ^= mixRound(0, value);
+    return accumulator * kPrime1 + kPrime4;
+}
+
+} // namespace
+
+uint64_t ProjectIndex::hashContent(std::string_view data) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+    const unsigned char* end = p + data.size();
+    uint64_t hash;
+
+    if (data.size() >= 32) {
+        uint64_t v1 = kPrime1 + kPrime2;
+        uint64_t v2 = kPrime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - kPrime1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = mixRound(v1, read64(p));
+            v2 = mixRound(v2, read64(p + 8));
+            v3 = mixRound(v3, read64(p + 16));
+            v4 = mixRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = kPrime5;
+    }
+    hash += data.size();
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= mixRound(0, read64(p));
+        hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= uint64_t(read32(p)) * kPrime1;
+        hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= *p * kPrime5;
+        hash = rotateLeft(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
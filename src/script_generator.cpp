@@ -1,5 +1,6 @@
 #include "script_generator.h"
 #include "code_signer.h"
+#include "file_operations.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -99,9 +100,21 @@ std::vector<ScriptGenerator::GeneratedScript> ScriptGenerator::generateScripts(c
         }
     }
 
-    // Save all scripts
+    // Save all scripts in one batch
+    std::vector<FileOperations::WriteRequest> files;
+    files.reserve(scripts.size());
     for (const auto& script : scripts) {
-        saveScript(script);
+        files.push_back({script.filepath, script.content, scriptWriteOptions(script)});
+    }
+    std::vector<size_t> failed;
+    FileOperations::writeFiles(files, 0, &failed);
+    for (size_t i = 0, next = 0; i < scripts.size(); ++i) {
+        if (next < failed.size() && failed[next] == i) {
+            std::cerr << "Failed to create file: " << scripts[i].filepath << std::endl;
+            ++next;
+        } else {
+            std::cout << "Script saved: " << scripts[i].filepath << std::endl;
+        }
     }
 
     return scripts;
@@ -516,32 +529,23 @@ bool ScriptGenerator::signScript(GeneratedScript& script) {
     }
 }
 
+FileOperations::WriteOptions ScriptGenerator::scriptWriteOptions(const GeneratedScript& script) {
+    // Scripts that run on Unix-like systems are made executable
+    FileOperations::WriteOptions options;
+    options.executable = script.platform != Platform::WINDOWS_POWERSHELL &&
+                         script.platform != Platform::WINDOWS_CMD &&
+                         script.platform != Platform::WINDOWS_BATCH;
+    return options;
+}
+
 bool ScriptGenerator::saveScript(const GeneratedScript& script) {
-    try {
-        std::ofstream file(script.filepath, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Failed to create file: " << script.filepath << std::endl;
-            return false;
-        }
-        
-        file << script.content;
-        file.close();
-        
-        // Set executable permissions on Unix-like systems
-#ifndef _WIN32
-        if (script.platform != Platform::WINDOWS_POWERSHELL &&
-            script.platform != Platform::WINDOWS_CMD &&
-            script.platform != Platform::WINDOWS_BATCH) {
-            chmod(script.filepath.c_str(), 0755);
-        }
-#endif
-        
-        std::cout << "Script saved: " << script.filepath << std::endl;
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving script: " << e.what() << std::endl;
+    if (!FileOperations::writeFile(script.filepath, script.content, scriptWriteOptions(script))) {
+        std::cerr << "Failed to create file: " << script.filepath << std::endl;
         return false;
     }
+    
+    std::cout << "Script saved: " << script.filepath << std::endl;
+    return true;
 }
 
 std::vector<std::string> ScriptGenerator::getSupportedPlatforms() const {
@@ -0,0 +1,530 @@
+#include "syntax_highlighter.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace HybridIDE;
+
+namespace {
+
+// End-of-line lexer states
+enum LexState : uint8_t {
+    NORMAL = 0,
+    BLOCK_COMMENT,
+    TEMPLATE_STRING,
+    TRIPLE_DOUBLE,
+    TRIPLE_SINGLE,
+    DOUBLE_STRING,
+    SINGLE_STRING,
+    PREPROCESSOR_LINE
+};
+
+// Character class flags
+enum : uint8_t {
+    CC_IDENT_START = 1,
+    CC_IDENT = 2,
+    CC_DIGIT = 4,
+    CC_SPACE = 8,
+    CC_OPERATOR = 16
+};
+
+const char* const kCppKeywords[] = {
+    "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "char16_t",
+    "char32_t", "char8_t", "class", "concept", "const", "const_cast", "consteval", "constexpr",
+    "constinit", "continue", "co_await", "co_return", "co_yield", "decltype", "default",
+    "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+    "false", "final", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+    "mutable", "namespace", "new", "noexcept", "nullptr", "operator", "override", "private",
+    "protected", "public", "register", "reinterpret_cast", "requires", "return", "short",
+    "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+    "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid",
+    "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while"
+};
+
+const char* const kPythonKeywords[] = {
+    "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class",
+    "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global",
+    "if", "import", "in", "is", "lambda", "match", "nonlocal", "not", "or", "pass", "raise",
+    "return", "self", "try", "while", "with", "yield"
+};
+
+const char* const kJavaScriptKeywords[] = {
+    "async", "await", "break", "case", "catch", "class", "const", "continue", "debugger",
+    "default", "delete", "do", "else", "export", "extends", "false", "finally", "for",
+    "from", "function", "get", "if", "import", "in", "instanceof", "let", "new", "null",
+    "of", "return", "set", "static", "super", "switch", "this", "throw", "true", "try",
+    "typeof", "undefined", "var", "void", "while", "with", "yield"
+};
+
+const char* const kTypeScriptKeywords[] = {
+    "abstract", "any", "as", "asserts", "bigint", "boolean", "declare", "enum", "implements",
+    "infer", "interface", "is", "keyof", "namespace", "never", "number", "object", "private",
+    "protected", "public", "readonly", "satisfies", "string", "symbol", "type", "unique",
+    "unknown"
+};
+
+const char* const kShellKeywords[] = {
+    "case", "do", "done", "elif", "else", "esac", "export", "fi", "for", "function", "if",
+    "in", "local", "readonly", "return", "select", "then", "time", "until", "while"
+};
+
+bool startsWith(std::string_view text, size_t pos, const char* prefix) {
+    if (!prefix) return false;
+    size_t len = std::strlen(prefix);
+    return len > 0 && text.size() - pos >= len && text.compare(pos, len, prefix) == 0;
+}
+
+bool endsWithBackslash(std::string_view text) {
+    size_t end = text.find_last_not_of(" \t\r");
+    return end != std::string_view::npos && text[end] == '\\';
+}
+
+} // namespace
+
+struct SyntaxHighlighter::LanguageSpec {
+    std::string name;
+    const char* lineComment = nullptr;
+    const char* blockOpen = nullptr;
+    const char* blockClose = nullptr;
+    const char* quotes = "\"'";
+    bool commentNeedsSpace = false;   // shell: '#' only starts a comment after whitespace
+    bool tripleQuotes = false;        // Python """ and '''
+    bool templateStrings = false;     // JS/TS backtick strings span lines
+    bool multilineQuotes = false;     // shell "..." and '...' span lines
+    bool singleQuoteEscapes = true;   // shell '...' has no escapes
+    bool preprocessor = false;        // C/C++ '#' directives
+    bool shellVariables = false;
+    uint8_t charClass[256] = {};
+    std::vector<std::string_view> keywords;  // sorted
+
+    bool isKeyword(std::string_view word) const {
+        return std::binary_search(keywords.begin(), keywords.end(), word);
+    }
+};
+
+namespace {
+
+template <size_t N>
+void addKeywords(SyntaxHighlighter::LanguageSpec& spec, const char* const (&words)[N]) {
+    spec.keywords.insert(spec.keywords.end(), std::begin(words), std::end(words));
+}
+
+void finishSpec(SyntaxHighlighter::LanguageSpec& spec, const char* operators) {
+    for (int c = 'a'; c <= 'z'; ++c) spec.charClass[c] |= CC_IDENT_START | CC_IDENT;
+    for (int c = 'A'; c <= 'Z'; ++c) spec.charClass[c] |= CC_IDENT_START | CC_IDENT;
+    for (int c = '0'; c <= '9'; ++c) spec.charClass[c] |= CC_DIGIT | CC_IDENT;
+    for (int c = 0x80; c < 0x100; ++c) spec.charClass[c] |= CC_IDENT_START | CC_IDENT;  // UTF-8
+    spec.charClass[static_cast<unsigned char>('_')] |= CC_IDENT_START | CC_IDENT;
+    for (unsigned char c : {' ', '\t', '\r', '\f', '\v'}) spec.charClass[c] |= CC_SPACE;
+    for (const char* op = operators; *op; ++op) {
+        spec.charClass[static_cast<unsigned char>(*op)] |= CC_OPERATOR;
+    }
+
+    std::sort(spec.keywords.begin(), spec.keywords.end());
+    spec.keywords.erase(std::unique(spec.keywords.begin(), spec.keywords.end()), spec.keywords.end());
+}
+
+const std::vector<SyntaxHighlighter::LanguageSpec>& languageSpecs() {
+    static const std::vector<SyntaxHighlighter::LanguageSpec> specs = [] {
+        std::vector<SyntaxHighlighter::LanguageSpec> all;
+
+        SyntaxHighlighter::LanguageSpec cpp;
+        cpp.name = "cpp";
+        cpp.lineComment = "//";
+        cpp.blockOpen = "/*";
+        cpp.blockClose = "*/";
+        cpp.preprocessor = true;
+        addKeywords(cpp, kCppKeywords);
+        finishSpec(cpp, "+-*/%=&|^!~<>?:");
+        all.push_back(cpp);
+
+        SyntaxHighlighter::LanguageSpec python;
+        python.name = "python";
+        python.lineComment = "#";
+        python.tripleQuotes = true;
+        addKeywords(python, kPythonKeywords);
+        finishSpec(python, "+-*/%=&|^!~<>@:");
+        all.push_back(python);
+
+        SyntaxHighlighter::LanguageSpec javascript;
+        javascript.name = "javascript";
+        javascript.lineComment = "//";
+        javascript.blockOpen = "/*";
+        javascript.blockClose = "*/";
+        javascript.quotes = "\"'`";
+        javascript.templateStrings = true;
+        addKeywords(javascript, kJavaScriptKeywords);
+        finishSpec(javascript, "+-*/%=&|^!~<>?:");
+        javascript.charClass[static_cast<unsigned char>('$')] |= CC_IDENT_START | CC_IDENT;
+        all.push_back(javascript);
+
+        SyntaxHighlighter::LanguageSpec typescript = javascript;
+        typescript.name = "typescript";
+        addKeywords(typescript, kTypeScriptKeywords);
+        finishSpec(typescript, "");
+        all.push_back(typescript);
+
+        SyntaxHighlighter::LanguageSpec shell;
+        shell.name = "shell";
+        shell.lineComment = "#";
+        shell.commentNeedsSpace = true;
+        shell.multilineQuotes = true;
+        shell.singleQuoteEscapes = false;
+        shell.shellVariables = true;
+        addKeywords(shell, kShellKeywords);
+        finishSpec(shell, "|&;<>=!");
+        all.push_back(shell);
+
+        return all;
+    }();
+    return specs;
+}
+
+const SyntaxHighlighter::LanguageSpec* findSpec(const std::string& language) {
+    std::string name = language;
+    if (name == "c" || name == "c++" || name == "cxx") name = "cpp";
+    if (name == "js" || name == "jsx") name = "javascript";
+    if (name == "ts" || name == "tsx") name = "typescript";
+    if (name == "py") name = "python";
+    if (name == "sh" || name == "bash" || name == "zsh") name = "shell";
+
+    for (const auto& spec : languageSpecs()) {
+        if (spec.name == name) return &spec;
+    }
+    return nullptr;
+}
+
+// Scan a string body from `from`; on success `end` is just past the closing
+// delimiter. Returns false if the line ends inside the string.
+bool scanString(std::string_view text, size_t from, uint8_t state, bool escapes, size_t& end) {
+    char quote = '"';
+    size_t width = 1;
+    switch (state) {
+        case TEMPLATE_STRING: quote = '`'; break;
+        case TRIPLE_DOUBLE: quote = '"'; width = 3; break;
+        case TRIPLE_SINGLE: quote = '\''; width = 3; break;
+        case SINGLE_STRING: quote = '\''; break;
+        default: break;
+    }
+
+    for (size_t i = from; i < text.size(); ++i) {
+        if (escapes && text[i] == '\\') {
+            ++i;
+            continue;
+        }
+        if (text[i] == quote &&
+            (width == 1 || (i + 2 < text.size() && text[i + 1] == quote && text[i + 2] == quote))) {
+            end = i + width;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// ============================================================================
+// SyntaxHighlighter
+// ============================================================================
+
+SyntaxHighlighter::SyntaxHighlighter(const std::string& language)
+    : spec_(findSpec(language)), firstDirty_(0), dirtyUntil_(0), lastRelexCount_(0) {
+}
+
+void SyntaxHighlighter::setLanguage(const std::string& language) {
+    spec_ = findSpec(language);
+    reset(endStates_.size());
+}
+
+std::string SyntaxHighlighter::getLanguage() const {
+    return spec_ ? spec_->name : "plaintext";
+}
+
+void SyntaxHighlighter::reset(size_t lineCount) {
+    endStates_.assign(lineCount, NORMAL);
+    firstDirty_ = 0;
+    dirtyUntil_ = lineCount;
+}
+
+void SyntaxHighlighter::applyEdit(size_t startLine, size_t oldEndLine, size_t newEndLine) {
+    if (startLine >= endStates_.size()) {
+        reset(endStates_.size() + newEndLine - oldEndLine);
+        return;
+    }
+
+    bool clean = firstDirty_ >= endStates_.size();
+    size_t oldCount = oldEndLine - startLine + 1;
+    size_t newCount = newEndLine - startLine + 1;
+    auto at = endStates_.begin() + static_cast<std::ptrdiff_t>(startLine + 1);
+    if (newCount > oldCount) {
+        endStates_.insert(at, newCount - oldCount, NORMAL);
+    } else if (oldCount > newCount) {
+        endStates_.erase(at, at + static_cast<std::ptrdiff_t>(oldCount - newCount));
+    }
+
+    if (clean) {
+        firstDirty_ = startLine;
+        dirtyUntil_ = newEndLine;
+        return;
+    }
+
+    // Keep a pending dirty range pointing at the same text after the shift.
+    // Lines from the old firstDirty_ on were never updated for that range, so
+    // the new scan may not stop before reaching them.
+    if (dirtyUntil_ > oldEndLine) {
+        dirtyUntil_ = dirtyUntil_ + newEndLine - oldEndLine;
+    }
+    size_t pending = firstDirty_ > oldEndLine ? firstDirty_ + newEndLine - oldEndLine : newEndLine;
+    dirtyUntil_ = std::max({dirtyUntil_, newEndLine, pending});
+    firstDirty_ = std::min(firstDirty_, startLine);
+}
+
+void SyntaxHighlighter::ensureStates(const TextBuffer& buffer, size_t line) {
+    lastRelexCount_ = 0;
+    if (!spec_) return;
+    if (endStates_.size() != buffer.lineCount()) {
+        reset(buffer.lineCount());
+    }
+
+    line = std::min(line, endStates_.size());
+    while (firstDirty_ < line) {
+        size_t i = firstDirty_;
+        uint8_t before = i == 0 ? static_cast<uint8_t>(NORMAL) : endStates_[i - 1];
+        uint8_t after = lexLine(buffer.getLine(i), before, nullptr);
+        ++lastRelexCount_;
+
+        bool converged = i > dirtyUntil_ && after == endStates_[i];
+        endStates_[i] = after;
+        firstDirty_ = i + 1;
+        if (converged) {
+            firstDirty_ = endStates_.size();
+            break;
+        }
+    }
+}
+
+std::vector<SyntaxHighlighter::Token> SyntaxHighlighter::tokenizeLine(const TextBuffer& buffer,
+                                                                      size_t line) {
+    std::vector<Token> tokens;
+    std::string text = buffer.getLine(line);
+    if (!spec_) {
+        if (!text.empty()) tokens.push_back({0, static_cast<uint32_t>(text.size()), TokenType::TEXT});
+        return tokens;
+    }
+
+    ensureStates(buffer, line);
+    uint8_t before = line == 0 || line > endStates_.size() ? static_cast<uint8_t>(NORMAL) : endStates_[line - 1];
+    lexLine(text, before, &tokens);
+    return tokens;
+}
+
+uint8_t SyntaxHighlighter::getLineEndState(const TextBuffer& buffer, size_t line) {
+    ensureStates(buffer, line + 1);
+    return line < endStates_.size() ? endStates_[line] : static_cast<uint8_t>(NORMAL);
+}
+
+uint8_t SyntaxHighlighter::tokenize(std::string_view text, uint8_t state, std::vector<Token>& tokens) const {
+    tokens.clear();
+    if (!spec_) {
+        if (!text.empty()) tokens.push_back({0, static_cast<uint32_t>(text.size()), TokenType::TEXT});
+        return NORMAL;
+    }
+    return lexLine(text, state, &tokens);
+}
+
+std::string SyntaxHighlighter::languageForPath(const std::string& path) {
+    size_t pos = path.rfind('.');
+    if (pos == std::string::npos) return "plaintext";
+    
+    std::string ext = path.substr(pos + 1);
+    if (ext == "cpp" || ext == "cc" || ext == "cxx" || ext == "c") return "cpp";
+    if (ext == "h" || ext == "hpp" || ext == "hh" || ext == "hxx") return "cpp";
+    if (ext == "js" || ext == "jsx" || ext == "mjs" || ext == "cjs") return "javascript";
+    if (ext == "ts" || ext == "tsx") return "typescript";
+    if (ext == "py") return "python";
+    if (ext == "sh" || ext == "bash" || ext == "zsh") return "shell";
+    if (ext == "java") return "java";
+    
+    return "plaintext";
+}
+
+const char* SyntaxHighlighter::tokenTypeName(TokenType type) {
+    switch (type) {
+        case TokenType::KEYWORD: return "keyword";
+        case TokenType::IDENTIFIER: return "identifier";
+        case TokenType::NUMBER: return "number";
+        case TokenType::STRING: return "string";
+        case TokenType::COMMENT: return "comment";
+        case TokenType::PREPROCESSOR: return "preprocessor";
+        case TokenType::OPERATOR: return "operator";
+        case TokenType::PUNCTUATION: return "punctuation";
+        case TokenType::VARIABLE: return "variable";
+        default: return "text";
+    }
+}
+
+uint8_t SyntaxHighlighter::lexLine(std::string_view text, uint8_t state,
+                                   std::vector<Token>* tokens) const {
+    const LanguageSpec& spec = *spec_;
+    const size_t n = text.size();
+    size_t i = 0;
+
+    auto emit = [tokens](size_t start, size_t end, TokenType type) {
+        if (tokens && end > start) {
+            tokens->push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), type});
+        }
+    };
+    auto classOf = [&spec](char c) { return spec.charClass[static_cast<unsigned char>(c)]; };
+    auto commentAt = [&](size_t pos) {
+        if (startsWith(text, pos, spec.blockOpen)) return true;
+        if (!startsWith(text, pos, spec.lineComment)) return false;
+        return !spec.commentNeedsSpace || pos == 0 || (classOf(text[pos - 1]) & CC_SPACE);
+    };
+
+    // Finish a construct left open by the previous line
+    switch (state) {
+        case BLOCK_COMMENT: {
+            size_t close = text.find(spec.blockClose);
+            if (close == std::string_view::npos) {
+                emit(0, n, TokenType::COMMENT);
+                return BLOCK_COMMENT;
+            }
+            i = close + std::strlen(spec.blockClose);
+            emit(0, i, TokenType::COMMENT);
+            break;
+        }
+        case PREPROCESSOR_LINE:
+            emit(0, n, TokenType::PREPROCESSOR);
+            return endsWithBackslash(text) ? PREPROCESSOR_LINE : NORMAL;
+        case TEMPLATE_STRING:
+        case TRIPLE_DOUBLE:
+        case TRIPLE_SINGLE:
+        case DOUBLE_STRING:
+        case SINGLE_STRING: {
+            bool escapes = state != SINGLE_STRING || spec.singleQuoteEscapes;
+            size_t end = 0;
+            if (!scanString(text, 0, state, escapes, end)) {
+                emit(0, n, TokenType::STRING);
+                return state;
+            }
+            emit(0, end, TokenType::STRING);
+            i = end;
+            break;
+        }
+        default:
+            break;
+    }
+
+    while (i < n) {
+        const char c = text[i];
+        const uint8_t cls = classOf(c);
+
+        if (cls & CC_SPACE) {
+            ++i;
+            continue;
+        }
+
+        if (commentAt(i)) {
+            if (startsWith(text, i, spec.lineComment)) {
+                emit(i, n, TokenType::COMMENT);
+                return NORMAL;
+            }
+            size_t open = std::strlen(spec.blockOpen);
+            size_t close = text.find(spec.blockClose, i + open);
+            if (close == std::string_view::npos) {
+                emit(i, n, TokenType::COMMENT);
+                return BLOCK_COMMENT;
+            }
+            size_t end = close + std::strlen(spec.blockClose);
+            emit(i, end, TokenType::COMMENT);
+            i = end;
+            continue;
+        }
+
+        if (spec.preprocessor && c == '#' && text.find_first_not_of(" \t") == i) {
+            emit(i, n, TokenType::PREPROCESSOR);
+            return endsWithBackslash(text) ? PREPROCESSOR_LINE : NORMAL;
+        }
+
+        if (std::strchr(spec.quotes, c)) {
+            uint8_t stringState;
+            size_t bodyStart = i + 1;
+            if (spec.tripleQuotes && i + 2 < n && text[i + 1] == c && text[i + 2] == c) {
+                stringState = c == '"' ? TRIPLE_DOUBLE : TRIPLE_SINGLE;
+                bodyStart = i + 3;
+            } else if (c == '`') {
+                stringState = TEMPLATE_STRING;
+            } else {
+                stringState = c == '"' ? DOUBLE_STRING : SINGLE_STRING;
+            }
+
+            bool escapes = stringState != SINGLE_STRING || spec.singleQuoteEscapes;
+            size_t end = 0;
+            if (scanString(text, bodyStart, stringState, escapes, end)) {
+                emit(i, end, TokenType::STRING);
+                i = end;
+                continue;
+            }
+
+            // Unterminated: only some strings carry over to the next line
+            emit(i, n, TokenType::STRING);
+            bool spans = stringState == TRIPLE_DOUBLE || stringState == TRIPLE_SINGLE ||
+                         (stringState == TEMPLATE_STRING && spec.templateStrings) ||
+                         spec.multilineQuotes;
+            return spans ? stringState : static_cast<uint8_t>(NORMAL);
+        }
+
+        if (spec.shellVariables && c == '$') {
+            size_t j = i + 1;
+            if (j < n && text[j] == '{') {
+                size_t close = text.find('}', j);
+                j = close == std::string_view::npos ? n : close + 1;
+            } else {
+                while (j < n && (classOf(text[j]) & CC_IDENT)) ++j;
+                if (j == i + 1 && j < n) ++j;  // $?, $@, $#, ...
+            }
+            emit(i, j, TokenType::VARIABLE);
+            i = j;
+            continue;
+        }
+
+        if ((cls & CC_DIGIT) || (c == '.' && i + 1 < n && (classOf(text[i + 1]) & CC_DIGIT))) {
+            size_t j = i + 1;
+            while (j < n) {
+                char d = text[j];
+                if ((classOf(d) & CC_IDENT) || d == '.') {
+                    ++j;
+                } else if ((d == '+' || d == '-') && (text[j - 1] == 'e' || text[j - 1] == 'E')) {
+                    ++j;
+                } else if (d == '\'' && spec.preprocessor && j + 1 < n && (classOf(text[j + 1]) & CC_DIGIT)) {
+                    ++j;  // C++14 digit separator
+                } else {
+                    break;
+                }
+            }
+            emit(i, j, TokenType::NUMBER);
+            i = j;
+            continue;
+        }
+
+        if (cls & CC_IDENT_START) {
+            size_t j = i + 1;
+            while (j < n && (classOf(text[j]) & CC_IDENT)) ++j;
+            emit(i, j, spec.isKeyword(text.substr(i, j - i)) ? TokenType::KEYWORD : TokenType::IDENTIFIER);
+            i = j;
+            continue;
+        }
+
+        if (cls & CC_OPERATOR) {
+            size_t j = i + 1;
+            while (j < n && (classOf(text[j]) & CC_OPERATOR) && !commentAt(j)) ++j;
+            emit(i, j, TokenType::OPERATOR);
+            i = j;
+            continue;
+        }
+
+        emit(i, i + 1, TokenType::PUNCTUATION);
+        ++i;
+    }
+
+    return NORMAL;
+}
@@ -0,0 +1,670 @@
+#include "text_buffer.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+inline int popcount32(uint32_t v) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt(v));
+#else
+    return __builtin_popcount(v);
+#endif
+}
+
+inline int ctz32(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+#if defined(__AVX2__)
+constexpr size_t kLineFeedBlock = 32;
+#elif defined(__SSE2__) || defined(_M_X64)
+constexpr size_t kLineFeedBlock = 16;
+#else
+constexpr size_t kLineFeedBlock = 0;
+#endif
+
+// Bitmask of '\n' bytes in the kLineFeedBlock bytes starting at data
+inline uint32_t lineFeedMask(const char* data) {
+#if defined(__AVX2__)
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))));
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+#else
+    (void)data;
+    return 0;
+#endif
+}
+
+// A batch whose pieces would average fewer bytes than this is flattened
+constexpr size_t kMinBatchPieceBytes = 256;
+
+// Capacity reserved for each add buffer block
+constexpr size_t kAddBlockSize = 64 * 1024;
+
+} // namespace
+
+// ============================================================================
+// ChunkIterator
+// ============================================================================
+
+TextBuffer::ChunkIterator& TextBuffer::ChunkIterator::operator++() {
+    advance();
+    return *this;
+}
+
+void TextBuffer::ChunkIterator::advance() {
+    if (remaining_ == 0 || stack_.empty()) {
+        current_ = std::string_view();
+        stack_.clear();
+        return;
+    }
+
+    const Node* node = stack_.back();
+    stack_.pop_back();
+    for (const Node* n = node->right.get(); n; n = n->left.get()) {
+        stack_.push_back(n);
+    }
+
+    const char* data = buffer_->pieceData(node->piece) + skip_;
+    size_t len = std::min(node->piece.length - skip_, remaining_);
+    skip_ = 0;
+    remaining_ -= len;
+    current_ = std::string_view(data, len);
+}
+
+// ============================================================================
+// TextBuffer
+// ============================================================================
+
+TextBuffer::TextBuffer() : seed_(0x9E3779B9u), ownsTail_(true) {
+    resetOriginal(nullptr, std::string_view(), {});
+}
+
+TextBuffer::TextBuffer(std::string text) : seed_(0x9E3779B9u), ownsTail_(true) {
+    setText(std::move(text));
+}
+
+TextBuffer::TextBuffer(const TextBuffer& other)
+    : blocks_(other.blocks_), mappedFile_(other.mappedFile_), root_(other.root_),
+      seed_(other.seed_), ownsTail_(false) {
+    // Both sides now share the tail block; the next append on either side
+    // starts a fresh one
+    other.ownsTail_ = false;
+}
+
+TextBuffer& TextBuffer::operator=(const TextBuffer& other) {
+    if (this != &other) {
+        blocks_ = other.blocks_;
+        mappedFile_ = other.mappedFile_;
+        root_ = other.root_;
+        seed_ = other.seed_;
+        ownsTail_ = false;
+        other.ownsTail_ = false;
+    }
+    return *this;
+}
+
+void TextBuffer::setText(std::string text) {
+    auto owned = std::make_shared<const std::string>(std::move(text));
+    std::vector<size_t> lineFeeds;
+    lineFeeds.reserve(countLineFeeds(owned->data(), owned->size()));
+    findLineFeeds(owned->data(), owned->size(), 0, lineFeeds);
+
+    mappedFile_.reset();
+    std::string_view view(*owned);
+    resetOriginal(std::move(owned), view, std::move(lineFeeds));
+}
+
+void TextBuffer::setText(std::shared_ptr<const MappedFile> file) {
+    // Single streaming pass: counting first would fault every page twice
+    std::vector<size_t> lineFeeds;
+    file->advise(MappedFile::Access::SEQUENTIAL);
+    findLineFeeds(file->data(), file->size(), 0, lineFeeds);
+    file->release();
+    file->advise(MappedFile::Access::RANDOM);
+    lineFeeds.shrink_to_fit();
+
+    mappedFile_ = file;
+    resetOriginal(file, file->view(), std::move(lineFeeds));
+}
+
+void TextBuffer::resetOriginal(std::shared_ptr<const void> owner, std::string_view text,
+                               std::vector<size_t> lineFeeds) {
+    auto original = std::make_shared<Block>();
+    original->owner = std::move(owner);
+    original->data = text.data();
+    original->size = text.size();
+    original->lineFeeds = std::move(lineFeeds);
+
+    // A fresh list: snapshots of the previous document keep the old one
+    blocks_ = std::make_shared<BlockList>();
+    blocks_->push_back(std::move(original));
+    ownsTail_ = true;
+
+    root_.reset();
+    if (!text.empty()) {
+        root_ = makeLeaf(makePiece(0, 0, text.size()));
+    }
+}
+
+TextBuffer::Piece TextBuffer::appendText(std::string_view text) {
+    uint32_t index = static_cast<uint32_t>(blocks_->size() - 1);
+    Block* tail = blocks_->back().get();
+
+    // Once every snapshot that could see the tail block is gone, take it back
+    if (!ownsTail_ && blocks_.use_count() == 1 && blocks_->back().use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        ownsTail_ = true;
+    }
+
+    // Block 0 is the original text and is never appended to
+    if (index == 0 || !ownsTail_ || tail->text.capacity() - tail->size < text.size()) {
+        if (blocks_.use_count() > 1) {
+            blocks_ = std::make_shared<BlockList>(*blocks_);
+        }
+        auto block = std::make_shared<Block>();
+        block->text.reserve(std::max(kAddBlockSize, text.size()));
+        block->data = block->text.data();
+        blocks_->push_back(block);
+        ownsTail_ = true;
+        index = static_cast<uint32_t>(blocks_->size() - 1);
+        tail = block.get();
+    }
+
+    // Within the reserved capacity the block's data pointer never moves
+    size_t start = tail->size;
+    size_t knownLineFeeds = tail->lineFeeds.size();
+    tail->text.append(text.data(), text.size());
+    findLineFeeds(text.data(), text.size(), start, tail->lineFeeds);
+    tail->size += text.size();
+    return {index, start, text.size(), tail->lineFeeds.size() - knownLineFeeds};
+}
+
+size_t TextBuffer::length() const {
+    return lengthOf(root_);
+}
+
+size_t TextBuffer::pieceCount() const {
+    return countOf(root_);
+}
+
+void TextBuffer::insert(size_t offset, std::string_view text) {
+    if (text.empty()) return;
+    offset = std::min(offset, length());
+
+    NodePtr left, right;
+    split(root_, offset, left, right);
+
+    // Consecutive typing lands right after the last add-buffer piece, so grow
+    // that piece instead of creating a new one per keystroke
+    Piece piece = appendText(text);
+    if (endsRightBefore(left, piece)) {
+        left = extendRightmost(left, piece.length, piece.lineFeeds);
+    } else {
+        left = merge(left, makeLeaf(piece));
+    }
+
+    root_ = merge(left, right);
+}
+
+void TextBuffer::erase(size_t offset, size_t count) {
+    size_t total = length();
+    if (offset >= total || count == 0) return;
+    count = std::min(count, total - offset);
+
+    NodePtr left, middle, right;
+    split(root_, offset, left, middle);
+    split(middle, count, middle, right);
+    root_ = merge(left, right);
+}
+
+bool TextBuffer::applyEdits(const std::vector<Edit>& edits) {
+    size_t total = length();
+    size_t previousEnd = 0;
+    for (const Edit& edit : edits) {
+        if (edit.offset < previousEnd || edit.offset > total || edit.length > total - edit.offset) {
+            return false;
+        }
+        previousEnd = edit.offset + edit.length;
+    }
+    if (edits.empty()) return true;
+
+    // Dense batches (a rename touching every line) would shred the document
+    // into tiny pieces; splice those into one contiguous run of new text
+    // instead. Sparse batches over large files keep their pieces.
+    size_t spanStart = edits.front().offset;
+    size_t spanEnd = edits.back().offset + edits.back().length;
+    size_t insertedBytes = 0;
+    for (const Edit& edit : edits) insertedBytes += edit.text.size();
+    if (edits.size() > 1 && (spanEnd - spanStart) + insertedBytes < edits.size() * kMinBatchPieceBytes) {
+        std::string merged;
+        merged.reserve(spanEnd - spanStart + insertedBytes);
+
+        // One chunk walk over the span, copying kept text and skipping removed text
+        ChunkIterator it = chunks(spanStart, spanEnd - spanStart);
+        std::string_view current = *it;
+        auto consume = [&](size_t count, bool keep) {
+            while (count > 0) {
+                if (current.empty()) current = *++it;
+                size_t take = std::min(count, current.size());
+                if (keep) merged.append(current.data(), take);
+                current.remove_prefix(take);
+                count -= take;
+            }
+        };
+
+        size_t position = spanStart;
+        for (const Edit& edit : edits) {
+            consume(edit.offset - position, true);
+            merged.append(edit.text.data(), edit.text.size());
+            consume(edit.length, false);
+            position = edit.offset + edit.length;
+        }
+        return applyEdits({{spanStart, spanEnd - spanStart, merged}});
+    }
+
+    std::vector<Piece> pieces;
+    pieces.reserve(countOf(root_) + 2 * edits.size());
+
+    // Append a piece, folding it into the previous one when they are adjacent
+    // in the same source (e.g. consecutive replacement texts)
+    auto emit = [&pieces](const Piece& piece) {
+        if (piece.length == 0) return;
+        if (!pieces.empty()) {
+            Piece& last = pieces.back();
+            if (last.block == piece.block && last.start + last.length == piece.start) {
+                last.length += piece.length;
+                last.lineFeeds += piece.lineFeeds;
+                return;
+            }
+        }
+        pieces.push_back(piece);
+    };
+    auto emitText = [&](std::string_view text) {
+        if (!text.empty()) emit(appendText(text));
+    };
+    // Emit the document range [from, to) of a piece that starts at base
+    auto emitSlice = [&](const Piece& piece, size_t base, size_t from, size_t to) {
+        if (from >= to) return;
+        if (from == base && to == base + piece.length) {
+            emit(piece);
+        } else {
+            emit(makePiece(piece.block, piece.start + (from - base), to - from));
+        }
+    };
+
+    // In-order walk of the current pieces, splicing edits in as they come up
+    size_t next = 0;
+    size_t position = 0;
+    size_t deletedUntil = 0;
+    std::vector<const Node*> stack;
+    const Node* node = root_.get();
+    while (node || !stack.empty()) {
+        while (node) {
+            stack.push_back(node);
+            node = node->left.get();
+        }
+        node = stack.back();
+        stack.pop_back();
+
+        const Piece& piece = node->piece;
+        size_t end = position + piece.length;
+        size_t cursor = std::max(position, deletedUntil);
+        while (next < edits.size() && edits[next].offset <= end) {
+            const Edit& edit = edits[next++];
+            emitSlice(piece, position, cursor, edit.offset);
+            emitText(edit.text);
+            deletedUntil = edit.offset + edit.length;
+            cursor = std::max(cursor, deletedUntil);
+        }
+        emitSlice(piece, position, std::min(cursor, end), end);
+
+        position = end;
+        node = node->right.get();
+    }
+    // Only reachable for an empty document
+    for (; next < edits.size(); ++next) {
+        emitText(edits[next].text);
+    }
+
+    root_ = buildTree(pieces);
+    return true;
+}
+
+char TextBuffer::charAt(size_t offset) const {
+    const Node* node = root_.get();
+    while (node) {
+        size_t leftLength = lengthOf(node->left);
+        if (offset < leftLength) {
+            node = node->left.get();
+        } else if (offset < leftLength + node->piece.length) {
+            return pieceData(node->piece)[offset - leftLength];
+        } else {
+            offset -= leftLength + node->piece.length;
+            node = node->right.get();
+        }
+    }
+    return '\0';
+}
+
+std::string TextBuffer::substr(size_t offset, size_t count) const {
+    std::string result;
+    size_t total = length();
+    if (offset >= total) return result;
+    count = std::min(count, total - offset);
+
+    result.reserve(count);
+    for (auto it = chunks(offset, count); it != ChunkIterator(); ++it) {
+        result.append((*it).data(), (*it).size());
+    }
+    return result;
+}
+
+TextBuffer::View TextBuffer::view(size_t offset, size_t count) const {
+    size_t total = length();
+    offset = std::min(offset, total);
+    return View(*this, offset, std::min(count, total - offset));
+}
+
+TextBuffer::ChunkIterator TextBuffer::chunks(size_t offset, size_t count) const {
+    ChunkIterator it;
+    it.buffer_ = this;
+
+    size_t total = length();
+    if (offset >= total || count == 0) return it;
+    it.remaining_ = std::min(count, total - offset);
+
+    const Node* node = root_.get();
+    while (node) {
+        size_t leftLength = lengthOf(node->left);
+        if (offset < leftLength) {
+            it.stack_.push_back(node);
+            node = node->left.get();
+        } else if (offset < leftLength + node->piece.length) {
+            it.stack_.push_back(node);
+            it.skip_ = offset - leftLength;
+            break;
+        } else {
+            offset -= leftLength + node->piece.length;
+            node = node->right.get();
+        }
+    }
+
+    it.advance();
+    return it;
+}
+
+size_t TextBuffer::offsetAt(int line, int column) const {
+    size_t target = static_cast<size_t>(std::max(line, 0));
+    if (target >= lineCount()) return length();
+
+    size_t start = lineStart(target);
+    size_t end = lineEnd(target);
+    return start + std::min(static_cast<size_t>(std::max(column, 0)), end - start);
+}
+
+void TextBuffer::positionAt(size_t offset, int& line, int& column) const {
+    offset = std::min(offset, length());
+    size_t remaining = offset;
+    size_t lines = 0;
+
+    const Node* node = root_.get();
+    while (node) {
+        size_t leftLength = lengthOf(node->left);
+        const Piece& piece = node->piece;
+        if (remaining < leftLength) {
+            node = node->left.get();
+        } else if (remaining < leftLength + piece.length) {
+            const std::vector<size_t>& feeds = blockOf(piece).lineFeeds;
+            auto first = std::lower_bound(feeds.begin(), feeds.end(), piece.start);
+            auto last = std::lower_bound(first, feeds.end(), piece.start + (remaining - leftLength));
+            lines += lineFeedsOf(node->left) + static_cast<size_t>(last - first);
+            break;
+        } else {
+            lines += lineFeedsOf(node->left) + piece.lineFeeds;
+            remaining -= leftLength + piece.length;
+            node = node->right.get();
+        }
+    }
+
+    line = static_cast<int>(lines);
+    column = static_cast<int>(offset - lineStart(lines));
+}
+
+size_t TextBuffer::lineCount() const {
+    return lineFeedsOf(root_) + 1;
+}
+
+size_t TextBuffer::lineStart(size_t line) const {
+    if (line == 0) return 0;
+    if (line >= lineCount()) return length();
+    return nthLineFeed(line - 1) + 1;
+}
+
+size_t TextBuffer::lineEnd(size_t line) const {
+    if (line + 1 >= lineCount()) return length();
+    return nthLineFeed(line);
+}
+
+std::string TextBuffer::getLine(size_t line) const {
+    if (line >= lineCount()) return "";
+    size_t start = lineStart(line);
+    return substr(start, lineEnd(line) - start);
+}
+
+size_t TextBuffer::countLineFeeds(const char* data, size_t length) {
+    size_t count = 0;
+    size_t i = 0;
+    for (; kLineFeedBlock != 0 && i + kLineFeedBlock <= length; i += kLineFeedBlock) {
+        count += static_cast<size_t>(popcount32(lineFeedMask(data + i)));
+    }
+    for (; i < length; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+void TextBuffer::findLineFeeds(const char* data, size_t length, size_t base,
+                               std::vector<size_t>& positions) {
+    size_t i = 0;
+    for (; kLineFeedBlock != 0 && i + kLineFeedBlock <= length; i += kLineFeedBlock) {
+        uint32_t mask = lineFeedMask(data + i);
+        while (mask) {
+            positions.push_back(base + i + static_cast<size_t>(ctz32(mask)));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < length; ++i) {
+        if (data[i] == '\n') positions.push_back(base + i);
+    }
+}
+
+// ============================================================================
+// Treap internals
+// ============================================================================
+
+TextBuffer::NodePtr TextBuffer::makeNode(const Piece& piece, uint32_t priority,
+                                         NodePtr left, NodePtr right) {
+    auto node = std::make_shared<Node>();
+    node->piece = piece;
+    node->priority = priority;
+    node->subtreeLength = lengthOf(left) + piece.length + lengthOf(right);
+    node->subtreeLineFeeds = lineFeedsOf(left) + piece.lineFeeds + lineFeedsOf(right);
+    node->subtreeCount = countOf(left) + 1 + countOf(right);
+    node->left = std::move(left);
+    node->right = std::move(right);
+    return node;
+}
+
+TextBuffer::NodePtr TextBuffer::makeLeaf(const Piece& piece) {
+    return makeNode(piece, nextPriority(), nullptr, nullptr);
+}
+
+uint32_t TextBuffer::nextPriority() {
+    // xorshift32
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
+TextBuffer::Piece TextBuffer::makePiece(uint32_t block, size_t start, size_t length) const {
+    const std::vector<size_t>& feeds = (*blocks_)[block]->lineFeeds;
+    auto first = std::lower_bound(feeds.begin(), feeds.end(), start);
+    auto last = std::lower_bound(first, feeds.end(), start + length);
+    return {block, start, length, static_cast<size_t>(last - first)};
+}
+
+size_t TextBuffer::nthLineFeed(size_t n) const {
+    size_t base = 0;
+    const Node* node = root_.get();
+    while (node) {
+        size_t leftFeeds = lineFeedsOf(node->left);
+        const Piece& piece = node->piece;
+        if (n < leftFeeds) {
+            node = node->left.get();
+        } else if (n < leftFeeds + piece.lineFeeds) {
+            const std::vector<size_t>& feeds = blockOf(piece).lineFeeds;
+            auto first = std::lower_bound(feeds.begin(), feeds.end(), piece.start);
+            size_t position = *(first + static_cast<std::ptrdiff_t>(n - leftFeeds));
+            return base + lengthOf(node->left) + (position - piece.start);
+        } else {
+            n -= leftFeeds + piece.lineFeeds;
+            base += lengthOf(node->left) + piece.length;
+            node = node->right.get();
+        }
+    }
+    return length();
+}
+
+size_t TextBuffer::lengthOf(const NodePtr& node) {
+    return node ? node->subtreeLength : 0;
+}
+
+size_t TextBuffer::lineFeedsOf(const NodePtr& node) {
+    return node ? node->subtreeLineFeeds : 0;
+}
+
+size_t TextBuffer::countOf(const NodePtr& node) {
+    return node ? node->subtreeCount : 0;
+}
+
+void TextBuffer::split(const NodePtr& target, size_t offset, NodePtr& left, NodePtr& right) const {
+    // Hold our own reference: callers may pass one of the outputs as input
+    NodePtr node = target;
+    if (!node) {
+        left.reset();
+        right.reset();
+        return;
+    }
+
+    size_t leftLength = lengthOf(node->left);
+    const Piece& piece = node->piece;
+
+    if (offset <= leftLength) {
+        NodePtr innerRight;
+        split(node->left, offset, left, innerRight);
+        right = makeNode(piece, node->priority, innerRight, node->right);
+    } else if (offset >= leftLength + piece.length) {
+        NodePtr innerLeft;
+        split(node->right, offset - leftLength - piece.length, innerLeft, right);
+        left = makeNode(piece, node->priority, node->left, innerLeft);
+    } else {
+        // Offset falls inside this piece: cut it in two, both halves keep the
+        // node's priority so the heap order stays valid on each side
+        size_t head = offset - leftLength;
+        Piece first = makePiece(piece.block, piece.start, head);
+        Piece second{piece.block, piece.start + head, piece.length - head,
+                     piece.lineFeeds - first.lineFeeds};
+        left = makeNode(first, node->priority, node->left, nullptr);
+        right = makeNode(second, node->priority, nullptr, node->right);
+    }
+}
+
+TextBuffer::NodePtr TextBuffer::merge(const NodePtr& left, const NodePtr& right) {
+    if (!left) return right;
+    if (!right) return left;
+
+    if (left->priority >= right->priority) {
+        return makeNode(left->piece, left->priority, left->left, merge(left->right, right));
+    }
+    return makeNode(right->piece, right->priority, merge(left, right->left), right->right);
+}
+
+TextBuffer::NodePtr TextBuffer::buildTree(const std::vector<Piece>& pieces) {
+    // Linear-time Cartesian tree over fresh random priorities, built on
+    // indices first and then materialized bottom-up as immutable nodes
+    const size_t none = static_cast<size_t>(-1);
+    size_t count = pieces.size();
+    std::vector<uint32_t> priority(count);
+    std::vector<size_t> left(count, none);
+    std::vector<size_t> right(count, none);
+    std::vector<size_t> spine;
+
+    for (size_t i = 0; i < count; ++i) {
+        priority[i] = nextPriority();
+        size_t last = none;
+        while (!spine.empty() && priority[spine.back()] < priority[i]) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        left[i] = last;
+        if (!spine.empty()) right[spine.back()] = i;
+        spine.push_back(i);
+    }
+    if (spine.empty()) return nullptr;
+
+    struct Builder {
+        const std::vector<Piece>& pieces;
+        const std::vector<uint32_t>& priority;
+        const std::vector<size_t>& left;
+        const std::vector<size_t>& right;
+        size_t none;
+
+        NodePtr build(size_t i) const {
+            if (i == none) return nullptr;
+            return makeNode(pieces[i], priority[i], build(left[i]), build(right[i]));
+        }
+    };
+    return Builder{pieces, priority, left, right, none}.build(spine.front());
+}
+
+TextBuffer::NodePtr TextBuffer::extendRightmost(const NodePtr& node, size_t extra,
+                                                size_t extraLineFeeds) {
+    if (!node->right) {
+        Piece grown = node->piece;
+        grown.length += extra;
+        grown.lineFeeds += extraLineFeeds;
+        return makeNode(grown, node->priority, node->left, nullptr);
+    }
+    return makeNode(node->piece, node->priority, node->left,
+                    extendRightmost(node->right, extra, extraLineFeeds));
+}
+
+bool TextBuffer::endsRightBefore(const NodePtr& node, const Piece& piece) {
+    if (!node) return false;
+    const Node* n = node.get();
+    while (n->right) n = n->right.get();
+    return n->piece.block == piece.block && n->piece.start + n->piece.length == piece.start;
+}
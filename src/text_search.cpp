@@ -0,0 +1,690 @@
+#include "text_search.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace HybridIDE;
+
+namespace {
+
+inline char foldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+inline int ctz32(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+#if defined(__AVX2__)
+constexpr size_t kSearchBlock = 32;
+using Block = __m256i;
+
+inline Block loadBlock(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const Block*>(p)); }
+inline Block splat(char c) { return _mm256_set1_epi8(c); }
+inline uint32_t matchMask(Block a, Block b, Block x, Block y) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, x), _mm256_cmpeq_epi8(b, y))));
+}
+inline Block foldBlock(Block v) {
+    Block upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                   _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+constexpr size_t kSearchBlock = 16;
+using Block = __m128i;
+
+inline Block loadBlock(const char* p) { return _mm_loadu_si128(reinterpret_cast<const Block*>(p)); }
+inline Block splat(char c) { return _mm_set1_epi8(c); }
+inline uint32_t matchMask(Block a, Block b, Block x, Block y) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, x), _mm_cmpeq_epi8(b, y))));
+}
+inline Block foldBlock(Block v) {
+    Block upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#else
+constexpr size_t kSearchBlock = 0;
+#endif
+
+// Calls fn(line, lineOffset) for every line of the buffer without copying
+// lines that sit inside a single chunk; stops when fn returns false
+template <typename Fn>
+bool forEachLine(const TextBuffer& buffer, Fn fn) {
+    std::string pending;
+    size_t pendingOffset = 0;
+    size_t offset = 0;
+
+    for (auto it = buffer.chunks(0, buffer.length()); it != TextBuffer::ChunkIterator(); ++it) {
+        std::string_view chunk = *it;
+        size_t pos = 0;
+        while (pos < chunk.size()) {
+            size_t nl = chunk.find('\n', pos);
+            if (nl == std::string_view::npos) {
+                if (pending.empty()) pendingOffset = offset + pos;
+                pending.append(chunk.data() + pos, chunk.size() - pos);
+                break;
+            }
+            if (pending.empty()) {
+                if (!fn(chunk.substr(pos, nl - pos), offset + pos)) return false;
+            } else {
+                pending.append(chunk.data() + pos, nl - pos);
+                if (!fn(std::string_view(pending), pendingOffset)) return false;
+                pending.clear();
+            }
+            pos = nl + 1;
+        }
+        offset += chunk.size();
+    }
+
+    return fn(std::string_view(pending), pending.empty() ? offset : pendingOffset);
+}
+
+} // namespace
+
+// ============================================================================
+// LiteralSearcher
+// ============================================================================
+
+LiteralSearcher::LiteralSearcher(std::string_view needle, bool caseSensitive)
+    : needle_(needle), caseSensitive_(caseSensitive) {
+    if (!caseSensitive_) {
+        std::transform(needle_.begin(), needle_.end(), needle_.begin(), foldAscii);
+    }
+}
+
+bool LiteralSearcher::matchesAt(const char* data) const {
+    if (caseSensitive_) {
+        return std::memcmp(data, needle_.data(), needle_.size()) == 0;
+    }
+    for (size_t i = 0; i < needle_.size(); ++i) {
+        if (foldAscii(data[i]) != needle_[i]) return false;
+    }
+    return true;
+}
+
+size_t LiteralSearcher::find(const char* data, size_t length, size_t from) const {
+    size_t n = needle_.size();
+    if (n == 0 || length < n || from > length - n) return npos;
+
+    size_t i = from;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    // Compare the first and last needle bytes against two shifted blocks; only
+    // positions where both agree get a full comparison
+    const Block first = splat(needle_[0]);
+    const Block last = splat(needle_[n - 1]);
+    for (; i + n - 1 + kSearchBlock <= length; i += kSearchBlock) {
+        Block head = loadBlock(data + i);
+        Block tail = loadBlock(data + i + n - 1);
+        if (!caseSensitive_) {
+            head = foldBlock(head);
+            tail = foldBlock(tail);
+        }
+        uint32_t mask = matchMask(head, tail, first, last);
+        while (mask) {
+            size_t candidate = i + static_cast<size_t>(ctz32(mask));
+            if (matchesAt(data + candidate)) return candidate;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    const char firstByte = needle_[0];
+    for (; i + n <= length; ++i) {
+        char c = caseSensitive_ ? data[i] : foldAscii(data[i]);
+        if (c == firstByte && matchesAt(data + i)) return i;
+    }
+    return npos;
+}
+
+// ============================================================================
+// RegexSearcher
+// ============================================================================
+
+RegexSearcher::RegexSearcher(const std::string& pattern, bool caseSensitive)
+    : caseSensitive_(caseSensitive), valid_(false) {
+    pattern_ = &pattern;
+    pos_ = 0;
+
+    Fragment root;
+    if (!parseAlternation(root)) {
+        pattern_ = nullptr;
+        return;
+    }
+    if (pos_ != pattern.size()) {
+        error_ = "Unexpected ')' at position " + std::to_string(pos_);
+        pattern_ = nullptr;
+        return;
+    }
+    pattern_ = nullptr;
+
+    int match = addState(NfaType::MATCH);
+    patch(root, match);
+
+    forward_.start(root.start);
+    buildReverse(root.start);
+    valid_ = true;
+}
+
+// The reversed NFA runs over a line from its end: every edge x -> y becomes
+// y -> x, and ^ and $ swap, since the reversed line starts where the line
+// ends. A leading loop over any byte lets the match end anywhere, and
+// reaching the pattern's start means a match begins where the run is.
+void RegexSearcher::buildReverse(int nfaStart) {
+    const std::vector<NfaState>& nfa = forward_.nfa;
+    std::vector<NfaState>& reversed = reverse_.nfa;
+
+    std::vector<std::vector<int>> into(nfa.size());   // the states with an edge to each state
+    for (size_t x = 0; x < nfa.size(); ++x) {
+        if (nfa[x].out >= 0) into[nfa[x].out].push_back(static_cast<int>(x));
+        if (nfa[x].type == NfaType::SPLIT && nfa[x].out1 >= 0) into[nfa[x].out1].push_back(static_cast<int>(x));
+    }
+
+    auto add = [&reversed](NfaType type, int out) {
+        NfaState state;
+        state.type = type;
+        state.out = out;
+        reversed.push_back(state);
+        return static_cast<int>(reversed.size()) - 1;
+    };
+
+    // State y of the reversed NFA is a chain of splits over y's incoming edges
+    for (size_t y = 0; y < nfa.size(); ++y) add(NfaType::SPLIT, -1);
+    for (size_t y = 0; y < nfa.size(); ++y) {
+        std::vector<int> targets;
+        for (int x : into[y]) {
+            switch (nfa[x].type) {
+                case NfaType::SPLIT:
+                    targets.push_back(x);
+                    break;
+                case NfaType::LINE_START:
+                    targets.push_back(add(NfaType::LINE_END, x));
+                    break;
+                case NfaType::LINE_END:
+                    targets.push_back(add(NfaType::LINE_START, x));
+                    break;
+                case NfaType::BYTES: {
+                    int state = add(NfaType::BYTES, x);
+                    reversed[state].bytes = nfa[x].bytes;
+                    targets.push_back(state);
+                    break;
+                }
+                case NfaType::MATCH:
+                    break;
+            }
+        }
+        if (static_cast<int>(y) == nfaStart) targets.push_back(add(NfaType::MATCH, -1));
+
+        int link = static_cast<int>(y);
+        for (size_t k = 0; k < targets.size(); ++k) {
+            reversed[link].out = targets[k];
+            if (k + 1 == targets.size()) break;
+            int next = add(NfaType::SPLIT, -1);
+            reversed[link].out1 = next;
+            link = next;
+        }
+    }
+
+    int loop = add(NfaType::SPLIT, -1);
+    int anyByte = add(NfaType::BYTES, loop);
+    reversed[anyByte].bytes.invert();
+    reversed[loop].out = anyByte;
+    reversed[loop].out1 = static_cast<int>(nfa.size()) - 1;   // the match state, added last
+    reverse_.start(loop);
+}
+
+void RegexSearcher::findAll(std::string_view line, const MatchCallback& onMatch) {
+    if (!valid_) return;
+
+    // Backwards over the line: after reading back to position p, an
+    // accepting state means a match starts at p
+    size_t length = line.size();
+    starts_.assign(length + 1, 0);
+    int state = reverse_.startState[1];
+    for (size_t p = length;; --p) {
+        const DfaState& current = reverse_.dfa[state];
+        starts_[p] = current.accepting || (p == 0 && current.acceptingAtLineEnd);
+        if (p == 0) break;
+        state = reverse_.step(state, static_cast<unsigned char>(line[p - 1]));
+        if (state < 0) break;
+    }
+
+    for (size_t from = 0; from <= length; ++from) {
+        if (!starts_[from]) continue;
+        size_t end = longestMatch(line, from);
+        if (end == npos) continue;
+        if (!onMatch(from, end)) return;
+        if (end > from) from = end - 1;
+    }
+}
+
+size_t RegexSearcher::longestMatch(std::string_view line, size_t start) {
+    int state = forward_.startState[start == 0 ? 1 : 0];
+    size_t lastEnd = forward_.dfa[state].accepting ||
+                     (start == line.size() && forward_.dfa[state].acceptingAtLineEnd) ? start : npos;
+    for (size_t j = start; j < line.size(); ++j) {
+        state = forward_.step(state, static_cast<unsigned char>(line[j]));
+        if (state < 0) break;
+        if (forward_.dfa[state].accepting ||
+            (j + 1 == line.size() && forward_.dfa[state].acceptingAtLineEnd)) {
+            lastEnd = j + 1;
+        }
+    }
+    return lastEnd;
+}
+
+int RegexSearcher::addState(NfaType type, int out, int out1) {
+    NfaState state;
+    state.type = type;
+    state.out = out;
+    state.out1 = out1;
+    forward_.nfa.push_back(state);
+    return static_cast<int>(forward_.nfa.size()) - 1;
+}
+
+void RegexSearcher::patch(const Fragment& fragment, int target) {
+    for (const auto& out : fragment.outs) {
+        if (out.second == 0) {
+            forward_.nfa[out.first].out = target;
+        } else {
+            forward_.nfa[out.first].out1 = target;
+        }
+    }
+}
+
+bool RegexSearcher::parseAlternation(Fragment& result) {
+    if (!parseConcatenation(result)) return false;
+
+    while (pos_ < pattern_->size() && (*pattern_)[pos_] == '|') {
+        ++pos_;
+        Fragment right;
+        if (!parseConcatenation(right)) return false;
+
+        int split = addState(NfaType::SPLIT, result.start, right.start);
+        result.start = split;
+        result.outs.insert(result.outs.end(), right.outs.begin(), right.outs.end());
+    }
+    return true;
+}
+
+bool RegexSearcher::parseConcatenation(Fragment& result) {
+    // An empty branch matches the empty string
+    int empty = addState(NfaType::SPLIT);
+    result.start = empty;
+    result.outs = {{empty, 0}};
+
+    while (pos_ < pattern_->size() && (*pattern_)[pos_] != '|' && (*pattern_)[pos_] != ')') {
+        Fragment next;
+        if (!parseRepetition(next)) return false;
+        patch(result, next.start);
+        result.outs = std::move(next.outs);
+    }
+    return true;
+}
+
+bool RegexSearcher::parseRepetition(Fragment& result) {
+    if (!parseAtom(result)) return false;
+
+    while (pos_ < pattern_->size()) {
+        char op = (*pattern_)[pos_];
+        if (op != '*' && op != '+' && op != '?') break;
+        ++pos_;
+
+        int split = addState(NfaType::SPLIT, result.start);
+        if (op == '*') {
+            patch(result, split);
+            result.start = split;
+            result.outs = {{split, 1}};
+        } else if (op == '+') {
+            patch(result, split);
+            result.outs = {{split, 1}};
+        } else {
+            result.start = split;
+            result.outs.push_back({split, 1});
+        }
+    }
+    return true;
+}
+
+bool RegexSearcher::parseAtom(Fragment& result) {
+    if (pos_ >= pattern_->size()) {
+        error_ = "Unexpected end of pattern";
+        return false;
+    }
+
+    char c = (*pattern_)[pos_++];
+    ByteSet set;
+
+    switch (c) {
+        case '(':
+            if (!parseAlternation(result)) return false;
+            if (pos_ >= pattern_->size() || (*pattern_)[pos_] != ')') {
+                error_ = "Missing ')'";
+                return false;
+            }
+            ++pos_;
+            return true;
+        case '^': {
+            int state = addState(NfaType::LINE_START);
+            result.start = state;
+            result.outs = {{state, 0}};
+            return true;
+        }
+        case '$': {
+            int state = addState(NfaType::LINE_END);
+            result.start = state;
+            result.outs = {{state, 0}};
+            return true;
+        }
+        case '*':
+        case '+':
+        case '?':
+            error_ = std::string("Nothing to repeat before '") + c + "'";
+            return false;
+        case '.':
+            set.set('\n');
+            set.invert();
+            break;
+        case '[':
+            if (!parseClass(set)) return false;
+            break;
+        case '\\':
+            if (!parseEscape(set)) return false;
+            break;
+        default:
+            set.set(static_cast<unsigned char>(c));
+            break;
+    }
+
+    if (!caseSensitive_) {
+        for (unsigned char lower = 'a'; lower <= 'z'; ++lower) {
+            unsigned char upper = static_cast<unsigned char>(lower - 0x20);
+            if (set.test(lower) || set.test(upper)) {
+                set.set(lower);
+                set.set(upper);
+            }
+        }
+    }
+
+    int state = addState(NfaType::BYTES);
+    forward_.nfa[state].bytes = set;
+    result.start = state;
+    result.outs = {{state, 0}};
+    return true;
+}
+
+bool RegexSearcher::parseClass(ByteSet& set) {
+    bool negate = pos_ < pattern_->size() && (*pattern_)[pos_] == '^';
+    if (negate) ++pos_;
+
+    bool first = true;
+    while (pos_ < pattern_->size() && ((*pattern_)[pos_] != ']' || first)) {
+        first = false;
+        unsigned char lo = static_cast<unsigned char>((*pattern_)[pos_++]);
+
+        if (lo == '\\') {
+            ByteSet escaped;
+            if (!parseEscape(escaped)) return false;
+            for (int i = 0; i < 4; ++i) set.bits[i] |= escaped.bits[i];
+            continue;
+        }
+
+        if (pos_ + 1 < pattern_->size() && (*pattern_)[pos_] == '-' && (*pattern_)[pos_ + 1] != ']') {
+            unsigned char hi = static_cast<unsigned char>((*pattern_)[pos_ + 1]);
+            pos_ += 2;
+            if (hi < lo) {
+                error_ = "Invalid character range";
+                return false;
+            }
+            for (unsigned int ch = lo; ch <= hi; ++ch) set.set(static_cast<unsigned char>(ch));
+        } else {
+            set.set(lo);
+        }
+    }
+
+    if (pos_ >= pattern_->size()) {
+        error_ = "Missing ']'";
+        return false;
+    }
+    ++pos_;
+
+    // Fold case before negating so [^a] excludes 'A' as well
+    if (!caseSensitive_) {
+        for (unsigned char lower = 'a'; lower <= 'z'; ++lower) {
+            unsigned char upper = static_cast<unsigned char>(lower - 0x20);
+            if (set.test(lower) || set.test(upper)) {
+                set.set(lower);
+                set.set(upper);
+            }
+        }
+    }
+    if (negate) {
+        set.invert();
+    }
+    return true;
+}
+
+bool RegexSearcher::parseEscape(ByteSet& set) {
+    if (pos_ >= pattern_->size()) {
+        error_ = "Trailing backslash";
+        return false;
+    }
+
+    char c = (*pattern_)[pos_++];
+    switch (c) {
+        case 'd': case 'D':
+            for (unsigned char ch = '0'; ch <= '9'; ++ch) set.set(ch);
+            break;
+        case 'w': case 'W':
+            for (unsigned char ch = '0'; ch <= '9'; ++ch) set.set(ch);
+            for (unsigned char ch = 'a'; ch <= 'z'; ++ch) set.set(ch);
+            for (unsigned char ch = 'A'; ch <= 'Z'; ++ch) set.set(ch);
+            set.set('_');
+            break;
+        case 's': case 'S':
+            for (unsigned char ch : {' ', '\t', '\r', '\n', '\f', '\v'}) set.set(ch);
+            break;
+        case 'n': set.set('\n'); return true;
+        case 'r': set.set('\r'); return true;
+        case 't': set.set('\t'); return true;
+        default:
+            set.set(static_cast<unsigned char>(c));
+            return true;
+    }
+
+    if (c == 'D' || c == 'W' || c == 'S') {
+        set.invert();
+    }
+    return true;
+}
+
+void RegexSearcher::Automaton::start(int nfaStart) {
+    for (int atLineStart = 0; atLineStart < 2; ++atLineStart) {
+        std::vector<int> states{nfaStart};
+        closure(states, atLineStart != 0, false);
+        startState[atLineStart] = dfaStateFor(std::move(states));
+    }
+}
+
+void RegexSearcher::Automaton::closure(std::vector<int>& states, bool atLineStart, bool atLineEnd) const {
+    std::vector<int> stack(states.begin(), states.end());
+    std::vector<bool> seen(nfa.size(), false);
+    states.clear();
+
+    while (!stack.empty()) {
+        int s = stack.back();
+        stack.pop_back();
+        if (s < 0 || seen[s]) continue;
+        seen[s] = true;
+
+        const NfaState& state = nfa[s];
+        switch (state.type) {
+            case NfaType::SPLIT:
+                stack.push_back(state.out);
+                stack.push_back(state.out1);
+                break;
+            case NfaType::LINE_START:
+                if (atLineStart) stack.push_back(state.out);
+                break;
+            case NfaType::LINE_END:
+                // Kept in the set so acceptance at end of line can follow it
+                states.push_back(s);
+                if (atLineEnd) stack.push_back(state.out);
+                break;
+            case NfaType::BYTES:
+            case NfaType::MATCH:
+                states.push_back(s);
+                break;
+        }
+    }
+
+    std::sort(states.begin(), states.end());
+}
+
+int RegexSearcher::Automaton::dfaStateFor(std::vector<int> states) {
+    auto found = dfaIndex.find(states);
+    if (found != dfaIndex.end()) return found->second;
+
+    DfaState state;
+    std::fill(std::begin(state.next), std::end(state.next), -2);
+    for (int s : states) {
+        if (nfa[s].type == NfaType::MATCH) state.accepting = true;
+    }
+
+    std::vector<int> atEnd = states;
+    closure(atEnd, false, true);
+    for (int s : atEnd) {
+        if (nfa[s].type == NfaType::MATCH) state.acceptingAtLineEnd = true;
+    }
+
+    state.nfaStates = states;
+    dfa.push_back(std::move(state));
+    int index = static_cast<int>(dfa.size()) - 1;
+    dfaIndex.emplace(std::move(states), index);
+    return index;
+}
+
+int RegexSearcher::Automaton::step(int state, unsigned char c) {
+    int cached = dfa[state].next[c];
+    if (cached != -2) return cached;
+
+    std::vector<int> next;
+    for (int s : dfa[state].nfaStates) {
+        const NfaState& nfaState = nfa[s];
+        if (nfaState.type == NfaType::BYTES && nfaState.bytes.test(c)) {
+            next.push_back(nfaState.out);
+        }
+    }
+
+    int target = -1;
+    if (!next.empty()) {
+        closure(next, false, false);
+        if (!next.empty()) target = dfaStateFor(std::move(next));
+    }
+    dfa[state].next[c] = target;
+    return target;
+}
+
+// ============================================================================
+// TextSearch
+// ============================================================================
+
+size_t TextSearch::findAll(const TextBuffer& buffer, const std::string& pattern,
+                           const Options& options, const BatchCallback& onBatch) {
+    if (pattern.empty()) return 0;
+
+    size_t batchSize = std::max<size_t>(options.batchSize, 1);
+    std::vector<Match> batch;
+    batch.reserve(std::min<size_t>(batchSize, 4096));
+    size_t total = 0;
+    bool stopped = false;
+
+    auto emit = [&](size_t offset, size_t length) {
+        batch.push_back({offset, length});
+        ++total;
+        if (batch.size() >= batchSize) {
+            stopped = !onBatch(batch);
+            batch.clear();
+        }
+        return !stopped;
+    };
+
+    if (options.regex) {
+        RegexSearcher regex(pattern, options.caseSensitive);
+        if (!regex.isValid()) return 0;
+
+        forEachLine(buffer, [&](std::string_view line, size_t lineOffset) {
+            regex.findAll(line, [&](size_t start, size_t end) {
+                return end == start || emit(lineOffset + start, end - start);
+            });
+            return !stopped;
+        });
+    } else {
+        LiteralSearcher searcher(pattern, options.caseSensitive);
+        const size_t n = pattern.size();
+        std::string carry;   // last n-1 bytes seen, for matches spanning chunks
+        std::string window;
+        size_t nextAllowed = 0;
+        size_t base = 0;
+
+        for (auto it = buffer.chunks(0, buffer.length());
+             it != TextBuffer::ChunkIterator() && !stopped; ++it) {
+            std::string_view chunk = *it;
+
+            if (!carry.empty()) {
+                size_t carryStart = base - carry.size();
+                window.assign(carry);
+                window.append(chunk.data(), std::min(chunk.size(), n - 1));
+                size_t from = nextAllowed > carryStart ? nextAllowed - carryStart : 0;
+                while (from < carry.size() && !stopped) {
+                    size_t pos = searcher.find(window.data(), window.size(), from);
+                    if (pos == LiteralSearcher::npos || pos >= carry.size()) break;
+                    emit(carryStart + pos, n);
+                    nextAllowed = carryStart + pos + n;
+                    from = pos + n;
+                }
+            }
+
+            size_t from = nextAllowed > base ? nextAllowed - base : 0;
+            while (!stopped) {
+                size_t pos = searcher.find(chunk.data(), chunk.size(), from);
+                if (pos == LiteralSearcher::npos) break;
+                emit(base + pos, n);
+                nextAllowed = base + pos + n;
+                from = pos + n;
+            }
+
+            if (n > 1) {
+                if (chunk.size() >= n - 1) {
+                    carry.assign(chunk.data() + chunk.size() - (n - 1), n - 1);
+                } else {
+                    carry.append(chunk.data(), chunk.size());
+                    if (carry.size() > n - 1) carry.erase(0, carry.size() - (n - 1));
+                }
+            }
+            base += chunk.size();
+        }
+    }
+
+    if (!stopped && !batch.empty()) {
+        onBatch(batch);
+    }
+    return total;
+}
@@ -0,0 +1,775 @@
+#include "trigram_index.h"
+#include "mapped_file.h"
+#include "project_index.h"
+#include "content_search.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+using namespace HybridIDE;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Trigram keys: ASCII folded to lower case, every byte >= 0x80 one symbol
+constexpr uint32_t kSymbols = 129;
+constexpr uint32_t kKeySpace = kSymbols * kSymbols * kSymbols;
+constexpr uint32_t kNewline = '\n';
+
+inline uint32_t symbol(unsigned char c) {
+    if (c >= 0x80) return 128;
+    return (c >= 'A' && c <= 'Z') ? static_cast<uint32_t>(c | 0x20) : c;
+}
+
+inline uint32_t trigramKey(uint32_t a, uint32_t b, uint32_t c) {
+    return (a * kSymbols + b) * kSymbols + c;
+}
+
+// Document flags
+constexpr uint32_t kDead = 1;        // removed or re-indexed since the last save
+constexpr uint32_t kBinary = 2;      // never a candidate
+constexpr uint32_t kUnindexed = 4;   // too large to index; always a candidate
+
+constexpr size_t kIndexBatch = 4096;                   // files extracted before appending
+constexpr size_t kVerifyChunk = 16;                    // candidates per verification task
+
+// ----------------------------------------------------------------------------
+// On-disk layout: IndexHeader, DocumentRecord[documentCount], the posting
+// lists, TrigramRecord[trigramCount] sorted by key (8-aligned), then the
+// path pool. A posting list holds varint gaps between ascending document
+// ids, starting from -1.
+// ----------------------------------------------------------------------------
+
+constexpr char kMagic[8] = {'H', 'Y', 'T', 'R', 'I', 0, 0, 0};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t documentCount;
+    uint64_t trigramCount;
+    uint64_t postingsOffset;
+    uint64_t postingBytes;
+    uint64_t trigramsOffset;
+    uint64_t pathsOffset;
+    uint64_t pathBytes;
+    uint64_t reserved;
+};
+
+struct DocumentRecord {
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t hash;
+};
+
+struct TrigramRecord {
+    uint32_t key;
+    uint32_t count;
+    uint64_t offset;   // into the posting lists
+};
+
+static_assert(sizeof(IndexHeader) == 80, "index header layout");
+static_assert(sizeof(DocumentRecord) == 24, "document record layout");
+static_assert(sizeof(TrigramRecord) == 16, "trigram record layout");
+
+inline void putVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Calls fn(id) for each of count ids, never reading past end
+template <typename Fn>
+void decodePostings(const unsigned char* p, const unsigned char* end, uint32_t count, Fn fn) {
+    uint32_t id = UINT32_MAX;
+    for (uint32_t i = 0; i < count && p < end; ++i) {
+        uint32_t gap = 0;
+        for (int shift = 0; p < end && shift < 35; shift += 7) {
+            unsigned char byte = *p++;
+            gap |= uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        id += gap;
+        fn(id);
+    }
+}
+
+// Add the distinct keys of text's trigrams that stay within a line
+void addKeys(std::string_view text, std::vector<uint32_t>& keys) {
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        uint32_t a = symbol(text[i]), b = symbol(text[i + 1]), c = symbol(text[i + 2]);
+        if (a == kNewline || b == kNewline || c == kNewline) continue;
+        keys.push_back(trigramKey(a, b, c));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+std::string joinPath(const std::string& root, const std::string& relativePath) {
+    return root.back() == '/' || root.back() == '\\' ? root + relativePath : root + "/" + relativePath;
+}
+
+} // namespace
+
+// ============================================================================
+// Index file and query structures
+// ============================================================================
+
+struct TrigramIndex::Base {
+    std::shared_ptr<const MappedFile> file;
+    const DocumentRecord* documents = nullptr;
+    size_t documentCount = 0;
+    const unsigned char* postings = nullptr;
+    uint64_t postingBytes = 0;
+    const TrigramRecord* trigrams = nullptr;
+    size_t trigramCount = 0;
+    const char* paths = nullptr;
+
+    bool load(const std::string& path) {
+        file = MappedFile::open(path);
+        if (!file || file->size() < sizeof(IndexHeader)) return false;
+
+        const IndexHeader* header = reinterpret_cast<const IndexHeader*>(file->data());
+        uint64_t size = file->size();
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+            header->byteOrder != kByteOrder) {
+            return false;
+        }
+        if (header->documentCount > (size - sizeof(IndexHeader)) / sizeof(DocumentRecord) ||
+            header->postingsOffset != sizeof(IndexHeader) + header->documentCount * sizeof(DocumentRecord) ||
+            header->postingBytes > size - header->postingsOffset ||
+            header->trigramsOffset < header->postingsOffset + header->postingBytes ||
+            header->trigramsOffset % 8 != 0 || header->trigramsOffset > size ||
+            header->trigramCount > (size - header->trigramsOffset) / sizeof(TrigramRecord) ||
+            header->pathsOffset != header->trigramsOffset + header->trigramCount * sizeof(TrigramRecord) ||
+            header->pathBytes != size - header->pathsOffset) {
+            return false;
+        }
+
+        documents = reinterpret_cast<const DocumentRecord*>(file->data() + sizeof(IndexHeader));
+        documentCount = static_cast<size_t>(header->documentCount);
+        postings = reinterpret_cast<const unsigned char*>(file->data() + header->postingsOffset);
+        postingBytes = header->postingBytes;
+        trigrams = reinterpret_cast<const TrigramRecord*>(file->data() + header->trigramsOffset);
+        trigramCount = static_cast<size_t>(header->trigramCount);
+        paths = file->data() + header->pathsOffset;
+
+        for (size_t i = 0; i < documentCount; ++i) {
+            if (uint64_t(documents[i].pathOffset) + documents[i].pathLength > header->pathBytes) return false;
+        }
+        for (size_t i = 0; i < trigramCount; ++i) {
+            if (trigrams[i].offset > postingBytes || trigrams[i].key >= kKeySpace ||
+                (i > 0 && trigrams[i].key <= trigrams[i - 1].key)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const TrigramRecord* find(uint32_t key) const {
+        const TrigramRecord* end = trigrams + trigramCount;
+        const TrigramRecord* it = std::lower_bound(trigrams, end, key,
+            [](const TrigramRecord& record, uint32_t k) { return record.key < k; });
+        return it != end && it->key == key ? it : nullptr;
+    }
+
+    std::string_view path(uint32_t id) const {
+        return std::string_view(paths + documents[id].pathOffset, documents[id].pathLength);
+    }
+};
+
+struct TrigramIndex::Extracted {
+    std::string path;
+    uint64_t hash = 0;
+    uint32_t flags = 0;
+    bool read = false;
+    std::vector<uint32_t> keys;   // sorted, distinct
+};
+
+// The trigrams a match must contain: every key and every child (AND), or
+// any child (OR). ALL means the index cannot narrow the search.
+struct TrigramIndex::TrigramQuery {
+    enum class Op { ALL, AND, OR };
+    Op op = Op::ALL;
+    std::vector<uint32_t> keys;
+    std::vector<TrigramQuery> children;
+
+    void normalize() {
+        if (op == Op::AND && keys.empty() && children.empty()) op = Op::ALL;
+        if (op == Op::AND && keys.empty() && children.size() == 1) {
+            TrigramQuery only = std::move(children[0]);
+            *this = std::move(only);
+        }
+    }
+};
+
+namespace {
+
+using TrigramQuery = TrigramIndex::TrigramQuery;
+
+// The trigrams of a pattern's literal runs; runs shorter than a trigram
+// narrow nothing
+TrigramQuery trigramsOf(const PatternLiterals& literals) {
+    TrigramQuery query;
+    if (literals.op == PatternLiterals::Op::OR) {
+        for (const PatternLiterals& branch : literals.children) {
+            query.children.push_back(trigramsOf(branch));
+            if (query.children.back().op == TrigramQuery::Op::ALL) return TrigramQuery();
+        }
+        query.op = TrigramQuery::Op::OR;
+    } else if (literals.op == PatternLiterals::Op::AND) {
+        query.op = TrigramQuery::Op::AND;
+        for (const std::string& run : literals.runs) addKeys(run, query.keys);
+        for (const PatternLiterals& child : literals.children) {
+            TrigramQuery sub = trigramsOf(child);
+            if (sub.op != TrigramQuery::Op::ALL) query.children.push_back(std::move(sub));
+        }
+        query.normalize();
+    }
+    return query;
+}
+
+// Intersection and union of ascending id lists
+std::vector<uint32_t> intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> result;
+    result.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+std::vector<uint32_t> unite(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+void extractFile(const std::string& root, const std::string& path, uint64_t maxFileSize,
+                 TrigramIndex::Extracted& extracted) {
+    extracted.path = path;
+    thread_local FileContent content;
+    if (!content.load(joinPath(root, path))) return;
+    extracted.read = true;
+
+    std::string_view data = content.view();
+    extracted.hash = ProjectIndex::hashContent(data);
+    if (ContentSearcher::isBinary(data)) {
+        extracted.flags = kBinary;
+        return;
+    }
+    if (data.size() > maxFileSize) {
+        extracted.flags = kUnindexed;
+        return;
+    }
+    if (data.size() < 3) return;
+
+    // A bitmap of the key space collects distinct keys without sorting
+    // every occurrence; only the set bits are cleared afterwards
+    thread_local std::vector<uint64_t> seen(kKeySpace / 64 + 1, 0);
+    std::vector<uint32_t>& keys = extracted.keys;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+    uint32_t a = symbol(p[0]), b = symbol(p[1]);
+    for (size_t i = 2; i < data.size(); ++i) {
+        uint32_t c = symbol(p[i]);
+        if (a != kNewline && b != kNewline && c != kNewline) {
+            uint32_t key = trigramKey(a, b, c);
+            uint64_t bit = uint64_t(1) << (key & 63);
+            if (!(seen[key >> 6] & bit)) {
+                seen[key >> 6] |= bit;
+                keys.push_back(key);
+            }
+        }
+        a = b;
+        b = c;
+    }
+    for (uint32_t key : keys) seen[key >> 6] = 0;
+    std::sort(keys.begin(), keys.end());
+}
+
+} // namespace
+
+// ============================================================================
+// TrigramIndex
+// ============================================================================
+
+TrigramIndex::TrigramIndex()
+    : idsBuilt_(false), liveDocuments_(0), lastCandidates_(0), dirty_(false) {
+}
+
+TrigramIndex::~TrigramIndex() {
+    close();
+}
+
+WorkStealingPool& TrigramIndex::pool() {
+    if (!pool_) pool_ = std::make_unique<WorkStealingPool>(options_.threads);
+    return *pool_;
+}
+
+bool TrigramIndex::open(const std::string& root, const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeLocked();
+
+    root_ = root;
+    while (root_.size() > 1 && (root_.back() == '/' || root_.back() == '\\')) {
+        root_.pop_back();
+    }
+    if (options.threads != options_.threads) pool_.reset();
+    options_ = options;
+    if (root_.empty()) return false;
+
+    std::unique_ptr<Base> base = std::make_unique<Base>();
+    std::string path = (fs::path(root_) / ProjectIndex::kDirectory / kFileName).string();
+    if (!base->load(path)) return false;
+
+    documents_.resize(base->documentCount);
+    for (size_t i = 0; i < base->documentCount; ++i) {
+        documents_[i].hash = base->documents[i].hash;
+        documents_[i].flags = base->documents[i].flags & ~kDead;
+    }
+    liveDocuments_ = base->documentCount;
+    base_ = std::move(base);
+    return true;
+}
+
+std::string TrigramIndex::pathOf(uint32_t id) const {
+    size_t baseCount = base_ ? base_->documentCount : 0;
+    if (id < baseCount) return std::string(base_->path(id));
+    return deltaPaths_[id - baseCount];
+}
+
+void TrigramIndex::buildIds() {
+    if (idsBuilt_) return;
+    ids_.clear();
+    ids_.reserve(liveDocuments_);
+    for (uint32_t id = 0; id < documents_.size(); ++id) {
+        if (!(documents_[id].flags & kDead)) ids_[pathOf(id)] = id;
+    }
+    idsBuilt_ = true;
+}
+
+void TrigramIndex::remove(uint32_t id) {
+    if (documents_[id].flags & kDead) return;
+    documents_[id].flags |= kDead;
+    --liveDocuments_;
+    dirty_ = true;
+}
+
+size_t TrigramIndex::update(const std::vector<Document>& documents) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (root_.empty()) return 0;
+    buildIds();
+    pending_.clear();
+
+    std::vector<char> listed(documents_.size(), 0);
+    std::vector<std::string> changed;
+    for (const Document& document : documents) {
+        auto it = ids_.find(document.path);
+        if (it != ids_.end()) {
+            listed[it->second] = 1;
+            if (document.hasHash && documents_[it->second].hash == document.hash) continue;
+        }
+        changed.push_back(document.path);
+    }
+
+    for (auto it = ids_.begin(); it != ids_.end();) {
+        if (!listed[it->second]) {
+            remove(it->second);
+            it = ids_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return indexFiles(changed);
+}
+
+void TrigramIndex::applyChanges(const std::vector<FileWatcher::Change>& changes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (root_.empty()) return;
+
+    for (const FileWatcher::Change& change : changes) {
+        if (change.type == FileWatcher::ChangeType::RESCAN) continue;
+        if (!change.isDirectory) {
+            if (change.type == FileWatcher::ChangeType::DELETED) {
+                pending_.erase(change.path);
+                buildIds();
+                auto it = ids_.find(change.path);
+                if (it != ids_.end()) {
+                    remove(it->second);
+                    ids_.erase(it);
+                }
+            } else {
+                pending_.insert(change.path);
+            }
+        } else if (change.type == FileWatcher::ChangeType::DELETED) {
+            // Files below a deleted directory are not reported one by one
+            std::string prefix = change.path + "/";
+            pending_.erase(pending_.lower_bound(prefix), pending_.lower_bound(change.path + "0"));
+            buildIds();
+            for (auto it = ids_.begin(); it != ids_.end();) {
+                if (it->first.compare(0, prefix.size(), prefix) == 0) {
+                    remove(it->second);
+                    it = ids_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+}
+
+void TrigramIndex::flushPending() {
+    if (pending_.empty()) return;
+    std::vector<std::string> paths(pending_.begin(), pending_.end());
+    pending_.clear();
+    indexFiles(paths);
+}
+
+size_t TrigramIndex::indexFiles(const std::vector<std::string>& paths) {
+    if (paths.empty()) return 0;
+    buildIds();
+
+    size_t indexed = 0;
+    for (size_t start = 0; start < paths.size(); start += kIndexBatch) {
+        size_t count = std::min(kIndexBatch, paths.size() - start);
+        std::vector<Extracted> batch(count);
+        for (size_t i = 0; i < count; ++i) {
+            pool().submit([this, &paths, &batch, start, i] {
+                extractFile(root_, paths[start + i], options_.maxFileSize, batch[i]);
+            });
+        }
+        pool().wait();
+
+        for (Extracted& extracted : batch) {
+            auto it = ids_.find(extracted.path);
+            if (it != ids_.end()) {
+                remove(it->second);
+                ids_.erase(it);
+            }
+            if (!extracted.read) continue;
+            append(extracted);
+            ++indexed;
+        }
+    }
+    return indexed;
+}
+
+void TrigramIndex::append(Extracted& extracted) {
+    uint32_t id = static_cast<uint32_t>(documents_.size());
+    documents_.push_back(DocumentState{extracted.hash, extracted.flags});
+    ids_[extracted.path] = id;
+    deltaPaths_.push_back(std::move(extracted.path));
+    ++liveDocuments_;
+    dirty_ = true;
+
+    if (extracted.keys.empty()) return;
+    if (deltaSlots_.empty()) deltaSlots_.assign(kKeySpace, 0);
+    for (uint32_t key : extracted.keys) {
+        uint32_t& slot = deltaSlots_[key];
+        if (slot == 0) {
+            deltaPostings_.push_back(DeltaPosting{key, 0, UINT32_MAX, std::string()});
+            slot = static_cast<uint32_t>(deltaPostings_.size());
+        }
+        DeltaPosting& posting = deltaPostings_[slot - 1];
+        putVarint(posting.bytes, id - posting.last);
+        posting.last = id;
+        ++posting.count;
+    }
+}
+
+size_t TrigramIndex::postingCount(uint32_t key) const {
+    size_t count = 0;
+    if (base_) {
+        if (const TrigramRecord* record = base_->find(key)) count += record->count;
+    }
+    if (!deltaSlots_.empty() && deltaSlots_[key] != 0) count += deltaPostings_[deltaSlots_[key] - 1].count;
+    return count;
+}
+
+std::vector<uint32_t> TrigramIndex::postings(uint32_t key) const {
+    std::vector<uint32_t> ids;
+    auto add = [&](uint32_t id) {
+        if (id < documents_.size() && !(documents_[id].flags & kDead)) ids.push_back(id);
+    };
+    if (base_) {
+        if (const TrigramRecord* record = base_->find(key)) {
+            ids.reserve(record->count);
+            decodePostings(base_->postings + record->offset, base_->postings + base_->postingBytes,
+                           record->count, add);
+        }
+    }
+    // Delta ids all follow the base's, so appending keeps the list sorted
+    if (!deltaSlots_.empty() && deltaSlots_[key] != 0) {
+        const DeltaPosting& posting = deltaPostings_[deltaSlots_[key] - 1];
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(posting.bytes.data());
+        decodePostings(bytes, bytes + posting.bytes.size(), posting.count, add);
+    }
+    return ids;
+}
+
+std::vector<uint32_t> TrigramIndex::evaluate(const TrigramQuery& query) const {
+    if (query.op == TrigramQuery::Op::OR) {
+        std::vector<uint32_t> result;
+        for (const TrigramQuery& child : query.children) {
+            result = unite(result, evaluate(child));
+        }
+        return result;
+    }
+
+    // Intersect the shortest lists first; the result only shrinks
+    std::vector<std::pair<size_t, uint32_t>> keys;
+    keys.reserve(query.keys.size());
+    for (uint32_t key : query.keys) keys.emplace_back(postingCount(key), key);
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> result;
+    bool first = true;
+    for (const auto& key : keys) {
+        result = first ? postings(key.second) : intersect(result, postings(key.second));
+        first = false;
+        if (result.empty()) return result;
+    }
+    for (const TrigramQuery& child : query.children) {
+        result = first ? evaluate(child) : intersect(result, evaluate(child));
+        first = false;
+        if (result.empty()) return result;
+    }
+    return result;
+}
+
+bool TrigramIndex::search(const std::string& pattern, const Query& query, std::vector<Match>& matches,
+                          std::string* error) {
+    matches.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    lastCandidates_ = 0;
+    if (pattern.empty() || root_.empty()) return true;
+
+    ContentSearcher check(pattern, query);
+    if (!check.isValid()) {
+        if (error) *error = check.getError();
+        return false;
+    }
+    TrigramQuery trigrams = trigramsOf(PatternLiterals::analyze(pattern, query.regex));
+
+    flushPending();
+
+    // Files too large to index are always searched
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> unindexed;
+    for (uint32_t id = 0; id < documents_.size(); ++id) {
+        uint32_t flags = documents_[id].flags;
+        if (flags & (kDead | kBinary)) continue;
+        if (trigrams.op == TrigramQuery::Op::ALL) {
+            candidates.push_back(id);
+        } else if (flags & kUnindexed) {
+            unindexed.push_back(id);
+        }
+    }
+    if (trigrams.op != TrigramQuery::Op::ALL) {
+        candidates = unite(evaluate(trigrams), unindexed);
+    }
+    lastCandidates_ = candidates.size();
+
+    std::vector<std::vector<Match>> found(candidates.size());
+    std::atomic<size_t> total(0);
+    for (size_t start = 0; start < candidates.size(); start += kVerifyChunk) {
+        pool().submit([&, start] {
+            ContentSearcher searcher(pattern, query);
+            FileContent content;
+            size_t end = std::min(start + kVerifyChunk, candidates.size());
+            for (size_t i = start; i < end && total.load() < query.maxResults; ++i) {
+                std::string path = pathOf(candidates[i]);
+                if (!content.load(joinPath(root_, path))) continue;
+                std::string_view data = content.view();
+                if (ContentSearcher::isBinary(data)) continue;
+                searcher.find(data, path, query.maxResults, found[i]);
+                total.fetch_add(found[i].size());
+            }
+        });
+    }
+    pool().wait();
+
+    for (std::vector<Match>& fileMatches : found) {
+        for (Match& match : fileMatches) {
+            if (matches.size() >= query.maxResults) return true;
+            matches.push_back(std::move(match));
+        }
+    }
+    return true;
+}
+
+bool TrigramIndex::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return saveLocked();
+}
+
+bool TrigramIndex::saveLocked() {
+    if (root_.empty()) return true;
+    flushPending();
+    if (!dirty_) return true;
+
+    fs::path directory(ProjectIndex::indexDirectory(root_));
+    if (directory.empty()) return false;
+    fs::path target = directory / kFileName;
+    fs::path temporary = directory / (std::string(kFileName) + ".tmp");
+
+    // Live documents keep their order, so renumbering keeps lists sorted
+    std::vector<uint32_t> newIds(documents_.size(), UINT32_MAX);
+    std::vector<DocumentRecord> records;
+    std::string paths;
+    records.reserve(liveDocuments_);
+    for (uint32_t id = 0; id < documents_.size(); ++id) {
+        if (documents_[id].flags & kDead) continue;
+        std::string path = pathOf(id);
+        DocumentRecord record = {};
+        record.pathOffset = static_cast<uint32_t>(paths.size());
+        record.pathLength = static_cast<uint32_t>(path.size());
+        record.flags = documents_[id].flags;
+        record.hash = documents_[id].hash;
+        newIds[id] = static_cast<uint32_t>(records.size());
+        records.push_back(record);
+        paths += path;
+        if (paths.size() > UINT32_MAX) return false;
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrder;
+    header.documentCount = records.size();
+    header.postingsOffset = sizeof(IndexHeader) + records.size() * sizeof(DocumentRecord);
+
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(DocumentRecord)));
+
+    // Merge the mapped lists and the delta's, key by key
+    std::vector<uint32_t> delta(deltaPostings_.size());
+    for (uint32_t i = 0; i < delta.size(); ++i) delta[i] = i;
+    std::sort(delta.begin(), delta.end(),
+              [this](uint32_t a, uint32_t b) { return deltaPostings_[a].key < deltaPostings_[b].key; });
+
+    std::vector<TrigramRecord> trigrams;
+    std::string bytes;
+    uint64_t offset = 0;
+    size_t baseAt = 0, deltaAt = 0;
+    size_t baseCount = base_ ? base_->trigramCount : 0;
+    while (baseAt < baseCount || deltaAt < delta.size()) {
+        uint32_t baseKey = baseAt < baseCount ? base_->trigrams[baseAt].key : UINT32_MAX;
+        uint32_t deltaKey = deltaAt < delta.size() ? deltaPostings_[delta[deltaAt]].key : UINT32_MAX;
+        uint32_t key = std::min(baseKey, deltaKey);
+
+        bytes.clear();
+        uint32_t count = 0, last = UINT32_MAX;
+        auto add = [&](uint32_t id) {
+            if (id >= newIds.size() || newIds[id] == UINT32_MAX) return;
+            putVarint(bytes, newIds[id] - last);
+            last = newIds[id];
+            ++count;
+        };
+        if (baseKey == key) {
+            const TrigramRecord& record = base_->trigrams[baseAt++];
+            decodePostings(base_->postings + record.offset, base_->postings + base_->postingBytes,
+                           record.count, add);
+        }
+        if (deltaKey == key) {
+            const DeltaPosting& posting = deltaPostings_[delta[deltaAt++]];
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(posting.bytes.data());
+            decodePostings(data, data + posting.bytes.size(), posting.count, add);
+        }
+        if (count == 0) continue;
+
+        trigrams.push_back(TrigramRecord{key, count, offset});
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        offset += bytes.size();
+    }
+
+    header.postingBytes = offset;
+    header.trigramsOffset = (header.postingsOffset + offset + 7) & ~uint64_t(7);
+    static const char padding[8] = {};
+    file.write(padding, static_cast<std::streamsize>(header.trigramsOffset - header.postingsOffset - offset));
+    header.trigramCount = trigrams.size();
+    file.write(reinterpret_cast<const char*>(trigrams.data()),
+               static_cast<std::streamsize>(trigrams.size() * sizeof(TrigramRecord)));
+    header.pathsOffset = header.trigramsOffset + trigrams.size() * sizeof(TrigramRecord);
+    header.pathBytes = paths.size();
+    file.write(paths.data(), static_cast<std::streamsize>(paths.size()));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    std::error_code error;
+    if (!file) {
+        fs::remove(temporary, error);
+        return false;
+    }
+
+    // Release the old mapping first; Windows cannot replace a mapped file
+    base_.reset();
+    fs::rename(temporary, target, error);
+    documents_.clear();
+    deltaPaths_.clear();
+    std::vector<uint32_t>().swap(deltaSlots_);
+    std::vector<DeltaPosting>().swap(deltaPostings_);
+    ids_.clear();
+    idsBuilt_ = false;
+    liveDocuments_ = 0;
+    dirty_ = false;
+
+    std::unique_ptr<Base> base = std::make_unique<Base>();
+    if (error || !base->load(target.string())) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    documents_.resize(base->documentCount);
+    for (size_t i = 0; i < base->documentCount; ++i) {
+        documents_[i].hash = base->documents[i].hash;
+        documents_[i].flags = base->documents[i].flags;
+    }
+    liveDocuments_ = base->documentCount;
+    base_ = std::move(base);
+    return true;
+}
+
+void TrigramIndex::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeLocked();
+}
+
+void TrigramIndex::closeLocked() {
+    saveLocked();
+    root_.clear();
+    base_.reset();
+    documents_.clear();
+    deltaPaths_.clear();
+    std::vector<uint32_t>().swap(deltaSlots_);
+    std::vector<DeltaPosting>().swap(deltaPostings_);
+    ids_.clear();
+    idsBuilt_ = false;
+    pending_.clear();
+    liveDocuments_ = 0;
+    lastCandidates_ = 0;
+    dirty_ = false;
+}
+
+TrigramIndex::Stats TrigramIndex::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.documents = liveDocuments_;
+    stats.trigrams = base_ ? base_->trigramCount : 0;
+    stats.candidates = lastCandidates_;
+    return stats;
+}
@@ -0,0 +1,239 @@
+#include "undo_history.h"
+#include <algorithm>
+
+using namespace HybridIDE;
+
+namespace {
+
+// Coalesced entries stop growing past this size so each undo step stays small
+constexpr size_t kMaxCoalescedBytes = 4096;
+
+} // namespace
+
+UndoHistory::UndoHistory(size_t memoryLimit)
+    : partsBase_(0), current_(0), arenaBase_(0), memoryLimit_(memoryLimit),
+      coalesceWindow_(1000), coalesceBlocked_(true) {
+}
+
+void UndoHistory::record(size_t offset, std::string_view removed, std::string_view inserted) {
+    if (removed.empty() && inserted.empty()) return;
+
+    truncateRedo();
+    Clock::time_point now = Clock::now();
+
+    if (!tryCoalesce(offset, removed, inserted, now)) {
+        Entry entry;
+        entry.offset = offset;
+        entry.arenaStart = arenaBase_ + arena_.size();
+        entry.removedLength = removed.size();
+        entry.insertedLength = inserted.size();
+        entry.lastEdit = now;
+        entry.firstPart = partsBase_ + parts_.size();
+        entry.partCount = 0;
+
+        arena_.append(removed.data(), removed.size());
+        arena_.append(inserted.data(), inserted.size());
+        entries_.push_back(entry);
+        current_ = entries_.size();
+    }
+
+    coalesceBlocked_ = false;
+    enforceLimit();
+}
+
+void UndoHistory::recordBatch(const std::vector<Edit>& edits) {
+    if (edits.empty()) return;
+    if (edits.size() == 1) {
+        breakCoalescing();
+        record(edits[0].offset, edits[0].removed, edits[0].inserted);
+        coalesceBlocked_ = true;
+        return;
+    }
+
+    truncateRedo();
+
+    Entry entry;
+    entry.offset = edits.front().offset;
+    entry.arenaStart = arenaBase_ + arena_.size();
+    entry.removedLength = 0;
+    entry.insertedLength = 0;
+    entry.lastEdit = Clock::now();
+    entry.firstPart = partsBase_ + parts_.size();
+    entry.partCount = edits.size();
+
+    for (const Edit& edit : edits) {
+        parts_.push_back({edit.offset, edit.removed.size(), edit.inserted.size()});
+        arena_.append(edit.removed.data(), edit.removed.size());
+        arena_.append(edit.inserted.data(), edit.inserted.size());
+        entry.removedLength += edit.removed.size();
+        entry.insertedLength += edit.inserted.size();
+    }
+    entries_.push_back(entry);
+    current_ = entries_.size();
+
+    // A batch is never extended by later typing
+    coalesceBlocked_ = true;
+    enforceLimit();
+}
+
+void UndoHistory::breakCoalescing() {
+    coalesceBlocked_ = true;
+}
+
+bool UndoHistory::undo(std::vector<Change>& changes) {
+    if (!canUndo()) return false;
+
+    collectChanges(entries_[--current_], true, changes);
+    coalesceBlocked_ = true;
+    return true;
+}
+
+bool UndoHistory::redo(std::vector<Change>& changes) {
+    if (!canRedo()) return false;
+
+    collectChanges(entries_[current_++], false, changes);
+    coalesceBlocked_ = true;
+    return true;
+}
+
+void UndoHistory::collectChanges(const Entry& entry, bool forUndo, std::vector<Change>& changes) const {
+    changes.clear();
+    if (entry.partCount == 0) {
+        if (forUndo) {
+            changes.push_back({entry.offset, entry.insertedLength, removedText(entry)});
+        } else {
+            changes.push_back({entry.offset, entry.removedLength, insertedText(entry)});
+        }
+        return;
+    }
+
+    // Parts are stored against the text before the batch. Undo runs against
+    // the text after it, so each offset shifts by the growth of earlier parts.
+    changes.reserve(entry.partCount);
+    const char* bytes = arena_.data() + (entry.arenaStart - arenaBase_);
+    size_t first = static_cast<size_t>(entry.firstPart - partsBase_);
+    long long shift = 0;
+    for (size_t i = first; i < first + entry.partCount; ++i) {
+        const Part& part = parts_[i];
+        std::string_view removed(bytes, part.removedLength);
+        std::string_view inserted(bytes + part.removedLength, part.insertedLength);
+        bytes += part.removedLength + part.insertedLength;
+
+        if (forUndo) {
+            changes.push_back({static_cast<size_t>(static_cast<long long>(part.offset) + shift),
+                               part.insertedLength, removed});
+            shift += static_cast<long long>(part.insertedLength) - static_cast<long long>(part.removedLength);
+        } else {
+            changes.push_back({part.offset, part.removedLength, inserted});
+        }
+    }
+}
+
+void UndoHistory::clear() {
+    entries_.clear();
+    parts_.clear();
+    partsBase_ = 0;
+    arena_.clear();
+    arena_.shrink_to_fit();
+    arenaBase_ = 0;
+    current_ = 0;
+    coalesceBlocked_ = true;
+}
+
+void UndoHistory::setMemoryLimit(size_t bytes) {
+    memoryLimit_ = bytes;
+    enforceLimit();
+}
+
+size_t UndoHistory::getMemoryUsage() const {
+    return arena_.size() + entries_.size() * sizeof(Entry) + parts_.size() * sizeof(Part);
+}
+
+std::string_view UndoHistory::removedText(const Entry& entry) const {
+    return std::string_view(arena_.data() + (entry.arenaStart - arenaBase_), entry.removedLength);
+}
+
+std::string_view UndoHistory::insertedText(const Entry& entry) const {
+    return std::string_view(arena_.data() + (entry.arenaStart - arenaBase_) + entry.removedLength,
+                            entry.insertedLength);
+}
+
+bool UndoHistory::tryCoalesce(size_t offset, std::string_view removed, std::string_view inserted,
+                              Clock::time_point now) {
+    if (coalesceBlocked_ || entries_.empty()) return false;
+
+    Entry& last = entries_.back();
+    if (last.partCount != 0) return false;
+    if (now - last.lastEdit > coalesceWindow_) return false;
+    if (last.removedLength + last.insertedLength + removed.size() + inserted.size() > kMaxCoalescedBytes) {
+        return false;
+    }
+
+    // A line break ends the current typing run
+    if (inserted.find('\n') != std::string_view::npos) return false;
+
+    // The last entry's bytes sit at the end of the arena: [removed][inserted]
+    size_t tail = static_cast<size_t>(last.arenaStart - arenaBase_);
+
+    if (removed.empty() && offset == last.offset + last.insertedLength) {
+        // Typing: extend the inserted run
+        arena_.append(inserted.data(), inserted.size());
+        last.insertedLength += inserted.size();
+    } else if (inserted.empty() && last.insertedLength == 0 && offset + removed.size() == last.offset) {
+        // Backspace: the removed run grows at the front
+        arena_.insert(tail, removed.data(), removed.size());
+        last.offset = offset;
+        last.removedLength += removed.size();
+    } else if (inserted.empty() && last.insertedLength == 0 && offset == last.offset) {
+        // Forward delete: the removed run grows at the back
+        arena_.append(removed.data(), removed.size());
+        last.removedLength += removed.size();
+    } else if (inserted.empty() && last.removedLength == 0 &&
+               offset >= last.offset && offset + removed.size() == last.offset + last.insertedLength) {
+        // Backspacing over text typed in this same run just shortens it
+        last.insertedLength -= removed.size();
+        arena_.resize(tail + last.insertedLength);
+        if (last.insertedLength == 0) {
+            entries_.pop_back();
+            current_ = entries_.size();
+            return true;
+        }
+    } else {
+        return false;
+    }
+
+    last.lastEdit = now;
+    return true;
+}
+
+void UndoHistory::truncateRedo() {
+    if (current_ == entries_.size()) return;
+
+    arena_.resize(static_cast<size_t>(entries_[current_].arenaStart - arenaBase_));
+    parts_.resize(static_cast<size_t>(entries_[current_].firstPart - partsBase_));
+    entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(current_), entries_.end());
+    coalesceBlocked_ = true;
+}
+
+void UndoHistory::enforceLimit() {
+    size_t usage = getMemoryUsage();
+    if (usage <= memoryLimit_) return;
+
+    // Trim down to 3/4 of the limit so the arena is compacted only rarely.
+    // Only undoable entries are dropped, and the newest one is always kept.
+    size_t target = memoryLimit_ - memoryLimit_ / 4;
+    size_t count = 0;
+    while (count < current_ && count + 1 < entries_.size() && usage > target) {
+        const Entry& entry = entries_[count];
+        usage -= entry.removedLength + entry.insertedLength + sizeof(Entry) + entry.partCount * sizeof(Part);
+        ++count;
+    }
+    if (count == 0) return;
+
+    entries_.erase(entries_.begin(), entries_.begin() + static_cast<std::ptrdiff_t>(count));
+    current_ -= count;
+    arena_.erase(0, static_cast<size_t>(entries_.front().arenaStart - arenaBase_));
+    arenaBase_ = entries_.front().arenaStart;
+    parts_.erase(parts_.begin(), parts_.begin() + static_cast<std::ptrdiff_t>(entries_.front().firstPart - partsBase_));
+    partsBase_ = entries_.front().firstPart;
+}
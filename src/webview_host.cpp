@@ -41,63 +41,23 @@ void WebViewHost::setupMessageHandler() {
     if (!webView) return;
     
     // Message handler setup
-    // In production Windows build, this would register WebView2 message callbacks
+    // In production Windows build, this would register a WebView2
+    // WebMessageReceived callback that passes each message to dispatchMessage
     std::cout << "WebView message handler ready" << std::endl;
 }
 
-std::string WebViewHost::parseMessageType(const std::string& message) {
-    // Expected format: {"type":"...", "data":{...}}
-    size_t typeStart = message.find("\"type\"");
-    if (typeStart == std::string::npos) return "";
-    
-    size_t valueStart = message.find(":", typeStart);
-    if (valueStart == std::string::npos) return "";
-    
-    valueStart = message.find("\"", valueStart);
-    if (valueStart == std::string::npos) return "";
-    
-    size_t valueEnd = message.find("\"", valueStart + 1);
-    if (valueEnd == std::string::npos) return "";
-    
-    return message.substr(valueStart + 1, valueEnd - valueStart - 1);
-}
-
-std::string WebViewHost::parseMessageData(const std::string& message) {
-    // Expected format: {"type":"...", "data":{...}}
-    size_t dataStart = message.find("\"data\"");
-    if (dataStart == std::string::npos) return "{}";
-    
-    size_t valueStart = message.find(":", dataStart);
-    if (valueStart == std::string::npos) return "{}";
-    
-    // Find the opening brace or quote
-    valueStart = message.find_first_of("{[\"", valueStart);
-    if (valueStart == std::string::npos) return "{}";
-    
-    // Simple extraction - find the matching closing brace
-    int braceCount = 0;
-    bool inString = false;
-    size_t i = valueStart;
-    
-    for (; i < message.length(); i++) {
-        char c = message[i];
-        
-        if (c == '\"' && (i == 0 || message[i-1] != '\\')) {
-            inString = !inString;
-        }
-        
-        if (!inString) {
-            if (c == '{' || c == '[') braceCount++;
-            if (c == '}' || c == ']') {
-                braceCount--;
-                if (braceCount == 0) {
-                    return message.substr(valueStart, i - valueStart + 1);
-                }
-            }
-        }
+void WebViewHost::dispatchMessage(const std::string& message) {
+    // Expected format: {"type":"...", "data":{...}}. The message is indexed
+    // once; the handler reads its fields straight out of it.
+    HybridIDE::JsonDocument document(message);
+    HybridIDE::JsonValue root = document.root();
+    std::string scratch;
+    auto handler = messageHandlers.find(root["type"].stringView(scratch));
+    if (handler == messageHandlers.end()) {
+        std::cout << "No handler for message: " << root["type"].string() << std::endl;
+        return;
     }
-    
-    return "{}";
+    handler->second(root["data"]);
 }
 
 void WebViewHost::navigate(const std::wstring& url) {
@@ -114,8 +74,7 @@ void WebViewHost::postMessage(const std::string& message) {
     }
 }
 
-void WebViewHost::registerMessageHandler(const std::string& messageType,
-                                         std::function<void(const std::string&)> handler) {
+void WebViewHost::registerMessageHandler(const std::string& messageType, MessageHandler handler) {
     messageHandlers[messageType] = handler;
     std::cout << "Registered handler for: " << messageType << std::endl;
 }
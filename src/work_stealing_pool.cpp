@@ -0,0 +1,145 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace HybridIDE;
+
+namespace {
+
+// Pool and queue index of the worker running on this thread
+thread_local const WorkStealingPool* tlsPool = nullptr;
+thread_local size_t tlsIndex = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+    : queued_(0), pending_(0), sleepers_(0), stop_(false) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i <= threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t index = tlsPool == this ? tlsIndex : workers_.size();
+    pending_.fetch_add(1);
+    {
+        // Counted before it can be popped, so a worker's decrement never
+        // runs ahead of it
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queued_.fetch_add(1);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+
+    // Pairs with the sleepers_ increment in workerLoop: either the sleeper
+    // sees queued_ > 0 or we see it asleep and wake it
+    if (sleepers_.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        wake_.notify_one();
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t index, Task& task) {
+    Queue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t index, Task& task) {
+    size_t count = queues_.size();
+    for (size_t i = 1; i < count; ++i) {
+        Queue& queue = *queues_[(index + i) % count];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOne(size_t index) {
+    Task task;
+    if (!popLocal(index, task) && !steal(index, task)) {
+        return false;
+    }
+    queued_.fetch_sub(1);
+
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (!error_) error_ = std::current_exception();
+    }
+
+    if (pending_.fetch_sub(1) == 1) {
+        { std::lock_guard<std::mutex> lock(sleepMutex_); }
+        idle_.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    tlsPool = this;
+    tlsIndex = index;
+
+    while (!stop_) {
+        if (runOne(index)) continue;
+
+        // A steal can miss a queue that is briefly locked; only sleep when
+        // nothing is queued anywhere
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        sleepers_.fetch_sub(1);
+    }
+}
+
+void WorkStealingPool::wait() {
+    const WorkStealingPool* outerPool = tlsPool;
+    size_t outerIndex = tlsIndex;
+    tlsPool = this;
+    tlsIndex = workers_.size();
+
+    while (pending_.load() > 0) {
+        if (runOne(workers_.size())) continue;
+
+        // Everything left is running on workers; sleep until they finish
+        // or spawn something this thread can help with
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1);
+        idle_.wait_for(lock, std::chrono::milliseconds(1),
+                       [this] { return pending_.load() == 0 || queued_.load() > 0; });
+        sleepers_.fetch_sub(1);
+    }
+
+    tlsPool = outerPool;
+    tlsIndex = outerIndex;
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+}